@@ -0,0 +1,90 @@
+#ifndef AST_TRAVERSAL_H
+#define AST_TRAVERSAL_H
+
+#include "AST_NODE.h"
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+// What enter() asks the traversal to do after visiting a node
+enum class Visit { CONTINUE, SKIP_CHILDREN, STOP };
+
+// A node as the traversal reaches it
+struct TraversalStep {
+    const ASTNode* node;
+    const ASTNode* parent;     // nullptr for the root
+    size_t index;              // position among the parent's children
+    size_t depth;              // 0 for the root
+};
+
+// Depth-first traversal of an ASTNode tree on an explicit stack, so the depth
+// a tree can have is bounded by heap memory rather than the call stack.
+// Children are visited left to right, the order ASTNode::evaluate runs them.
+class ASTTraversal {
+public:
+    static size_t childCount(const ASTNode& node);
+    static const ASTNode* child(const ASTNode& node, size_t index);
+
+    // enter(step) runs before a node's children and returns a Visit. leave(step)
+    // runs after them, including after SKIP_CHILDREN, and returns void or a
+    // Visit. STOP from either ends the walk with no further calls.
+    template <typename Enter, typename Leave>
+    static void walk(const ASTNode& root, Enter&& enter, Leave&& leave);
+
+    // leave(step) for every node, children before their parent
+    template <typename Leave>
+    static void postorder(const ASTNode& root, Leave&& leave) {
+        walk(root, [](const TraversalStep&) { return Visit::CONTINUE; }, leave);
+    }
+};
+
+inline size_t ASTTraversal::childCount(const ASTNode& node) {
+    switch(node.type) {
+        case NodeType::BINARY_OP: return 2;
+        case NodeType::UNARY_OP: return 1;
+        case NodeType::FUNCTION_CALL: return node.function.arguments.size();
+        default: return 0;
+    }
+}
+
+inline const ASTNode* ASTTraversal::child(const ASTNode& node, size_t index) {
+    if (node.type == NodeType::FUNCTION_CALL) return node.function.arguments[index].get();
+    return index == 0 ? node.op.left.get() : node.op.right.get();
+}
+
+template <typename Enter, typename Leave>
+void ASTTraversal::walk(const ASTNode& root, Enter&& enter, Leave&& leave) {
+    struct Frame {
+        TraversalStep step;
+        size_t next;           // next child to enter
+        size_t count;
+    };
+    std::vector<Frame> stack;
+
+    TraversalStep rootStep{&root, nullptr, 0, 0};
+    Visit visit = enter(rootStep);
+    if (visit == Visit::STOP) return;
+    stack.push_back({rootStep, 0, visit == Visit::SKIP_CHILDREN ? 0 : childCount(root)});
+
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        if (frame.next < frame.count) {
+            TraversalStep step{child(*frame.step.node, frame.next), frame.step.node, frame.next,
+                               frame.step.depth + 1};
+            ++frame.next;
+            visit = enter(step);
+            if (visit == Visit::STOP) return;
+            stack.push_back({step, 0, visit == Visit::SKIP_CHILDREN ? 0 : childCount(*step.node)});
+        } else {
+            TraversalStep step = frame.step;
+            stack.pop_back();
+            if constexpr (std::is_same_v<decltype(leave(step)), Visit>) {
+                if (leave(step) == Visit::STOP) return;
+            } else {
+                leave(step);
+            }
+        }
+    }
+}
+
+#endif // AST_TRAVERSAL_H
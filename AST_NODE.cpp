@@ -1,4 +1,6 @@
-#include "ast_node.h"
+#include "AST_NODE.h"
+#include "ASTTraversal.h"
+#include "ExpressionProfiler.h"
 #include <stdexcept>
 #include <sstream>
 #include <cmath>
@@ -25,8 +27,19 @@ ASTNode::ASTNode(const std::string& funcName, const std::vector<ASTNodePtr>& arg
     new(&function) FunctionData{funcName, args};
 }
 
-// Destructor - needs to properly clean up union members
+// Destructor - needs to properly clean up union members. Descendants this node
+// alone owns are released from a local stack, so tearing down a very deep tree
+// does not recurse once per level.
 ASTNode::~ASTNode() {
+    std::vector<ASTNodePtr> pending;
+    detachChildren(pending);
+    while (!pending.empty()) {
+        ASTNodePtr node = std::move(pending.back());
+        pending.pop_back();
+        // Shared nodes are left to their other owners
+        if (node.use_count() == 1) node->detachChildren(pending);
+    }
+
     switch(type) {
         case NodeType::VARIABLE:
             variable.~VariableData();
@@ -46,6 +59,25 @@ ASTNode::~ASTNode() {
     }
 }
 
+// Move this node's children onto `pending`, leaving it childless
+void ASTNode::detachChildren(std::vector<ASTNodePtr>& pending) {
+    switch(type) {
+        case NodeType::BINARY_OP:
+        case NodeType::UNARY_OP:
+            if (op.left) pending.push_back(std::move(op.left));
+            if (op.right) pending.push_back(std::move(op.right));
+            break;
+        case NodeType::FUNCTION_CALL:
+            for (auto& arg : function.arguments) {
+                if (arg) pending.push_back(std::move(arg));
+            }
+            function.arguments.clear();
+            break;
+        default:
+            break;
+    }
+}
+
 // Factory function for number node
 ASTNodePtr ASTNode::createNumber(double value) {
     return std::make_shared<ASTNode>(value);
@@ -75,74 +107,123 @@ ASTNodePtr ASTNode::createFunctionCall(const std::string& funcName, const std::v
 
 // Evaluate the AST with VariableMap
 double ASTNode::evaluate(const VariableMap& variables) const {
-    switch(type) {
-        case NodeType::NUMBER:
-            return number.value;
-            
-        case NodeType::VARIABLE: {
-            // Find variable value in map
-            std::string varName = variable.name;
-            auto it = variables.find(varName);
-            if (it != variables.end()) {
-                return it->second;
-            }
-            throw std::runtime_error("Undefined variable: " + varName);
-        }
-            
-        case NodeType::BINARY_OP: {
-            double leftVal = op.left->evaluate(variables);
-            double rightVal = op.right->evaluate(variables);
-            
-            switch(op.op) {
-                case OperatorType::ADD: return leftVal + rightVal;
-                case OperatorType::SUBTRACT: return leftVal - rightVal;
-                case OperatorType::MULTIPLY: return leftVal * rightVal;
-                case OperatorType::DIVIDE: 
-                    if (rightVal == 0) throw std::runtime_error("Division by zero");
-                    return leftVal / rightVal;
-                case OperatorType::POWER: return std::pow(leftVal, rightVal);
-                default: throw std::runtime_error("Unknown binary operator");
-            }
-        }
-            
-        case NodeType::UNARY_OP: {
-            double val = op.left->evaluate(variables);
-            switch(op.op) {
-                case OperatorType::NEGATIVE: return -val;
-                default: throw std::runtime_error("Unknown unary operator");
+    auto result = tryEvaluate(variables);
+    if (!result) throw std::runtime_error(result.error().message());
+    return *result;
+}
+
+// Evaluate without throwing. Nodes are visited in postorder on an explicit
+// stack; each leaves its value on `values` for its parent. The first failing
+// node, in the order evaluate() reaches them, stops the walk.
+Expected<double, EvaluationError> ASTNode::tryEvaluate(const VariableMap& variables) const {
+    std::vector<double> values;
+    EvaluationError error;
+    PROFILE_TRAVERSAL();
+    ASTTraversal::walk(*this, [&](const TraversalStep& step) {
+        PROFILE_ENTER(step.node);
+        return Visit::CONTINUE;
+    }, [&](const TraversalStep& step) {
+        const ASTNode& node = *step.node;
+        auto fail = [&](ErrorCode code) {
+            error = {code, &node};
+            PROFILE_FAIL();
+            return Visit::STOP;
+        };
+        switch(node.type) {
+            case NodeType::NUMBER:
+                values.push_back(node.number.value);
+                break;
+                
+            case NodeType::VARIABLE: {
+                // Find variable value in map
+                const std::string& varName = node.variable.name;
+                auto it = variables.find(varName);
+                if (it == variables.end()) return fail(ErrorCode::UNDEFINED_VARIABLE);
+                values.push_back(it->second);
+                break;
             }
-        }
-            
-        case NodeType::FUNCTION_CALL: {
-            // For now, we'll handle basic functions
-            std::string funcName = function.functionName;
-            std::vector<double> args;
-            for (const auto& arg : function.arguments) {
-                args.push_back(arg->evaluate(variables));
+                
+            case NodeType::BINARY_OP: {
+                double rightVal = values.back();
+                values.pop_back();
+                double& result = values.back();
+                double leftVal = result;
+                
+                switch(node.op.op) {
+                    case OperatorType::ADD: result = leftVal + rightVal; break;
+                    case OperatorType::SUBTRACT: result = leftVal - rightVal; break;
+                    case OperatorType::MULTIPLY: result = leftVal * rightVal; break;
+                    case OperatorType::DIVIDE: 
+                        if (rightVal == 0) return fail(ErrorCode::DIVISION_BY_ZERO);
+                        result = leftVal / rightVal;
+                        break;
+                    case OperatorType::POWER: result = std::pow(leftVal, rightVal); break;
+                    default: return fail(ErrorCode::UNKNOWN_OPERATOR);
+                }
+                break;
             }
-            
-            // Basic function implementations
-            if (funcName == "sin" && args.size() == 1) {
-                return std::sin(args[0]);
-            } else if (funcName == "cos" && args.size() == 1) {
-                return std::cos(args[0]);
-            } else if (funcName == "sqrt" && args.size() == 1) {
-                if (args[0] < 0) throw std::runtime_error("Square root of negative number");
-                return std::sqrt(args[0]);
-            } else if (funcName == "log" && args.size() == 1) {
-                if (args[0] <= 0) throw std::runtime_error("Log of non-positive number");
-                return std::log(args[0]);
-            } else if (funcName == "exp" && args.size() == 1) {
-                return std::exp(args[0]);
-            } else if (funcName == "abs" && args.size() == 1) {
-                return std::abs(args[0]);
-            } else {
-                throw std::runtime_error("Unknown function or wrong number of arguments: " + funcName);
+                
+            case NodeType::UNARY_OP:
+                switch(node.op.op) {
+                    case OperatorType::NEGATIVE: values.back() = -values.back(); break;
+                    default: return fail(ErrorCode::UNKNOWN_OPERATOR);
+                }
+                break;
+                
+            case NodeType::FUNCTION_CALL: {
+                // The arguments are the last values on the stack
+                const std::string& funcName = node.function.functionName;
+                size_t argCount = node.function.arguments.size();
+                const double* args = values.data() + values.size() - argCount;
+                double result;
+                
+                // Basic function implementations
+                if (funcName == "sin" && argCount == 1) {
+                    result = std::sin(args[0]);
+                } else if (funcName == "cos" && argCount == 1) {
+                    result = std::cos(args[0]);
+                } else if (funcName == "sqrt" && argCount == 1) {
+                    if (args[0] < 0) return fail(ErrorCode::SQRT_OF_NEGATIVE);
+                    result = std::sqrt(args[0]);
+                } else if (funcName == "log" && argCount == 1) {
+                    if (args[0] <= 0) return fail(ErrorCode::LOG_OF_NON_POSITIVE);
+                    result = std::log(args[0]);
+                } else if (funcName == "exp" && argCount == 1) {
+                    result = std::exp(args[0]);
+                } else if (funcName == "abs" && argCount == 1) {
+                    result = std::abs(args[0]);
+                } else {
+                    return fail(ErrorCode::UNKNOWN_FUNCTION);
+                }
+                values.resize(values.size() - argCount);
+                values.push_back(result);
+                break;
             }
+                
+            default:
+                return fail(ErrorCode::UNKNOWN_NODE_TYPE);
         }
-            
-        default:
-            throw std::runtime_error("Unknown node type");
+        PROFILE_LEAVE();
+        return Visit::CONTINUE;
+    });
+    
+    if (error.code != ErrorCode::NONE) return Unexpected(error);
+    return values.back();
+}
+
+// Text of the exception ASTNode::evaluate throws for this error
+std::string EvaluationError::message() const {
+    switch(code) {
+        case ErrorCode::UNDEFINED_VARIABLE: return "Undefined variable: " + node->variable.name;
+        case ErrorCode::DIVISION_BY_ZERO: return "Division by zero";
+        case ErrorCode::SQRT_OF_NEGATIVE: return "Square root of negative number";
+        case ErrorCode::LOG_OF_NON_POSITIVE: return "Log of non-positive number";
+        case ErrorCode::UNKNOWN_FUNCTION:
+            return "Unknown function or wrong number of arguments: " + node->function.functionName;
+        case ErrorCode::UNKNOWN_OPERATOR:
+            return node->type == NodeType::UNARY_OP ? "Unknown unary operator" : "Unknown binary operator";
+        case ErrorCode::UNKNOWN_NODE_TYPE: return "Unknown node type";
+        default: return "No error";
     }
 }
 
@@ -159,156 +240,124 @@ double ASTNode::evaluate(const std::vector<std::pair<std::string, double>>& vari
 // Print the AST with indentation
 void ASTNode::print(int indent, bool tree) const {
     if (tree) {
-        // Print root value with initial indentation
-        printIndent(indent);
-        switch (type) {
-            case NodeType::NUMBER:
-                std::cout << number.value << std::endl;
-                break;
-            case NodeType::VARIABLE:
-                std::cout << variable.name << std::endl;
-                break;
-            case NodeType::BINARY_OP:
-            case NodeType::UNARY_OP:
-                std::cout << opToString(op.op) << std::endl;
-                break;
-            case NodeType::FUNCTION_CALL:
-                std::cout << function.functionName << "()" << std::endl;
-                break;
-        }
-
-        // Get children
-        std::vector<ASTNodePtr> children;
-        if (type == NodeType::BINARY_OP) {
-            if (op.left) children.push_back(op.left);
-            if (op.right) children.push_back(op.right);
-        } else if (type == NodeType::UNARY_OP) {
-            if (op.left) children.push_back(op.left);
-        } else if (type == NodeType::FUNCTION_CALL) {
-            children = function.arguments;
-        }
-        
+        // Root value at `indent`, then a "|--- " line per node. Each level adds
+        // "    " under a parent's last child and "|   " under the others.
         std::string prefix(indent, ' ');
-        // Recurse on children
-        for (size_t i = 0; i < children.size(); ++i) {
-            children[i]->printTree(prefix, i == children.size() - 1);
-        }
+        ASTTraversal::walk(*this, [&](const TraversalStep& step) {
+            if (!step.parent) {
+                printIndent(indent);
+            } else {
+                std::cout << prefix << "|--- ";
+            }
+            step.node->printLabel();
+            if (step.parent) {
+                bool isTail = step.index + 1 == ASTTraversal::childCount(*step.parent);
+                prefix += isTail ? "    " : "|   ";
+            }
+            return Visit::CONTINUE;
+        }, [&](const TraversalStep& step) {
+            if (step.parent) prefix.resize(prefix.size() - 4);
+        });
 
     } else {
-        printIndent(indent);
+        ASTTraversal::walk(*this, [&](const TraversalStep& step) {
+            const ASTNode& node = *step.node;
+            printIndent(indent + 2 * static_cast<int>(step.depth));
+            
+            switch(node.type) {
+                case NodeType::NUMBER:
+                    std::cout << "Number: " << node.number.value << std::endl;
+                    break;
+                
+                case NodeType::VARIABLE:
+                    std::cout << "Variable: " << node.variable.name << std::endl;
+                    break;
+                    
+                case NodeType::BINARY_OP:
+                    std::cout << "Binary Op: " << opToString(node.op.op) << std::endl;
+                    break;
+                    
+                case NodeType::UNARY_OP:
+                    std::cout << "Unary Op: " << opToString(node.op.op) << std::endl;
+                    break;
+                    
+                case NodeType::FUNCTION_CALL:
+                    std::cout << "Function Call: " << node.function.functionName << "(";
+                    for (size_t i = 0; i < node.function.arguments.size(); ++i) {
+                        if (i > 0) std::cout << ", ";
+                        std::cout << node.function.arguments[i]->toString();
+                    }
+                    std::cout << ")" << std::endl;
+                    break;
+            }
+            return Visit::CONTINUE;
+        }, [](const TraversalStep&) {});
+    }
+}
+
+// Whether a node needs parentheses under its parent in toString(): children
+// of a binary operator that bind more loosely (or, on the right, equally)
+static bool needsParentheses(const TraversalStep& step) {
+    if (!step.parent || step.parent->type != NodeType::BINARY_OP) return false;
+    const ASTNode& node = *step.node;
+    if (node.type != NodeType::BINARY_OP && node.type != NodeType::UNARY_OP) return false;
+
+    int childPrecedence = ASTNode::getPrecedence(node.op.op);
+    int currentPrecedence = ASTNode::getPrecedence(step.parent->op.op);
+    return step.index == 0 ? childPrecedence < currentPrecedence : childPrecedence <= currentPrecedence;
+}
+
+// Convert AST to string representation. Text is appended as the traversal
+// enters and leaves each node, so the output is built in one buffer.
+std::string ASTNode::toString() const {
+    std::string out;
+    ASTTraversal::walk(*this, [&](const TraversalStep& step) {
+        const ASTNode& node = *step.node;
+        // Separator from the previous sibling
+        if (step.parent && step.index > 0) {
+            if (step.parent->type == NodeType::BINARY_OP) {
+                out += " " + opToString(step.parent->op.op) + " ";
+            } else {
+                out += ", ";
+            }
+        }
+        if (needsParentheses(step)) out += "(";
         
-        switch(type) {
+        switch(node.type) {
             case NodeType::NUMBER:
-                std::cout << "Number: " << number.value << std::endl;
+                out += numberToString(node.number.value);
                 break;
-            
+                
             case NodeType::VARIABLE:
-                std::cout << "Variable: " << variable.name << std::endl;
+                out += node.variable.name;
                 break;
                 
             case NodeType::BINARY_OP:
-                std::cout << "Binary Op: " << opToString(op.op) << std::endl;
-                op.left->print(indent + 2);
-                op.right->print(indent + 2);
                 break;
                 
             case NodeType::UNARY_OP:
-                std::cout << "Unary Op: " << opToString(op.op) << std::endl;
-                op.left->print(indent + 2);
+                if (node.op.op == OperatorType::NEGATIVE) {
+                    out += "-";
+                } else {
+                    out += opToString(node.op.op) + "(";
+                }
                 break;
                 
             case NodeType::FUNCTION_CALL:
-                std::cout << "Function Call: " << function.functionName << "(";
-                for (size_t i = 0; i < function.arguments.size(); ++i) {
-                    if (i > 0) std::cout << ", ";
-                    std::cout << function.arguments[i]->toString();
-                }
-                std::cout << ")" << std::endl;
-                for (const auto& arg : function.arguments) {
-                    arg->print(indent + 2);
-                }
+                out += node.function.functionName + "(";
                 break;
         }
-    }
-}
-
-// Convert AST to string representation
-std::string ASTNode::toString() const {
-    std::stringstream ss;
-    
-    switch(type) {
-        case NodeType::NUMBER:
-            // Remove trailing zeros
-            ss << number.value;
-            {
-                std::string str = ss.str();
-                size_t dotPos = str.find('.');
-                if (dotPos != std::string::npos) {
-                    // Remove trailing zeros after decimal point
-                    str = str.substr(0, str.find_last_not_of('0') + 1);
-                    if (str.back() == '.') str.pop_back();
-                }
-                return str;
-            }
-            
-        case NodeType::VARIABLE:
-            ss << variable.name;
-            break;
-            
-        case NodeType::BINARY_OP: {
-            bool needParentheses = false;
-            
-            // Check if we need parentheses for left child
-            if (op.left->type == NodeType::BINARY_OP || op.left->type == NodeType::UNARY_OP) {
-                int leftPrecedence = getPrecedence(
-                    op.left->type == NodeType::BINARY_OP ? op.left->op.op : 
-                    op.left->type == NodeType::UNARY_OP ? op.left->op.op : OperatorType::NONE
-                );
-                int currentPrecedence = getPrecedence(op.op);
-                needParentheses = leftPrecedence < currentPrecedence;
-            }
-            
-            if (needParentheses) ss << "(";
-            ss << op.left->toString();
-            if (needParentheses) ss << ")";
-            
-            ss << " " << opToString(op.op) << " ";
-            
-            needParentheses = false;
-            if (op.right->type == NodeType::BINARY_OP || op.right->type == NodeType::UNARY_OP) {
-                int rightPrecedence = getPrecedence(
-                    op.right->type == NodeType::BINARY_OP ? op.right->op.op : 
-                    op.right->type == NodeType::UNARY_OP ? op.right->op.op : OperatorType::NONE
-                );
-                int currentPrecedence = getPrecedence(op.op);
-                needParentheses = rightPrecedence <= currentPrecedence;
-            }
-            
-            if (needParentheses) ss << "(";
-            ss << op.right->toString();
-            if (needParentheses) ss << ")";
-            break;
+        return Visit::CONTINUE;
+    }, [&](const TraversalStep& step) {
+        const ASTNode& node = *step.node;
+        if (node.type == NodeType::FUNCTION_CALL ||
+            (node.type == NodeType::UNARY_OP && node.op.op != OperatorType::NEGATIVE)) {
+            out += ")";
         }
-            
-        case NodeType::UNARY_OP:
-            if (op.op == OperatorType::NEGATIVE) {
-                ss << "-" << op.left->toString();
-            } else {
-                ss << opToString(op.op) << "(" << op.left->toString() << ")";
-            }
-            break;
-            
-        case NodeType::FUNCTION_CALL:
-            ss << function.functionName << "(";
-            for (size_t i = 0; i < function.arguments.size(); ++i) {
-                if (i > 0) ss << ", ";
-                ss << function.arguments[i]->toString();
-            }
-            ss << ")";
-            break;
-    }
+        if (needsParentheses(step)) out += ")";
+    });
     
-    return ss.str();
+    return out;
 }
 
 // Check if operator is unary
@@ -342,10 +391,28 @@ std::string ASTNode::opToString(OperatorType op) {
     }
 }
 
+// Format a number the way toString prints it
+std::string ASTNode::numberToString(double value) {
+    std::stringstream ss;
+    // Remove trailing zeros
+    ss << value;
+    std::string str = ss.str();
+    size_t dotPos = str.find('.');
+    if (dotPos != std::string::npos) {
+        // Remove trailing zeros after decimal point
+        str = str.substr(0, str.find_last_not_of('0') + 1);
+        if (str.back() == '.') str.pop_back();
+    }
+    return str;
+}
+
 // Collect all variable names in the expression
 std::vector<std::string> ASTNode::collectVariables() const {
     std::vector<std::string> variables;
-    collectVariablesRecursive(variables);
+    ASTTraversal::walk(*this, [&](const TraversalStep& step) {
+        if (step.node->type == NodeType::VARIABLE) variables.push_back(step.node->variable.name);
+        return Visit::CONTINUE;
+    }, [](const TraversalStep&) {});
     
     // Remove duplicates and sort
     std::sort(variables.begin(), variables.end());
@@ -354,60 +421,14 @@ std::vector<std::string> ASTNode::collectVariables() const {
     return variables;
 }
 
-// Recursive helper to collect variables
-void ASTNode::collectVariablesRecursive(std::vector<std::string>& vars) const {
-    switch(type) {
-        case NodeType::VARIABLE:
-            vars.push_back(variable.name);
-            break;
-            
-        case NodeType::BINARY_OP:
-            op.left->collectVariablesRecursive(vars);
-            op.right->collectVariablesRecursive(vars);
-            break;
-            
-        case NodeType::UNARY_OP:
-            op.left->collectVariablesRecursive(vars);
-            break;
-            
-        case NodeType::FUNCTION_CALL:
-            for (const auto& arg : function.arguments) {
-                arg->collectVariablesRecursive(vars);
-            }
-            break;
-            
-        default:
-            // Numbers don't contain variables
-            break;
-    }
-}
-
-// Check if expression contains any variables
+// Check if expression contains any variables (stops at the first one)
 bool ASTNode::hasVariables() const {
-    return hasVariablesRecursive();
-}
-
-// Recursive helper to check for variables
-bool ASTNode::hasVariablesRecursive() const {
-    switch(type) {
-        case NodeType::VARIABLE:
-            return true;
-            
-        case NodeType::BINARY_OP:
-            return op.left->hasVariablesRecursive() || op.right->hasVariablesRecursive();
-            
-        case NodeType::UNARY_OP:
-            return op.left->hasVariablesRecursive();
-            
-        case NodeType::FUNCTION_CALL:
-            for (const auto& arg : function.arguments) {
-                if (arg->hasVariablesRecursive()) return true;
-            }
-            return false;
-            
-        default:
-            return false;
-    }
+    bool found = false;
+    ASTTraversal::walk(*this, [&](const TraversalStep& step) {
+        found = step.node->type == NodeType::VARIABLE;
+        return found ? Visit::STOP : Visit::CONTINUE;
+    }, [](const TraversalStep&) {});
+    return found;
 }
 
 // Helper function for printing indentation
@@ -416,10 +437,8 @@ void ASTNode::printIndent(int indent) const {
         std::cout << " ";
     }
 }
-void ASTNode::printTree(const std::string& prefix, bool isTail) const {
-    std::cout << prefix << (isTail ? "|--- " : "|--- ");
-
-    // Print node value
+// Print the node's own value (no children) as print(0, true) shows it
+void ASTNode::printLabel() const {
     switch (type) {
         case NodeType::NUMBER:
             std::cout << number.value << std::endl;
@@ -435,20 +454,4 @@ void ASTNode::printTree(const std::string& prefix, bool isTail) const {
             std::cout << function.functionName << "()" << std::endl;
             break;
     }
-
-    // Get children
-    std::vector<ASTNodePtr> children;
-    if (type == NodeType::BINARY_OP) {
-        if (op.left) children.push_back(op.left);
-        if (op.right) children.push_back(op.right);
-    } else if (type == NodeType::UNARY_OP) {
-        if (op.left) children.push_back(op.left);
-    } else if (type == NodeType::FUNCTION_CALL) {
-        children = function.arguments;
-    }
-
-    // Recurse on children
-    for (size_t i = 0; i < children.size(); ++i) {
-        children[i]->printTree(prefix + (isTail ? "    " : "|   "), i == children.size() - 1);
-    }
-}
\ No newline at end of file
+}
@@ -1,8 +1,10 @@
 #ifndef AST_NODE_H
 #define AST_NODE_H
 
+#include "Expected.h"
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <vector>
 #include <unordered_map>
@@ -14,8 +16,15 @@ class ASTNode;
 // shared_ptr for automatic memory management
 using ASTNodePtr = std::shared_ptr<ASTNode>;
 
+// Hashes std::string and std::string_view alike, so a VariableMap can be
+// searched by a view (arena symbols) without building a string
+struct VariableNameHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view name) const { return std::hash<std::string_view>()(name); }
+};
+
 // variable map type for easier lookup
-using VariableMap = std::unordered_map<std::string, double>;
+using VariableMap = std::unordered_map<std::string, double, VariableNameHash, std::equal_to<>>;
 
 // Types of AST nodes
 enum class NodeType {
@@ -93,6 +102,9 @@ public:
     // Evaluation functions
     double evaluate(const VariableMap& variables = {}) const;
     double evaluate(const std::vector<std::pair<std::string, double>>& variables) const;
+    // Same as evaluate, but errors come back as a code and the failing node
+    // instead of an exception
+    Expected<double, EvaluationError> tryEvaluate(const VariableMap& variables = {}) const;
     
     // Display functions
     void print(int indent = 0, bool tree = false) const;
@@ -102,6 +114,7 @@ public:
     static bool isUnaryOperator(OperatorType op);
     static int getPrecedence(OperatorType op);
     static std::string opToString(OperatorType op);
+    static std::string numberToString(double value);
     
     // Variable collection
     std::vector<std::string> collectVariables() const;
@@ -110,10 +123,9 @@ public:
     bool hasVariables() const;
     
 private:
-    void printTree(const std::string& prefix, bool isTail) const;
+    void printLabel() const;
     void printIndent(int indent) const;
-    void collectVariablesRecursive(std::vector<std::string>& vars) const;
-    bool hasVariablesRecursive() const;
+    void detachChildren(std::vector<ASTNodePtr>& pending);
 };
 
 #endif // AST_NODE_H
\ No newline at end of file
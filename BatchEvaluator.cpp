@@ -0,0 +1,212 @@
+#include "BatchEvaluator.h"
+#include "SimdKernels.h"
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+template <typename T>
+BasicBatchEvaluator<T>::BasicBatchEvaluator(const ASTNodePtr& ast)
+    : compiled(ast), constants(compiled.getConstants().begin(), compiled.getConstants().end()) {}
+
+// Evaluate all rows into a preallocated output array
+template <typename T>
+void BasicBatchEvaluator<T>::evaluate(const std::vector<std::span<const T>>& columns,
+                                      std::span<T> output) const {
+    checkColumns(columns, output.size());
+
+    // One chunk-sized register per stack level and per temporary, plus
+    // pointers to each level's values
+    size_t depth = std::max<size_t>(compiled.getMaxStackDepth(), 1);
+    std::vector<T> buffers((depth + compiled.getTempCount()) * CHUNK_SIZE);
+    std::vector<const T*> operands(depth);
+    std::string errorMessage;
+
+    for (size_t start = 0; start < output.size(); start += CHUNK_SIZE) {
+        size_t count = std::min(CHUNK_SIZE, output.size() - start);
+        size_t failed = evaluateChunk(columns, start, count, output.data() + start,
+                                      buffers.data(), operands.data(), errorMessage);
+        if (failed < count) {
+            throw BatchEvaluationError(errorMessage, start + failed);
+        }
+    }
+}
+
+// Evaluate all rows, marking the ones that fail instead of throwing
+template <typename T>
+size_t BasicBatchEvaluator<T>::evaluateIEEE(const std::vector<std::span<const T>>& columns,
+                                            std::span<T> output, std::vector<std::uint64_t>& failed) const {
+    checkColumns(columns, output.size());
+    failed.assign((output.size() + 63) / 64, 0);
+
+    size_t depth = std::max<size_t>(compiled.getMaxStackDepth(), 1);
+    std::vector<T> buffers((depth + compiled.getTempCount()) * CHUNK_SIZE);
+    std::vector<const T*> operands(depth);
+    std::string errorMessage;
+
+    for (size_t start = 0; start < output.size(); start += CHUNK_SIZE) {
+        size_t count = std::min(CHUNK_SIZE, output.size() - start);
+        evaluateChunk(columns, start, count, output.data() + start, buffers.data(), operands.data(),
+                      errorMessage, failed.data());
+    }
+
+    size_t failedRows = 0;
+    for (std::uint64_t word : failed) failedRows += std::popcount(word);
+    return failedRows;
+}
+
+// Evaluate all rows into a new vector
+template <typename T>
+std::vector<T> BasicBatchEvaluator<T>::evaluate(const std::vector<std::span<const T>>& columns) const {
+    size_t rows = columns.empty() ? 0 : columns[0].size();
+    for (const auto& column : columns) {
+        rows = std::min(rows, column.size());
+    }
+    std::vector<T> output(rows);
+    evaluate(columns, output);
+    return output;
+}
+
+template <typename T>
+void BasicBatchEvaluator<T>::checkColumns(const std::vector<std::span<const T>>& columns, size_t rows) const {
+    const auto& variables = compiled.getVariables();
+    if (columns.size() != variables.size()) {
+        throw std::runtime_error("Expected " + std::to_string(variables.size()) +
+                                 " columns but got " + std::to_string(columns.size()));
+    }
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (columns[i].size() < rows) {
+            throw std::runtime_error("Column for variable '" + variables[i] + "' is shorter than the output");
+        }
+    }
+}
+
+// Run the bytecode once per chunk, each instruction as a loop over the chunk
+template <typename T>
+size_t BasicBatchEvaluator<T>::evaluateChunk(const std::vector<std::span<const T>>& columns,
+                                             size_t start, size_t count, T* output,
+                                             T* buffers, const T** operands,
+                                             std::string& errorMessage, std::uint64_t* failed) const {
+    T* temps = buffers + std::max<size_t>(compiled.getMaxStackDepth(), 1) * CHUNK_SIZE;
+    size_t firstFailure = count;
+
+    // Keep the earliest failing row; for equal rows the earlier instruction wins,
+    // matching the order in which ASTNode::evaluate visits nodes
+    auto fail = [&](size_t lane, const std::string& message) {
+        if (lane < firstFailure) {
+            firstFailure = lane;
+            errorMessage = message;
+        }
+    };
+
+    // Bitmap mode: mark every lane from `first` on that fails the same check
+    auto mark = [&](size_t first, auto&& isBad) {
+        for (size_t lane = first; lane < count; ++lane) {
+            if (isBad(lane)) failed[(start + lane) / 64] |= std::uint64_t(1) << ((start + lane) % 64);
+        }
+    };
+
+    size_t sp = 0;
+    for (const Instruction& ins : compiled.getInstructions()) {
+        switch(ins.op) {
+            case OpCode::PUSH_CONST: {
+                T* out = buffers + sp * CHUNK_SIZE;
+                std::fill(out, out + count, constants[ins.operand]);
+                operands[sp++] = out;
+                break;
+            }
+            case OpCode::LOAD_VAR:
+                // Columns are read in place, no copy
+                operands[sp++] = columns[ins.operand].data() + start;
+                break;
+            case OpCode::STORE_TEMP: {
+                // Stack registers are reused, so shared values get their own buffer
+                T* out = temps + ins.operand * CHUNK_SIZE;
+                std::copy(operands[sp - 1], operands[sp - 1] + count, out);
+                operands[sp - 1] = out;
+                break;
+            }
+            case OpCode::LOAD_TEMP:
+                operands[sp++] = temps + ins.operand * CHUNK_SIZE;
+                break;
+            case OpCode::STORE_OUTPUT:
+                // Only emitted for programs compiled from several expressions
+                throw std::logic_error("multi-output programs are evaluated by MultiExpressionEngine");
+
+            case OpCode::ADD:
+            case OpCode::SUBTRACT:
+            case OpCode::MULTIPLY:
+            case OpCode::DIVIDE:
+            case OpCode::POWER: {
+                --sp;
+                const T* a = operands[sp - 1];
+                const T* b = operands[sp];
+                T* out = buffers + (sp - 1) * CHUNK_SIZE;
+                switch(ins.op) {
+                    case OpCode::ADD: SimdKernels::add(a, b, out, count); break;
+                    case OpCode::SUBTRACT: SimdKernels::subtract(a, b, out, count); break;
+                    case OpCode::MULTIPLY: SimdKernels::multiply(a, b, out, count); break;
+                    case OpCode::DIVIDE: {
+                        size_t bad = SimdKernels::divide(a, b, out, count);
+                        if (bad < count) {
+                            if (failed) mark(bad, [&](size_t lane) { return b[lane] == 0; });
+                            else fail(bad, "Division by zero");
+                        }
+                        break;
+                    }
+                    default: SimdKernels::power(a, b, out, count); break;
+                }
+                operands[sp - 1] = out;
+                break;
+            }
+
+            case OpCode::NEGATIVE:
+            case OpCode::SIN:
+            case OpCode::COS:
+            case OpCode::SQRT:
+            case OpCode::LOG:
+            case OpCode::EXP:
+            case OpCode::ABS: {
+                const T* a = operands[sp - 1];
+                T* out = buffers + (sp - 1) * CHUNK_SIZE;
+                switch(ins.op) {
+                    case OpCode::NEGATIVE: SimdKernels::negative(a, out, count); break;
+                    case OpCode::SIN: SimdKernels::sin(a, out, count); break;
+                    case OpCode::COS: SimdKernels::cos(a, out, count); break;
+                    // out may be a, so bitmap mode checks the inputs first
+                    case OpCode::SQRT: {
+                        if (failed) mark(0, [&](size_t lane) { return a[lane] < 0; });
+                        size_t bad = SimdKernels::sqrt(a, out, count);
+                        if (bad < count && !failed) fail(bad, "Square root of negative number");
+                        break;
+                    }
+                    case OpCode::LOG: {
+                        if (failed) mark(0, [&](size_t lane) { return a[lane] <= 0; });
+                        size_t bad = SimdKernels::log(a, out, count);
+                        if (bad < count && !failed) fail(bad, "Log of non-positive number");
+                        break;
+                    }
+                    case OpCode::EXP: SimdKernels::exp(a, out, count); break;
+                    default: SimdKernels::abs(a, out, count); break;
+                }
+                operands[sp - 1] = out;
+                break;
+            }
+
+            case OpCode::RAISE:
+                // Every row fails here
+                if (failed) {
+                    mark(0, [](size_t) { return true; });
+                    std::fill(output, output + count, std::numeric_limits<T>::quiet_NaN());
+                    return firstFailure;
+                }
+                fail(0, compiled.getErrorMessages()[ins.operand]);
+                return firstFailure;
+        }
+    }
+
+    std::copy(operands[0], operands[0] + count, output);
+    return firstFailure;
+}
+
+template class BasicBatchEvaluator<double>;
+template class BasicBatchEvaluator<float>;
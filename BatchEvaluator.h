@@ -0,0 +1,77 @@
+#ifndef BATCH_EVALUATOR_H
+#define BATCH_EVALUATOR_H
+
+#include "AST_NODE.h"
+#include "CompiledExpression.h"
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Evaluation error raised for a specific row of a batch
+class BatchEvaluationError : public std::runtime_error {
+public:
+    BatchEvaluationError(const std::string& message, size_t row)
+        : std::runtime_error(message), row(row) {}
+
+    // Lowest row index that failed
+    size_t getRow() const { return row; }
+
+private:
+    size_t row;
+};
+
+// Evaluates one expression over column arrays, one operator at a time per chunk
+// of rows. T is double (BatchEvaluator) or float (FloatBatchEvaluator). Float
+// runs twice as many rows per SIMD instruction and moves half the bytes; the
+// AST's constants are rounded to T once, at construction. Domain checks see
+// the T values, so a row near an edge (a divisor that underflows to zero,
+// say) can fail in one precision and not the other. See PrecisionReport for
+// how far float results drift from double.
+template <typename T>
+class BasicBatchEvaluator {
+public:
+    // Rows processed per chunk (intermediate buffers stay in L1/L2)
+    static constexpr size_t CHUNK_SIZE = 256;
+
+    explicit BasicBatchEvaluator(const ASTNodePtr& ast);
+
+    // Variable names in column order (same as collectVariables())
+    const std::vector<std::string>& getVariables() const { return compiled.getVariables(); }
+
+    // Evaluate all rows; columns[i] holds the values of getVariables()[i].
+    // Throws BatchEvaluationError for the lowest failing row, with the same
+    // message ASTNode::evaluate would throw for that row.
+    void evaluate(const std::vector<std::span<const T>>& columns, std::span<T> output) const;
+    std::vector<T> evaluate(const std::vector<std::span<const T>>& columns) const;
+
+    // Exception-free variant for data with some bad rows. A row that would
+    // throw gets the IEEE result instead (x/0 = +-inf or NaN, sqrt or log of a
+    // negative = NaN, log(0) = -inf, NaN for unknown functions) and its bit set
+    // in `failed`: bit r % 64 of word r / 64, resized to cover every row.
+    // Returns the number of such rows. Only checkColumns errors are thrown.
+    size_t evaluateIEEE(const std::vector<std::span<const T>>& columns, std::span<T> output,
+                        std::vector<std::uint64_t>& failed) const;
+
+    // Throws std::runtime_error unless there is one column per variable, each
+    // holding at least `rows` values
+    void checkColumns(const std::vector<std::span<const T>>& columns, size_t rows) const;
+
+private:
+    CompiledExpression compiled;
+    std::vector<T> constants;      // compiled.getConstants() as T
+
+    // Evaluate rows [start, start + count) into output; returns the first failing lane or count.
+    // buffers holds the stack registers followed by one register per temporary.
+    // With a `failed` bitmap every failing row is marked there instead, and
+    // errorMessage is left alone.
+    size_t evaluateChunk(const std::vector<std::span<const T>>& columns, size_t start, size_t count,
+                         T* output, T* buffers, const T** operands,
+                         std::string& errorMessage, std::uint64_t* failed = nullptr) const;
+};
+
+using BatchEvaluator = BasicBatchEvaluator<double>;
+using FloatBatchEvaluator = BasicBatchEvaluator<float>;
+
+#endif // BATCH_EVALUATOR_H
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include "BlockFilter.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+BlockStatistics::BlockStatistics(const std::vector<std::span<const double>>& columns, size_t rows,
+                                 size_t blockRows)
+    : rows(rows), blockRows(std::max<size_t>(blockRows, 1)), columnCount(columns.size()) {
+    for (const auto& column : columns) {
+        if (column.size() < rows) {
+            throw std::runtime_error("Column is shorter than " + std::to_string(rows) + " rows");
+        }
+    }
+
+    ranges.resize(getBlockCount() * columnCount);
+    for (size_t block = 0; block < getBlockCount(); ++block) {
+        size_t start = block * this->blockRows;
+        size_t end = std::min(rows, start + this->blockRows);
+        for (size_t c = 0; c < columnCount; ++c) {
+            Interval range = Interval::empty();
+            for (size_t r = start; r < end; ++r) {
+                double value = columns[c][r];
+                if (std::isnan(value)) {
+                    range.canBeNaN = true;
+                } else {
+                    range.lo = std::min(range.lo, value);
+                    range.hi = std::max(range.hi, value);
+                }
+            }
+            ranges[block * columnCount + c] = range;
+        }
+    }
+}
+
+BlockFilter::BlockFilter(const ASTNodePtr& ast, Comparison comparison, double threshold)
+    : batch(ast), intervals(ast), comparison(comparison), threshold(threshold) {}
+
+bool BlockFilter::matches(double value) const {
+    switch(comparison) {
+        case Comparison::LESS: return value < threshold;
+        case Comparison::LESS_EQUAL: return value <= threshold;
+        case Comparison::GREATER: return value > threshold;
+        case Comparison::GREATER_EQUAL: return value >= threshold;
+    }
+    return false;
+}
+
+std::vector<size_t> BlockFilter::select(const std::vector<std::span<const double>>& columns,
+                                        const BlockStatistics& statistics) {
+    if (statistics.getColumnCount() != columns.size()) {
+        throw std::runtime_error("Statistics cover " + std::to_string(statistics.getColumnCount()) +
+                                 " columns but got " + std::to_string(columns.size()));
+    }
+    size_t rows = statistics.getRows();
+    batch.checkColumns(columns, rows);
+
+    skippedBlocks = acceptedBlocks = evaluatedBlocks = 0;
+    std::vector<size_t> selected;
+    std::vector<Interval> bounds(columns.size());
+    std::vector<std::span<const double>> blockColumns(columns.size());
+    std::vector<double> output(statistics.getBlockRows());
+
+    for (size_t block = 0; block < statistics.getBlockCount(); ++block) {
+        size_t start = block * statistics.getBlockRows();
+        size_t count = std::min(statistics.getBlockRows(), rows - start);
+
+        for (size_t c = 0; c < columns.size(); ++c) bounds[c] = statistics.get(block, c);
+        Interval range = intervals.evaluate(bounds);
+
+        if (!range.canFail) {
+            // Whether no value, or every value, in the range passes
+            bool none = range.isEmpty();
+            bool all = !range.isEmpty() && !range.canBeNaN;
+            switch(comparison) {
+                case Comparison::LESS:
+                    none = none || range.lo >= threshold;
+                    all = all && range.hi < threshold;
+                    break;
+                case Comparison::LESS_EQUAL:
+                    none = none || range.lo > threshold;
+                    all = all && range.hi <= threshold;
+                    break;
+                case Comparison::GREATER:
+                    none = none || range.hi <= threshold;
+                    all = all && range.lo > threshold;
+                    break;
+                case Comparison::GREATER_EQUAL:
+                    none = none || range.hi < threshold;
+                    all = all && range.lo >= threshold;
+                    break;
+            }
+            if (none) {
+                ++skippedBlocks;
+                continue;
+            }
+            if (all) {
+                ++acceptedBlocks;
+                for (size_t r = 0; r < count; ++r) selected.push_back(start + r);
+                continue;
+            }
+        }
+
+        ++evaluatedBlocks;
+        for (size_t c = 0; c < columns.size(); ++c) blockColumns[c] = columns[c].subspan(start, count);
+        try {
+            batch.evaluate(blockColumns, std::span<double>(output.data(), count));
+        } catch (const BatchEvaluationError& e) {
+            throw BatchEvaluationError(e.what(), start + e.getRow());
+        }
+        for (size_t r = 0; r < count; ++r) {
+            if (matches(output[r])) selected.push_back(start + r);
+        }
+    }
+    return selected;
+}
@@ -0,0 +1,72 @@
+#ifndef BLOCK_FILTER_H
+#define BLOCK_FILTER_H
+
+#include "BatchEvaluator.h"
+#include "IntervalEvaluator.h"
+#include <span>
+#include <string>
+#include <vector>
+
+enum class Comparison { LESS, LESS_EQUAL, GREATER, GREATER_EQUAL };
+
+// Min/max of each column over fixed blocks of rows, computed once per data set
+class BlockStatistics {
+public:
+    static constexpr size_t DEFAULT_BLOCK_ROWS = 4 * BatchEvaluator::CHUNK_SIZE;
+
+    // Statistics for the first `rows` values of each column
+    BlockStatistics(const std::vector<std::span<const double>>& columns, size_t rows,
+                    size_t blockRows = DEFAULT_BLOCK_ROWS);
+
+    size_t getRows() const { return rows; }
+    size_t getBlockRows() const { return blockRows; }
+    size_t getBlockCount() const { return blockRows ? (rows + blockRows - 1) / blockRows : 0; }
+    size_t getColumnCount() const { return columnCount; }
+
+    // Range of a column within a block; canBeNaN if the block holds a NaN
+    const Interval& get(size_t block, size_t column) const { return ranges[block * columnCount + column]; }
+
+private:
+    size_t rows;
+    size_t blockRows;
+    size_t columnCount;
+    std::vector<Interval> ranges;    // block-major
+};
+
+// Rows where `expression <comparison> threshold` holds. Each block's column
+// ranges go through IntervalEvaluator first: blocks that cannot match are
+// skipped, blocks where every row must match are taken whole, and only the
+// rest are evaluated with BatchEvaluator. NaN results never match. A block is
+// only skipped or taken whole when none of its rows can throw, so errors are
+// the ones evaluating every row would give (BatchEvaluationError, lowest row).
+class BlockFilter {
+public:
+    BlockFilter(const ASTNodePtr& ast, Comparison comparison, double threshold);
+
+    // Variable names in column order (same as collectVariables())
+    const std::vector<std::string>& getVariables() const { return batch.getVariables(); }
+
+    // Matching row indices, ascending. columns[i] holds getVariables()[i];
+    // statistics must have been computed from the same columns.
+    std::vector<size_t> select(const std::vector<std::span<const double>>& columns,
+                               const BlockStatistics& statistics);
+
+    // Blocks of the last select(), by how they were decided
+    size_t getSkippedBlocks() const { return skippedBlocks; }
+    size_t getAcceptedBlocks() const { return acceptedBlocks; }
+    size_t getEvaluatedBlocks() const { return evaluatedBlocks; }
+
+private:
+    BatchEvaluator batch;
+    IntervalEvaluator intervals;
+    Comparison comparison;
+    double threshold;
+
+    size_t skippedBlocks = 0;
+    size_t acceptedBlocks = 0;
+    size_t evaluatedBlocks = 0;
+
+    bool matches(double value) const;
+};
+
+#endif // BLOCK_FILTER_H
@@ -0,0 +1,248 @@
+#include "CodeGenerator.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+// Writes one statement per operator or function node and returns the C++
+// expression holding each node's value. Checks either throw (scalar) or set
+// `bad` (batch); code after an unconditional error is dropped.
+class SourceEmitter {
+public:
+    enum class Mode { SCALAR, BATCH };
+
+    SourceEmitter(Mode mode, const std::vector<std::string>& variables, std::string indent)
+        : mode(mode), variables(variables), indent(std::move(indent)) {}
+
+    std::string emit(const ASTNode* node);
+
+    std::string body;
+    bool raised = false;
+    bool hasChecks = false;
+
+private:
+    Mode mode;
+    const std::vector<std::string>& variables;
+    std::string indent;
+    std::unordered_map<const ASTNode*, std::string> values;   // shared nodes are emitted once
+    size_t nextTemp = 0;
+
+    std::string define(const std::string& expression);
+    void check(const std::string& condition, const std::string& message);
+    void raise(const std::string& message);
+};
+
+// C++ string literal contents
+static std::string escape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+std::string SourceEmitter::define(const std::string& expression) {
+    std::string name = "t" + std::to_string(nextTemp++);
+    body += indent + "const double " + name + " = " + expression + ";\n";
+    return name;
+}
+
+void SourceEmitter::check(const std::string& condition, const std::string& message) {
+    hasChecks = true;
+    if (mode == Mode::SCALAR) {
+        body += indent + "if (" + condition + ") throw std::runtime_error(\"" + escape(message) + "\");\n";
+    } else {
+        body += indent + "bad |= (" + condition + ");\n";
+    }
+}
+
+void SourceEmitter::raise(const std::string& message) {
+    if (mode == Mode::SCALAR) {
+        body += indent + "throw std::runtime_error(\"" + escape(message) + "\");\n";
+    }
+    raised = true;
+}
+
+// Children first, in the order ASTNode::evaluate visits them
+std::string SourceEmitter::emit(const ASTNode* node) {
+    if (raised) return {};
+    auto it = values.find(node);
+    if (it != values.end()) return it->second;
+
+    std::string value;
+    switch(node->type) {
+        case NodeType::NUMBER:
+            return CodeGenerator::formatNumber(node->number.value);
+
+        case NodeType::VARIABLE: {
+            auto slot = std::lower_bound(variables.begin(), variables.end(), node->variable.name) - variables.begin();
+            return mode == Mode::SCALAR ? "slots[" + std::to_string(slot) + "]"
+                                        : "c" + std::to_string(slot) + "[r]";
+        }
+
+        case NodeType::BINARY_OP: {
+            std::string a = emit(node->op.left.get());
+            std::string b = emit(node->op.right.get());
+            if (raised) return {};
+            switch(node->op.op) {
+                case OperatorType::ADD: value = define(a + " + " + b); break;
+                case OperatorType::SUBTRACT: value = define(a + " - " + b); break;
+                case OperatorType::MULTIPLY: value = define(a + " * " + b); break;
+                case OperatorType::DIVIDE:
+                    check(b + " == 0", "Division by zero");
+                    value = define(a + " / " + b);
+                    break;
+                case OperatorType::POWER: value = define("std::pow(" + a + ", " + b + ")"); break;
+                default: raise("Unknown binary operator"); return {};
+            }
+            break;
+        }
+
+        case NodeType::UNARY_OP: {
+            std::string a = emit(node->op.left.get());
+            if (raised) return {};
+            if (node->op.op != OperatorType::NEGATIVE) {
+                raise("Unknown unary operator");
+                return {};
+            }
+            value = define("-" + a);
+            break;
+        }
+
+        case NodeType::FUNCTION_CALL: {
+            const std::string& funcName = node->function.functionName;
+            std::vector<std::string> args;
+            for (const auto& arg : node->function.arguments) {
+                args.push_back(emit(arg.get()));
+                if (raised) return {};
+            }
+            if (args.size() == 1) {
+                const std::string& a = args[0];
+                if (funcName == "sin") { value = define("std::sin(" + a + ")"); break; }
+                if (funcName == "cos") { value = define("std::cos(" + a + ")"); break; }
+                if (funcName == "exp") { value = define("std::exp(" + a + ")"); break; }
+                if (funcName == "abs") { value = define("std::abs(" + a + ")"); break; }
+                if (funcName == "sqrt") {
+                    check(a + " < 0", "Square root of negative number");
+                    value = define("std::sqrt(" + a + ")");
+                    break;
+                }
+                if (funcName == "log") {
+                    check(a + " <= 0", "Log of non-positive number");
+                    value = define("std::log(" + a + ")");
+                    break;
+                }
+            }
+            raise("Unknown function or wrong number of arguments: " + funcName);
+            return {};
+        }
+    }
+
+    values.emplace(node, value);
+    return value;
+}
+
+bool CodeGenerator::isValidIdentifier(const std::string& name) {
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) return false;
+    return std::all_of(name.begin(), name.end(), [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    });
+}
+
+// 17 significant digits always read back exactly; inf and NaN are spelled as bit patterns
+std::string CodeGenerator::formatNumber(double value) {
+    if (!std::isfinite(value)) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "std::bit_cast<double>(UINT64_C(0x%016llx))",
+                      static_cast<unsigned long long>(bits));
+        return buffer;
+    }
+
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    std::string text = buffer;
+    if (text.find_first_of(".e") == std::string::npos) text += ".0";
+    return std::signbit(value) ? "(" + text + ")" : text;
+}
+
+std::string CodeGenerator::generatePrelude() {
+    return "#include <bit>\n"
+           "#include <cmath>\n"
+           "#include <cstddef>\n"
+           "#include <cstdint>\n"
+           "#include <stdexcept>\n";
+}
+
+// Header comment listing the slot order
+static std::string describe(const ASTNodePtr& ast, const std::vector<std::string>& variables) {
+    std::string text = "// " + ast->toString() + "\n// slots:";
+    for (size_t i = 0; i < variables.size(); ++i) {
+        text += " [" + std::to_string(i) + "] " + variables[i];
+    }
+    return text + (variables.empty() ? " none\n" : "\n");
+}
+
+std::string CodeGenerator::generateScalar(const ASTNodePtr& ast, const std::string& name) {
+    if (!ast) throw std::runtime_error("Cannot generate code for an empty AST");
+    if (!isValidIdentifier(name)) throw std::runtime_error("Invalid function name: " + name);
+
+    std::vector<std::string> variables = slotOrder(ast);
+    SourceEmitter emitter(SourceEmitter::Mode::SCALAR, variables, "    ");
+    std::string result = emitter.emit(ast.get());
+
+    std::stringstream ss;
+    ss << describe(ast, variables);
+    ss << "double " << name << "(const double* slots) {\n";
+    if (variables.empty()) ss << "    (void)slots;\n";
+    ss << emitter.body;
+    if (!emitter.raised) ss << "    return " << result << ";\n";
+    ss << "}\n";
+    return ss.str();
+}
+
+std::string CodeGenerator::generateBatch(const ASTNodePtr& ast, const std::string& name) {
+    if (!ast) throw std::runtime_error("Cannot generate code for an empty AST");
+    if (!isValidIdentifier(name)) throw std::runtime_error("Invalid function name: " + name);
+
+    std::vector<std::string> variables = slotOrder(ast);
+    SourceEmitter emitter(SourceEmitter::Mode::BATCH, variables, "        ");
+    std::string result = emitter.emit(ast.get());
+
+    std::stringstream ss;
+    ss << describe(ast, variables);
+    ss << "size_t " << name << "(const double* const* columns, double* out, size_t rows) {\n";
+    if (emitter.raised) {
+        // Every row fails
+        ss << "    (void)columns;\n    (void)out;\n    (void)rows;\n    return 0;\n}\n";
+        return ss.str();
+    }
+    if (variables.empty()) ss << "    (void)columns;\n";
+    for (size_t i = 0; i < variables.size(); ++i) {
+        ss << "    const double* c" << i << " = columns[" << i << "];\n";
+    }
+
+    if (!emitter.hasChecks) {
+        ss << "    for (size_t r = 0; r < rows; ++r) {\n" << emitter.body
+           << "        out[r] = " << result << ";\n    }\n    return rows;\n}\n";
+        return ss.str();
+    }
+
+    // Checks are folded into one flag so the main loop stays branch-free; the
+    // rare failing batch is rescanned for its first bad row
+    ss << "    bool failed = false;\n";
+    ss << "    for (size_t r = 0; r < rows; ++r) {\n        bool bad = false;\n" << emitter.body
+       << "        out[r] = " << result << ";\n        failed |= bad;\n    }\n";
+    ss << "    if (!failed) return rows;\n";
+    ss << "    for (size_t r = 0; r < rows; ++r) {\n        bool bad = false;\n" << emitter.body
+       << "        (void)" << result << ";\n        if (bad) return r;\n    }\n";
+    ss << "    return rows;\n}\n";
+    return ss.str();
+}
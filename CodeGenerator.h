@@ -0,0 +1,39 @@
+#ifndef CODE_GENERATOR_H
+#define CODE_GENERATOR_H
+
+#include "AST_NODE.h"
+#include <string>
+#include <vector>
+
+// Emits standalone C++ source for an expression, for ahead-of-time compiled
+// evaluators. Variables are bound to slots in collectVariables() order and
+// shared DAG nodes become one local each. The generated code only needs the
+// standard headers from generatePrelude(). It matches ASTNode::evaluate bit for
+// bit when compiled without -ffast-math, with -ffp-contract=off, and with
+// -fno-builtin-{pow,sin,cos,exp,log} so the compiler cannot replace libm calls
+// (GCC turns pow(x, 2.0) into x * x, which rounds differently).
+class CodeGenerator {
+public:
+    // double name(const double* slots)
+    // Throws std::runtime_error with the ASTNode::evaluate message on failure.
+    static std::string generateScalar(const ASTNodePtr& ast, const std::string& name);
+
+    // size_t name(const double* const* columns, double* out, size_t rows)
+    // columns[i] holds slot i. Branch-free loop over all rows; returns rows on
+    // success, otherwise the lowest failing row (the scalar function reports
+    // the message for that row).
+    static std::string generateBatch(const ASTNodePtr& ast, const std::string& name);
+
+    // Includes required by the generated functions
+    static std::string generatePrelude();
+
+    // Variable names in slot order
+    static std::vector<std::string> slotOrder(const ASTNodePtr& ast) { return ast->collectVariables(); }
+
+    // Exact C++ literal for a double
+    static std::string formatNumber(double value);
+
+    static bool isValidIdentifier(const std::string& name);
+};
+
+#endif // CODE_GENERATOR_H
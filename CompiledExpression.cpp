@@ -0,0 +1,319 @@
+#include "CompiledExpression.h"
+#include "HashConsBuilder.h"
+#include <stdexcept>
+#include <sstream>
+#include <cmath>
+#include <algorithm>
+
+// Compile an AST into bytecode
+CompiledExpression::CompiledExpression(const ASTNodePtr& ast) {
+    if (!ast) {
+        throw std::runtime_error("Cannot compile an empty AST");
+    }
+
+    // Slots follow collectVariables() order (sorted, unique)
+    variables = ast->collectVariables();
+
+    TempMap temps;
+    for (const ASTNode* node : HashConsBuilder::findSharedNodes(ast)) {
+        temps.emplace(node, NO_TEMP);
+    }
+
+    size_t depth = 0;
+    compileNode(ast.get(), depth, temps);
+}
+
+// Compile several expressions into one multi-output program
+CompiledExpression::CompiledExpression(const std::vector<ASTNodePtr>& outputs)
+    : outputCount(outputs.size()), storesOutputs(true) {
+    for (const auto& ast : outputs) {
+        if (!ast) {
+            throw std::runtime_error("Cannot compile an empty AST");
+        }
+        auto names = ast->collectVariables();
+        variables.insert(variables.end(), names.begin(), names.end());
+    }
+    std::sort(variables.begin(), variables.end());
+    variables.erase(std::unique(variables.begin(), variables.end()), variables.end());
+
+    TempMap temps;
+    for (const ASTNode* node : HashConsBuilder::findSharedNodes(outputs)) {
+        temps.emplace(node, NO_TEMP);
+    }
+
+    size_t depth = 0;
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        compileNode(outputs[i].get(), depth, temps);
+        emit(OpCode::STORE_OUTPUT, static_cast<std::uint32_t>(i), depth, -1);
+    }
+}
+
+// Append an instruction and track stack depth
+void CompiledExpression::emit(OpCode op, std::uint32_t operand, size_t& depth, int stackEffect) {
+    instructions.push_back({op, 0, operand});
+    depth += stackEffect;
+    maxStackDepth = std::max(maxStackDepth, depth);
+}
+
+// Append a RAISE that stands for a node with `pops` operands
+void CompiledExpression::emitRaise(const std::string& message, size_t pops, size_t& depth) {
+    if (pops > UINT16_MAX) {
+        throw std::runtime_error("Too many function arguments");
+    }
+    instructions.push_back({OpCode::RAISE, static_cast<std::uint16_t>(pops), addErrorMessage(message)});
+    depth = depth - pops + 1;
+    maxStackDepth = std::max(maxStackDepth, depth);
+}
+
+// Store an error message, reusing identical entries
+std::uint32_t CompiledExpression::addErrorMessage(const std::string& message) {
+    auto it = std::find(errorMessages.begin(), errorMessages.end(), message);
+    if (it != errorMessages.end()) {
+        return static_cast<std::uint32_t>(it - errorMessages.begin());
+    }
+    errorMessages.push_back(message);
+    return static_cast<std::uint32_t>(errorMessages.size() - 1);
+}
+
+// Emit code for a node; a shared node is computed on first use and loaded
+// from its temporary afterwards
+void CompiledExpression::compileNode(const ASTNode* node, size_t& depth, TempMap& temps) {
+    auto it = temps.find(node);
+    if (it == temps.end()) {
+        compileOperation(node, depth, temps);
+        return;
+    }
+
+    if (it->second != NO_TEMP) {
+        emit(OpCode::LOAD_TEMP, it->second, depth, 1);
+        return;
+    }
+    compileOperation(node, depth, temps);
+    it->second = static_cast<std::uint32_t>(tempCount++);
+    emit(OpCode::STORE_TEMP, it->second, depth, 0);
+}
+
+// Emit postfix code for a node (children first, same order as evaluate)
+void CompiledExpression::compileOperation(const ASTNode* node, size_t& depth, TempMap& temps) {
+    switch(node->type) {
+        case NodeType::NUMBER:
+            constants.push_back(node->number.value);
+            emit(OpCode::PUSH_CONST, static_cast<std::uint32_t>(constants.size() - 1), depth, 1);
+            break;
+
+        case NodeType::VARIABLE: {
+            auto it = std::lower_bound(variables.begin(), variables.end(), node->variable.name);
+            emit(OpCode::LOAD_VAR, static_cast<std::uint32_t>(it - variables.begin()), depth, 1);
+            break;
+        }
+
+        case NodeType::BINARY_OP:
+            compileNode(node->op.left.get(), depth, temps);
+            compileNode(node->op.right.get(), depth, temps);
+
+            switch(node->op.op) {
+                case OperatorType::ADD: emit(OpCode::ADD, 0, depth, -1); break;
+                case OperatorType::SUBTRACT: emit(OpCode::SUBTRACT, 0, depth, -1); break;
+                case OperatorType::MULTIPLY: emit(OpCode::MULTIPLY, 0, depth, -1); break;
+                case OperatorType::DIVIDE: emit(OpCode::DIVIDE, 0, depth, -1); break;
+                case OperatorType::POWER: emit(OpCode::POWER, 0, depth, -1); break;
+                default: emitRaise("Unknown binary operator", 2, depth); break;
+            }
+            break;
+
+        case NodeType::UNARY_OP:
+            compileNode(node->op.left.get(), depth, temps);
+
+            if (node->op.op == OperatorType::NEGATIVE) {
+                emit(OpCode::NEGATIVE, 0, depth, 0);
+            } else {
+                emitRaise("Unknown unary operator", 1, depth);
+            }
+            break;
+
+        case NodeType::FUNCTION_CALL: {
+            const std::string& funcName = node->function.functionName;
+            const auto& args = node->function.arguments;
+            for (const auto& arg : args) {
+                compileNode(arg.get(), depth, temps);
+            }
+
+            // Only single-argument built-ins are supported, anything else fails at run time
+            if (args.size() == 1) {
+                if (funcName == "sin") { emit(OpCode::SIN, 0, depth, 0); break; }
+                if (funcName == "cos") { emit(OpCode::COS, 0, depth, 0); break; }
+                if (funcName == "sqrt") { emit(OpCode::SQRT, 0, depth, 0); break; }
+                if (funcName == "log") { emit(OpCode::LOG, 0, depth, 0); break; }
+                if (funcName == "exp") { emit(OpCode::EXP, 0, depth, 0); break; }
+                if (funcName == "abs") { emit(OpCode::ABS, 0, depth, 0); break; }
+            }
+            emitRaise("Unknown function or wrong number of arguments: " + funcName, args.size(), depth);
+            break;
+        }
+    }
+}
+
+// Evaluate with VariableMap
+double CompiledExpression::evaluate(const VariableMap& variableMap) const {
+    // Resolve slots once; missing variables only fail when they are actually loaded
+    std::vector<double> slots(variables.size(), 0.0);
+    std::vector<unsigned char> defined(variables.size(), 0);
+    for (size_t i = 0; i < variables.size(); ++i) {
+        auto it = variableMap.find(variables[i]);
+        if (it != variableMap.end()) {
+            slots[i] = it->second;
+            defined[i] = 1;
+        }
+    }
+    return execute(slots.data(), defined.data());
+}
+
+// Overloaded evaluate function for vector of pairs
+double CompiledExpression::evaluate(const std::vector<std::pair<std::string, double>>& variableList) const {
+    std::vector<double> slots(variables.size(), 0.0);
+    std::vector<unsigned char> defined(variables.size(), 0);
+    for (const auto& [name, value] : variableList) {
+        auto it = std::lower_bound(variables.begin(), variables.end(), name);
+        if (it != variables.end() && *it == name) {
+            size_t slot = it - variables.begin();
+            slots[slot] = value;
+            defined[slot] = 1;
+        }
+    }
+    return execute(slots.data(), defined.data());
+}
+
+// Evaluate from slot-ordered values
+double CompiledExpression::evaluate(std::span<const double> slots) const {
+    if (slots.size() < variables.size()) {
+        throw std::runtime_error("Expected " + std::to_string(variables.size()) + " slots but got " +
+                                 std::to_string(slots.size()));
+    }
+    return execute(slots.data(), nullptr);
+}
+
+// Evaluate every output from slot-ordered values
+void CompiledExpression::evaluateAll(std::span<const double> slots, std::span<double> outputs) const {
+    if (slots.size() < variables.size() || outputs.size() < outputCount) {
+        throw std::runtime_error("Expected " + std::to_string(variables.size()) + " slots and " +
+                                 std::to_string(outputCount) + " outputs but got " +
+                                 std::to_string(slots.size()) + " and " + std::to_string(outputs.size()));
+    }
+    double result = execute(slots.data(), nullptr, outputs.data());
+    if (!storesOutputs) outputs[0] = result;
+}
+
+// Non-recursive interpreter loop, in double here and in every TypedExpression
+// precision
+template <typename T>
+T CompiledExpression::execute(const T* constantValues, const T* slots, const unsigned char* defined,
+                              T* outputs) const {
+    // Small programs keep their value stack on the native stack
+    constexpr size_t inlineStackSize = 64;
+    T inlineStack[inlineStackSize];
+    std::vector<T> heapStack;
+    T* stack = inlineStack;
+    if (maxStackDepth + tempCount > inlineStackSize) {
+        heapStack.resize(maxStackDepth + tempCount);
+        stack = heapStack.data();
+    }
+    T* temps = stack + maxStackDepth;
+    // Multi-output programs pop every value (STORE_OUTPUT), so the bottom slot
+    // is the result only when something is left on it
+    stack[0] = 0;
+
+    // sp points one past the top of the stack
+    T* sp = stack;
+    for (const Instruction& ins : instructions) {
+        switch(ins.op) {
+            case OpCode::PUSH_CONST:
+                *sp++ = constantValues[ins.operand];
+                break;
+            case OpCode::LOAD_VAR:
+                if (defined && !defined[ins.operand]) {
+                    throw std::runtime_error("Undefined variable: " + variables[ins.operand]);
+                }
+                *sp++ = slots[ins.operand];
+                break;
+            case OpCode::STORE_TEMP: temps[ins.operand] = sp[-1]; break;
+            case OpCode::LOAD_TEMP: *sp++ = temps[ins.operand]; break;
+            case OpCode::STORE_OUTPUT: --sp; if (outputs) outputs[ins.operand] = *sp; break;
+            case OpCode::ADD: --sp; sp[-1] = sp[-1] + sp[0]; break;
+            case OpCode::SUBTRACT: --sp; sp[-1] = sp[-1] - sp[0]; break;
+            case OpCode::MULTIPLY: --sp; sp[-1] = sp[-1] * sp[0]; break;
+            case OpCode::DIVIDE:
+                --sp;
+                if (sp[0] == 0) throw std::runtime_error("Division by zero");
+                sp[-1] = sp[-1] / sp[0];
+                break;
+            case OpCode::POWER: --sp; sp[-1] = std::pow(sp[-1], sp[0]); break;
+            case OpCode::NEGATIVE: sp[-1] = -sp[-1]; break;
+            case OpCode::SIN: sp[-1] = std::sin(sp[-1]); break;
+            case OpCode::COS: sp[-1] = std::cos(sp[-1]); break;
+            case OpCode::SQRT:
+                if (sp[-1] < 0) throw std::runtime_error("Square root of negative number");
+                sp[-1] = std::sqrt(sp[-1]);
+                break;
+            case OpCode::LOG:
+                if (sp[-1] <= 0) throw std::runtime_error("Log of non-positive number");
+                sp[-1] = std::log(sp[-1]);
+                break;
+            case OpCode::EXP: sp[-1] = std::exp(sp[-1]); break;
+            case OpCode::ABS: sp[-1] = std::abs(sp[-1]); break;
+            case OpCode::RAISE:
+                throw std::runtime_error(errorMessages[ins.operand]);
+        }
+    }
+
+    return stack[0];
+}
+
+template float CompiledExpression::execute(const float*, const float*, const unsigned char*, float*) const;
+template double CompiledExpression::execute(const double*, const double*, const unsigned char*, double*) const;
+template long double CompiledExpression::execute(const long double*, const long double*, const unsigned char*,
+                                                 long double*) const;
+
+// Human readable listing of the bytecode
+std::string CompiledExpression::disassemble() const {
+    std::stringstream ss;
+    for (size_t i = 0; i < instructions.size(); ++i) {
+        const Instruction& ins = instructions[i];
+        ss << i << ": " << opCodeToString(ins.op);
+        switch(ins.op) {
+            case OpCode::PUSH_CONST: ss << " " << constants[ins.operand]; break;
+            case OpCode::LOAD_VAR: ss << " " << variables[ins.operand]; break;
+            case OpCode::STORE_TEMP:
+            case OpCode::LOAD_TEMP: ss << " t" << ins.operand; break;
+            case OpCode::STORE_OUTPUT: ss << " o" << ins.operand; break;
+            case OpCode::RAISE: ss << " \"" << errorMessages[ins.operand] << "\""; break;
+            default: break;
+        }
+        ss << "\n";
+    }
+    return ss.str();
+}
+
+// Convert opcode to string
+std::string CompiledExpression::opCodeToString(OpCode op) {
+    switch(op) {
+        case OpCode::PUSH_CONST: return "PUSH_CONST";
+        case OpCode::LOAD_VAR: return "LOAD_VAR";
+        case OpCode::STORE_TEMP: return "STORE_TEMP";
+        case OpCode::LOAD_TEMP: return "LOAD_TEMP";
+        case OpCode::STORE_OUTPUT: return "STORE_OUTPUT";
+        case OpCode::ADD: return "ADD";
+        case OpCode::SUBTRACT: return "SUBTRACT";
+        case OpCode::MULTIPLY: return "MULTIPLY";
+        case OpCode::DIVIDE: return "DIVIDE";
+        case OpCode::POWER: return "POWER";
+        case OpCode::NEGATIVE: return "NEGATIVE";
+        case OpCode::SIN: return "SIN";
+        case OpCode::COS: return "COS";
+        case OpCode::SQRT: return "SQRT";
+        case OpCode::LOG: return "LOG";
+        case OpCode::EXP: return "EXP";
+        case OpCode::ABS: return "ABS";
+        case OpCode::RAISE: return "RAISE";
+        default: return "?";
+    }
+}
\ No newline at end of file
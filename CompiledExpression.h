@@ -0,0 +1,120 @@
+#ifndef COMPILED_EXPRESSION_H
+#define COMPILED_EXPRESSION_H
+
+#include "AST_NODE.h"
+#include "VariableBinding.h"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Bytecode operations for the stack machine
+enum class OpCode : std::uint8_t {
+    PUSH_CONST,   // push constants[operand]
+    LOAD_VAR,     // push value of variable slot [operand]
+    STORE_TEMP,   // copy the top of the stack into temporary [operand] (shared DAG node)
+    LOAD_TEMP,    // push temporary [operand]
+    STORE_OUTPUT, // pop a into output [operand] (multi-output programs only)
+    ADD,          // pop b, pop a, push a + b
+    SUBTRACT,     // pop b, pop a, push a - b
+    MULTIPLY,     // pop b, pop a, push a * b
+    DIVIDE,       // pop b, pop a, push a / b (throws on b == 0)
+    POWER,        // pop b, pop a, push pow(a, b)
+    NEGATIVE,     // pop a, push -a
+    SIN,          // pop a, push sin(a)
+    COS,          // pop a, push cos(a)
+    SQRT,         // pop a, push sqrt(a) (throws on a < 0)
+    LOG,          // pop a, push log(a) (throws on a <= 0)
+    EXP,          // pop a, push exp(a)
+    ABS,          // pop a, push |a|
+    RAISE         // throw errorMessages[operand]; would pop `pops` values and push one
+};
+
+// Single bytecode instruction (8 bytes)
+struct Instruction {
+    OpCode op;
+    std::uint16_t pops;       // RAISE only, so a program can carry on past it
+    std::uint32_t operand;
+};
+
+// AST lowered into a flat postfix instruction array. Nodes shared by several
+// parents (see HashConsBuilder) are computed once and reused via temporaries.
+class CompiledExpression {
+public:
+    // Compile an AST into bytecode
+    explicit CompiledExpression(const ASTNodePtr& ast);
+
+    // Compile several expressions into one program that leaves expression i
+    // in output i (STORE_OUTPUT). Nodes shared between expressions, e.g. after
+    // building them all with one HashConsBuilder, are computed once.
+    explicit CompiledExpression(const std::vector<ASTNodePtr>& outputs);
+
+    // Evaluation functions (same results and errors as ASTNode::evaluate)
+    double evaluate(const VariableMap& variables = {}) const;
+    double evaluate(const std::vector<std::pair<std::string, double>>& variables) const;
+
+    // Hot-path evaluation from values in slot order (see getBinding()); no
+    // hashing or allocation, undefined variables are caught at bind time
+    double evaluate(const double* slots) const { return execute(slots, nullptr); }
+    double evaluate(std::span<const double> slots) const;
+
+    // Every output from slot-ordered values; the single-value evaluate
+    // functions above are for single-output programs. Throws on the first
+    // error in program order, leaving later outputs unset.
+    void evaluateAll(std::span<const double> slots, std::span<double> outputs) const;
+
+    // Binding that maps variable names to this expression's slots
+    VariableBinding getBinding() const { return VariableBinding(variables); }
+
+    // Accessors
+    const std::vector<Instruction>& getInstructions() const { return instructions; }
+    const std::vector<double>& getConstants() const { return constants; }
+    const std::vector<std::string>& getVariables() const { return variables; }
+    const std::vector<std::string>& getErrorMessages() const { return errorMessages; }
+    size_t getMaxStackDepth() const { return maxStackDepth; }
+    size_t getTempCount() const { return tempCount; }
+    size_t getOutputCount() const { return outputCount; }
+
+    // Human readable listing of the bytecode
+    std::string disassemble() const;
+
+    // Convert opcode to string
+    static std::string opCodeToString(OpCode op);
+
+private:
+    std::vector<Instruction> instructions;
+    std::vector<double> constants;
+    std::vector<std::string> variables;      // slot order, same as collectVariables()
+    std::vector<std::string> errorMessages;
+    size_t maxStackDepth = 0;
+    size_t tempCount = 0;
+    size_t outputCount = 1;
+    bool storesOutputs = false;   // built from several expressions
+
+    // Shared nodes mapped to their temporary, or NO_TEMP until first compiled
+    static constexpr std::uint32_t NO_TEMP = 0xFFFFFFFFu;
+    using TempMap = std::unordered_map<const ASTNode*, std::uint32_t>;
+
+    void compileNode(const ASTNode* node, size_t& depth, TempMap& temps);
+    void compileOperation(const ASTNode* node, size_t& depth, TempMap& temps);
+    void emit(OpCode op, std::uint32_t operand, size_t& depth, int stackEffect);
+    void emitRaise(const std::string& message, size_t pops, size_t& depth);
+    std::uint32_t addErrorMessage(const std::string& message);
+
+    // Run the bytecode; defined[slot] == 0 marks an undefined variable.
+    // STORE_OUTPUT writes into outputs.
+    double execute(const double* slots, const unsigned char* defined, double* outputs = nullptr) const {
+        return execute<double>(constants.data(), slots, defined, outputs);
+    }
+
+    // The same loop in T, on the constants already converted to T
+    // (instantiated for float, double and long double)
+    template <typename T>
+    T execute(const T* constantValues, const T* slots, const unsigned char* defined, T* outputs) const;
+
+    template <typename T>
+    friend class TypedExpression;
+};
+
+#endif // COMPILED_EXPRESSION_H
\ No newline at end of file
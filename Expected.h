@@ -0,0 +1,82 @@
+#ifndef EXPECTED_H
+#define EXPECTED_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <variant>
+
+class ASTNode;
+
+// Failure kinds for the exception-free APIs (tryEvaluate, tryConvert, tryParse)
+enum class ErrorCode : std::uint8_t {
+    NONE,
+    // Evaluation
+    UNDEFINED_VARIABLE,
+    DIVISION_BY_ZERO,
+    SQRT_OF_NEGATIVE,
+    LOG_OF_NON_POSITIVE,
+    UNKNOWN_FUNCTION,        // unknown name or wrong number of arguments
+    UNKNOWN_OPERATOR,
+    UNKNOWN_NODE_TYPE,
+    // Parsing
+    MISMATCHED_PARENTHESES,
+    INVALID_CHARACTER,
+    UNEXPECTED_END,
+    INVALID_NUMBER,
+    INVALID_TOKEN,
+    MISSING_OPERAND,
+    INVALID_EXPRESSION       // postfix left other than one tree on the stack
+};
+
+// Why ASTNode::tryEvaluate failed. Holds no string, so failing is as cheap as
+// succeeding; message() builds the text ASTNode::evaluate would throw.
+struct EvaluationError {
+    ErrorCode code = ErrorCode::NONE;
+    const ASTNode* node = nullptr;   // the failing node, inside the evaluated tree
+
+    std::string message() const;
+};
+
+// Why a parser failed; message is the text the throwing API uses
+struct ParseError {
+    ErrorCode code = ErrorCode::NONE;
+    std::string message;
+};
+
+// Error side of an Expected, as in `return Unexpected(error);`
+template <typename E>
+struct Unexpected {
+    E error;
+};
+
+template <typename E>
+Unexpected(E) -> Unexpected<E>;
+
+// A value or the error that prevented it (a small std::expected for C++20).
+// Accessing the side that is not held is a programming error.
+template <typename T, typename E>
+class Expected {
+public:
+    Expected(T value) : storage(std::in_place_index<0>, std::move(value)) {}
+    Expected(Unexpected<E> failure) : storage(std::in_place_index<1>, std::move(failure.error)) {}
+
+    bool hasValue() const { return storage.index() == 0; }
+    explicit operator bool() const { return hasValue(); }
+
+    T& value() { return *std::get_if<0>(&storage); }
+    const T& value() const { return *std::get_if<0>(&storage); }
+    T& operator*() { return value(); }
+    const T& operator*() const { return value(); }
+    T* operator->() { return &value(); }
+    const T* operator->() const { return &value(); }
+
+    const E& error() const { return *std::get_if<1>(&storage); }
+
+    T valueOr(T fallback) const { return hasValue() ? value() : std::move(fallback); }
+
+private:
+    std::variant<T, E> storage;
+};
+
+#endif // EXPECTED_H
@@ -0,0 +1,190 @@
+#include "ExpressionArena.h"
+#include <stdexcept>
+#include <cmath>
+#include <algorithm>
+
+ExpressionArena::ExpressionArena(size_t blockSize) : blockSize(std::max<size_t>(blockSize, 256)) {}
+
+// Bump-allocate raw memory, opening a new block when the current one is full
+void* ExpressionArena::allocate(size_t bytes, size_t alignment) {
+    auto current = reinterpret_cast<std::uintptr_t>(cursor);
+    auto aligned = (current + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+
+    if (!cursor || aligned + bytes > reinterpret_cast<std::uintptr_t>(limit)) {
+        size_t size = std::max(blockSize, bytes + alignment);
+        // Left uninitialized, every byte is written before it is read
+        blocks.push_back({std::unique_ptr<std::byte[]>(new std::byte[size]), size});
+        cursor = blocks.back().data.get();
+        limit = cursor + size;
+
+        current = reinterpret_cast<std::uintptr_t>(cursor);
+        aligned = (current + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+    }
+
+    cursor = reinterpret_cast<std::byte*>(aligned + bytes);
+    bytesUsed += bytes;
+    return reinterpret_cast<void*>(aligned);
+}
+
+// Allocate and zero-initialize a node
+ArenaNode* ExpressionArena::newNode(NodeType type) {
+    void* memory = allocate(sizeof(ArenaNode), alignof(ArenaNode));
+    ArenaNode* node = new(memory) ArenaNode{type, OperatorType::NONE, 0, 0, 0.0, nullptr};
+    ++nodeCount;
+    return node;
+}
+
+// Factory function for number node
+const ArenaNode* ExpressionArena::createNumber(double value) {
+    ArenaNode* node = newNode(NodeType::NUMBER);
+    node->value = value;
+    return node;
+}
+
+// Factory function for variable node
+const ArenaNode* ExpressionArena::createVariable(std::string_view name) {
+    ArenaNode* node = newNode(NodeType::VARIABLE);
+    node->symbol = symbols.intern(name);
+    return node;
+}
+
+// Factory function for binary operator node
+const ArenaNode* ExpressionArena::createBinaryOp(OperatorType op, const ArenaNode* left, const ArenaNode* right) {
+    auto children = static_cast<const ArenaNode**>(allocate(2 * sizeof(ArenaNode*), alignof(ArenaNode*)));
+    children[0] = left;
+    children[1] = right;
+
+    ArenaNode* node = newNode(NodeType::BINARY_OP);
+    node->op = op;
+    node->childCount = 2;
+    node->children = children;
+    return node;
+}
+
+// Factory function for unary operator node
+const ArenaNode* ExpressionArena::createUnaryOp(OperatorType op, const ArenaNode* operand) {
+    auto children = static_cast<const ArenaNode**>(allocate(sizeof(ArenaNode*), alignof(ArenaNode*)));
+    children[0] = operand;
+
+    ArenaNode* node = newNode(NodeType::UNARY_OP);
+    node->op = op;
+    node->childCount = 1;
+    node->children = children;
+    return node;
+}
+
+// Factory function for function call node
+const ArenaNode* ExpressionArena::createFunctionCall(std::string_view funcName,
+                                                    std::span<const ArenaNode* const> args) {
+    auto children = static_cast<const ArenaNode**>(
+        allocate(std::max<size_t>(args.size(), 1) * sizeof(ArenaNode*), alignof(ArenaNode*)));
+    std::copy(args.begin(), args.end(), children);
+
+    ArenaNode* node = newNode(NodeType::FUNCTION_CALL);
+    node->symbol = symbols.intern(funcName);
+    node->childCount = static_cast<std::uint32_t>(args.size());
+    node->children = children;
+    return node;
+}
+
+// Invalidate every node at once; nodes are trivially destructible
+void ExpressionArena::reset() {
+    symbols.clear();
+    if (blocks.empty()) return;
+    blocks.resize(1);
+    cursor = blocks[0].data.get();
+    limit = cursor + blocks[0].size;
+    nodeCount = 0;
+    bytesUsed = 0;
+}
+
+// Evaluate an arena node (mirrors ASTNode::evaluate)
+double ArenaNode::evaluate(const SymbolTable& symbols, const VariableMap& variables) const {
+    switch(type) {
+        case NodeType::NUMBER:
+            return value;
+
+        case NodeType::VARIABLE: {
+            std::string_view name = symbols.name(symbol);
+            auto it = variables.find(name);
+            if (it != variables.end()) {
+                return it->second;
+            }
+            throw std::runtime_error("Undefined variable: " + std::string(name));
+        }
+
+        case NodeType::BINARY_OP: {
+            double leftVal = left()->evaluate(symbols, variables);
+            double rightVal = right()->evaluate(symbols, variables);
+
+            switch(op) {
+                case OperatorType::ADD: return leftVal + rightVal;
+                case OperatorType::SUBTRACT: return leftVal - rightVal;
+                case OperatorType::MULTIPLY: return leftVal * rightVal;
+                case OperatorType::DIVIDE:
+                    if (rightVal == 0) throw std::runtime_error("Division by zero");
+                    return leftVal / rightVal;
+                case OperatorType::POWER: return std::pow(leftVal, rightVal);
+                default: throw std::runtime_error("Unknown binary operator");
+            }
+        }
+
+        case NodeType::UNARY_OP: {
+            double val = left()->evaluate(symbols, variables);
+            switch(op) {
+                case OperatorType::NEGATIVE: return -val;
+                default: throw std::runtime_error("Unknown unary operator");
+            }
+        }
+
+        case NodeType::FUNCTION_CALL: {
+            double arg = 0;
+            for (std::uint32_t i = 0; i < childCount; ++i) {
+                arg = children[i]->evaluate(symbols, variables);
+            }
+
+            std::string_view name = symbols.name(symbol);
+            if (childCount == 1) {
+                if (name == "sin") return std::sin(arg);
+                if (name == "cos") return std::cos(arg);
+                if (name == "sqrt") {
+                    if (arg < 0) throw std::runtime_error("Square root of negative number");
+                    return std::sqrt(arg);
+                }
+                if (name == "log") {
+                    if (arg <= 0) throw std::runtime_error("Log of non-positive number");
+                    return std::log(arg);
+                }
+                if (name == "exp") return std::exp(arg);
+                if (name == "abs") return std::abs(arg);
+            }
+            throw std::runtime_error("Unknown function or wrong number of arguments: " + std::string(name));
+        }
+
+        default:
+            throw std::runtime_error("Unknown node type");
+    }
+}
+
+// Convert to a regular shared_ptr tree
+ASTNodePtr ArenaNode::toAST(const SymbolTable& symbols) const {
+    switch(type) {
+        case NodeType::NUMBER:
+            return ASTNode::createNumber(value);
+        case NodeType::VARIABLE:
+            return ASTNode::createVariable(std::string(symbols.name(symbol)));
+        case NodeType::BINARY_OP:
+            return ASTNode::createBinaryOp(op, left()->toAST(symbols), right()->toAST(symbols));
+        case NodeType::UNARY_OP:
+            return ASTNode::createUnaryOp(op, left()->toAST(symbols));
+        case NodeType::FUNCTION_CALL: {
+            std::vector<ASTNodePtr> args;
+            for (std::uint32_t i = 0; i < childCount; ++i) {
+                args.push_back(children[i]->toAST(symbols));
+            }
+            return ASTNode::createFunctionCall(std::string(symbols.name(symbol)), args);
+        }
+        default:
+            throw std::runtime_error("Unknown node type");
+    }
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#ifndef EXPRESSION_ARENA_H
+#define EXPRESSION_ARENA_H
+
+#include "AST_NODE.h"
+#include "SymbolTable.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Plain AST node living inside an ExpressionArena. Nodes are trivially
+// destructible and reference their children by raw pointer, so the arena can
+// drop a whole expression without visiting it. Names are symbol ids in the
+// arena's SymbolTable.
+struct ArenaNode {
+    NodeType type;
+    OperatorType op;                    // BINARY_OP / UNARY_OP
+    std::uint32_t childCount;           // 2 for BINARY_OP, 1 for UNARY_OP, arguments for FUNCTION_CALL
+    std::uint32_t symbol;               // VARIABLE / FUNCTION_CALL name id
+    double value;                       // NUMBER
+    const ArenaNode* const* children;   // childCount entries, owned by the arena
+
+    const ArenaNode* left() const { return children[0]; }
+    const ArenaNode* right() const { return children[1]; }
+
+    // Same results and errors as ASTNode::evaluate
+    double evaluate(const SymbolTable& symbols, const VariableMap& variables = {}) const;
+
+    // Convert to a regular shared_ptr tree
+    ASTNodePtr toAST(const SymbolTable& symbols) const;
+};
+
+// Bump-pointer allocator owning all nodes of one or more expressions
+class ExpressionArena {
+public:
+    explicit ExpressionArena(size_t blockSize = 64 * 1024);
+
+    // Arena owns raw memory, so it is movable but not copyable
+    ExpressionArena(const ExpressionArena&) = delete;
+    ExpressionArena& operator=(const ExpressionArena&) = delete;
+    ExpressionArena(ExpressionArena&&) = default;
+    ExpressionArena& operator=(ExpressionArena&&) = default;
+
+    // Node factories (mirror ASTNode::create*)
+    const ArenaNode* createNumber(double value);
+    const ArenaNode* createVariable(std::string_view name);
+    const ArenaNode* createBinaryOp(OperatorType op, const ArenaNode* left, const ArenaNode* right);
+    const ArenaNode* createUnaryOp(OperatorType op, const ArenaNode* operand);
+    const ArenaNode* createFunctionCall(std::string_view funcName, std::span<const ArenaNode* const> args);
+
+    // Invalidate every node and interned symbol at once, keeping the first
+    // block, so a parse-and-reset loop runs in bounded memory
+    void reset();
+
+    // Names of variables and functions used by the nodes
+    const SymbolTable& getSymbols() const { return symbols; }
+
+    // Statistics
+    size_t getNodeCount() const { return nodeCount; }
+    size_t getBytesUsed() const { return bytesUsed; }
+    size_t getBlockCount() const { return blocks.size(); }
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+
+    size_t blockSize;
+    std::vector<Block> blocks;
+    SymbolTable symbols;
+    std::byte* cursor = nullptr;
+    std::byte* limit = nullptr;
+    size_t nodeCount = 0;
+    size_t bytesUsed = 0;
+
+    void* allocate(size_t bytes, size_t alignment);
+    ArenaNode* newNode(NodeType type);
+};
+
+#endif // EXPRESSION_ARENA_H
\ No newline at end of file
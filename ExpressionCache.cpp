@@ -0,0 +1,151 @@
+#include "ExpressionCache.h"
+#include "InfixParser.h"
+#include "PostfixToAST.h"
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+
+ExpressionCache::ExpressionCache(size_t capacity, size_t shardCount) : capacity(capacity) {
+    if (capacity == 0 || shardCount == 0) {
+        throw std::runtime_error("Expression cache needs a non-zero capacity and shard count");
+    }
+    shardCount = std::min(shardCount, capacity);
+
+    // Spread the capacity over the shards; the first ones take the remainder
+    shards.reserve(shardCount);
+    for (size_t i = 0; i < shardCount; ++i) {
+        auto shard = std::make_unique<Shard>();
+        shard->slots = std::vector<Slot>(capacity / shardCount + (i < capacity % shardCount ? 1 : 0));
+        shard->index.reserve(shard->slots.size());
+        shards.push_back(std::move(shard));
+    }
+}
+
+// Remove whitespace that does not separate two tokens
+std::string ExpressionCache::normalize(std::string_view text, ExpressionSyntax syntax) {
+    auto isSpace = [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; };
+    auto isWord = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '.' || c == '_'; };
+
+    std::string key = syntax == ExpressionSyntax::INFIX ? "i:" : "p:";
+    key.reserve(text.size() + 2);
+    bool pendingSpace = false;
+    for (char c : text) {
+        if (isSpace(c)) {
+            pendingSpace = true;
+            continue;
+        }
+        // Postfix tokens are always space-separated; infix only needs a space between two words
+        if (pendingSpace && key.size() > 2 &&
+            (syntax == ExpressionSyntax::POSTFIX || (isWord(key.back()) && isWord(c)))) {
+            key += ' ';
+        }
+        pendingSpace = false;
+        key += c;
+    }
+    return key;
+}
+
+ExpressionCache::Shard& ExpressionCache::shardFor(const std::string& key) const {
+    return *shards[std::hash<std::string>()(key) % shards.size()];
+}
+
+// Parse and compile outside any lock
+CachedExpressionPtr ExpressionCache::parse(std::string key, std::string_view text, ExpressionSyntax syntax) {
+    ASTNodePtr ast = syntax == ExpressionSyntax::INFIX ? InfixParser::parse(text)
+                                                       : PostfixToAST::convert(std::string(text));
+    return std::make_shared<const CachedExpression>(std::move(key), std::move(ast));
+}
+
+// Advance the CLOCK hand past referenced slots, clearing their bit
+size_t ExpressionCache::chooseVictim(Shard& shard) {
+    while (true) {
+        size_t slot = shard.hand;
+        shard.hand = (shard.hand + 1) % shard.slots.size();
+        if (!shard.slots[slot].referenced.exchange(false, std::memory_order_relaxed)) {
+            return slot;
+        }
+    }
+}
+
+CachedExpressionPtr ExpressionCache::find(std::string_view text, ExpressionSyntax syntax) const {
+    std::string key = normalize(text, syntax);
+    Shard& shard = shardFor(key);
+
+    std::shared_lock lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) return nullptr;
+    return shard.slots[it->second].value;
+}
+
+CachedExpressionPtr ExpressionCache::get(std::string_view text, ExpressionSyntax syntax) {
+    std::string key = normalize(text, syntax);
+    Shard& shard = shardFor(key);
+
+    // Hit: shared lock, mark the slot as recently used
+    {
+        std::shared_lock lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            Slot& slot = shard.slots[it->second];
+            slot.referenced.store(true, std::memory_order_relaxed);
+            shard.hits.fetch_add(1, std::memory_order_relaxed);
+            return slot.value;
+        }
+    }
+
+    // Miss: parse without holding the lock (throws on invalid text)
+    shard.misses.fetch_add(1, std::memory_order_relaxed);
+    CachedExpressionPtr parsed = parse(key, std::string_view(key).substr(2), syntax);
+
+    std::unique_lock lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        // Another thread inserted it meanwhile
+        return shard.slots[it->second].value;
+    }
+
+    // Slots fill in order; once full, entries only leave through eviction,
+    // which hands its slot to the new entry
+    size_t slotIndex;
+    if (shard.index.size() < shard.slots.size()) {
+        slotIndex = shard.index.size();
+    } else {
+        slotIndex = chooseVictim(shard);
+        shard.index.erase(shard.slots[slotIndex].value->key);
+        shard.evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Slot& slot = shard.slots[slotIndex];
+    slot.value = parsed;
+    slot.referenced.store(true, std::memory_order_relaxed);
+    shard.index.emplace(std::move(key), slotIndex);
+    return parsed;
+}
+
+ExpressionCache::Stats ExpressionCache::getStats() const {
+    Stats stats;
+    stats.capacity = capacity;
+    for (const auto& shard : shards) {
+        std::shared_lock lock(shard->mutex);
+        stats.hits += shard->hits.load(std::memory_order_relaxed);
+        stats.misses += shard->misses.load(std::memory_order_relaxed);
+        stats.evictions += shard->evictions.load(std::memory_order_relaxed);
+        stats.size += shard->index.size();
+    }
+    return stats;
+}
+
+// Drop every entry; expressions already handed out stay valid
+void ExpressionCache::clear() {
+    for (auto& shard : shards) {
+        std::unique_lock lock(shard->mutex);
+        shard->index.clear();
+        for (auto& slot : shard->slots) {
+            slot.value.reset();
+            slot.referenced.store(false, std::memory_order_relaxed);
+        }
+        shard->hand = 0;
+    }
+}
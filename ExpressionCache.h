@@ -0,0 +1,91 @@
+#ifndef EXPRESSION_CACHE_H
+#define EXPRESSION_CACHE_H
+
+#include "AST_NODE.h"
+#include "CompiledExpression.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Notation of a cached expression's text
+enum class ExpressionSyntax {
+    INFIX,
+    POSTFIX
+};
+
+// Parsed and compiled expression; never modified once cached, so it can be
+// evaluated from any number of threads
+struct CachedExpression {
+    CachedExpression(std::string key, ASTNodePtr ast)
+        : key(std::move(key)), ast(std::move(ast)), compiled(this->ast) {}
+
+    std::string key;               // normalized text
+    ASTNodePtr ast;
+    CompiledExpression compiled;
+};
+
+using CachedExpressionPtr = std::shared_ptr<const CachedExpression>;
+
+// Thread-safe, bounded map from expression text to CachedExpression.
+// Keys are split over shards, each with its own reader/writer lock: hits take
+// a shared lock only, misses parse outside the lock. Each shard evicts with
+// the CLOCK policy (a referenced bit per slot, cleared by a rotating hand).
+class ExpressionCache {
+public:
+    struct Stats {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t evictions = 0;
+        size_t size = 0;
+        size_t capacity = 0;
+    };
+
+    explicit ExpressionCache(size_t capacity = 4096, size_t shardCount = 16);
+
+    ExpressionCache(const ExpressionCache&) = delete;
+    ExpressionCache& operator=(const ExpressionCache&) = delete;
+
+    // Cached expression for text, parsing and compiling it on a miss.
+    // Parse errors are thrown and not cached.
+    CachedExpressionPtr get(std::string_view text, ExpressionSyntax syntax = ExpressionSyntax::INFIX);
+
+    // Cached expression or nullptr; does not parse or count
+    CachedExpressionPtr find(std::string_view text, ExpressionSyntax syntax = ExpressionSyntax::INFIX) const;
+
+    Stats getStats() const;
+    void clear();
+
+    // Cache key: syntax tag plus text with redundant whitespace removed
+    // ("a+ b *c" and "a + b * c" share an entry; "x y" stays two tokens)
+    static std::string normalize(std::string_view text, ExpressionSyntax syntax);
+
+private:
+    struct Slot {
+        CachedExpressionPtr value;                  // nullptr when free
+        std::atomic<bool> referenced{false};
+    };
+
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, size_t> index;   // key -> slot
+        std::vector<Slot> slots;
+        size_t hand = 0;                                  // CLOCK position
+        std::atomic<std::uint64_t> hits{0};
+        std::atomic<std::uint64_t> misses{0};
+        std::atomic<std::uint64_t> evictions{0};
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    size_t capacity;
+
+    Shard& shardFor(const std::string& key) const;
+    static CachedExpressionPtr parse(std::string key, std::string_view text, ExpressionSyntax syntax);
+    static size_t chooseVictim(Shard& shard);
+};
+
+#endif // EXPRESSION_CACHE_H
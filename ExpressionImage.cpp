@@ -0,0 +1,533 @@
+#include "ExpressionImage.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define EXPRESSION_IMAGE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static constexpr char IMAGE_MAGIC[8] = {'E', 'X', 'P', 'R', 'I', 'M', 'G', '1'};
+
+// The image is used in place, so host and file byte order must agree
+static void requireLittleEndian() {
+    if constexpr (std::endian::native != std::endian::little) {
+        throw std::runtime_error("Expression images need a little-endian host");
+    }
+}
+
+static size_t alignTo8(size_t offset) {
+    return (offset + 7) & ~static_cast<size_t>(7);
+}
+
+static ImageFunction resolveFunction(const std::string& name, size_t argumentCount) {
+    if (argumentCount != 1) return ImageFunction::UNKNOWN;
+    if (name == "sin") return ImageFunction::SIN;
+    if (name == "cos") return ImageFunction::COS;
+    if (name == "sqrt") return ImageFunction::SQRT;
+    if (name == "log") return ImageFunction::LOG;
+    if (name == "exp") return ImageFunction::EXP;
+    if (name == "abs") return ImageFunction::ABS;
+    return ImageFunction::UNKNOWN;
+}
+
+std::uint32_t ExpressionImageWriter::addSymbol(const std::string& text) {
+    auto [it, inserted] = symbolIndex.try_emplace(text, static_cast<std::uint32_t>(symbols.size()));
+    if (inserted) symbols.push_back(text);
+    return it->second;
+}
+
+std::uint32_t ExpressionImageWriter::addConstant(double value) {
+    auto [it, inserted] =
+        constantIndex.try_emplace(std::bit_cast<std::uint64_t>(value), static_cast<std::uint32_t>(constants.size()));
+    if (inserted) constants.push_back(value);
+    return it->second;
+}
+
+size_t ExpressionImageWriter::add(const ASTNodePtr& ast, const std::string& name) {
+    if (!ast) {
+        throw std::runtime_error("Cannot add an empty AST to an expression image");
+    }
+
+    ImageExpression entry{};
+    entry.firstNode = static_cast<std::uint32_t>(nodes.size());
+    entry.firstSlot = static_cast<std::uint32_t>(slots.size());
+    entry.name = addSymbol(name);
+
+    std::vector<std::string> variables = ast->collectVariables();
+    for (const auto& variable : variables) slots.push_back(addSymbol(variable));
+    entry.slotCount = static_cast<std::uint32_t>(variables.size());
+
+    size_t depth = 0, maxDepth = 0;
+    appendNode(ast.get(), variables, depth, maxDepth);
+    if (nodes.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error("Expression image is limited to 2^32 nodes");
+    }
+    entry.nodeCount = static_cast<std::uint32_t>(nodes.size() - entry.firstNode);
+    entry.maxStackDepth = static_cast<std::uint32_t>(maxDepth);
+
+    expressions.push_back(entry);
+    return expressions.size() - 1;
+}
+
+// Append a subtree in postorder, tracking the evaluation stack depth
+void ExpressionImageWriter::appendNode(const ASTNode* node, const std::vector<std::string>& variables,
+                                       size_t& depth, size_t& maxDepth) {
+    ImageNode packed{};
+    packed.kind = static_cast<std::uint8_t>(node->type);
+    packed.op = static_cast<std::uint8_t>(OperatorType::NONE);
+
+    switch(node->type) {
+        case NodeType::NUMBER:
+            packed.operand = addConstant(node->number.value);
+            break;
+
+        case NodeType::VARIABLE: {
+            auto it = std::lower_bound(variables.begin(), variables.end(), node->variable.name);
+            packed.operand = static_cast<std::uint32_t>(it - variables.begin());
+            break;
+        }
+
+        case NodeType::BINARY_OP:
+            appendNode(node->op.left.get(), variables, depth, maxDepth);
+            appendNode(node->op.right.get(), variables, depth, maxDepth);
+            packed.op = static_cast<std::uint8_t>(node->op.op);
+            packed.childCount = 2;
+            break;
+
+        case NodeType::UNARY_OP:
+            appendNode(node->op.left.get(), variables, depth, maxDepth);
+            packed.op = static_cast<std::uint8_t>(node->op.op);
+            packed.childCount = 1;
+            break;
+
+        case NodeType::FUNCTION_CALL: {
+            const auto& arguments = node->function.arguments;
+            if (arguments.size() > std::numeric_limits<std::uint16_t>::max()) {
+                throw std::runtime_error("Too many arguments for an expression image: " +
+                                         node->function.functionName);
+            }
+            for (const auto& argument : arguments) appendNode(argument.get(), variables, depth, maxDepth);
+            packed.op = static_cast<std::uint8_t>(resolveFunction(node->function.functionName, arguments.size()));
+            packed.childCount = static_cast<std::uint16_t>(arguments.size());
+            packed.operand = addSymbol(node->function.functionName);
+            break;
+        }
+    }
+
+    depth = depth - packed.childCount + 1;
+    maxDepth = std::max(maxDepth, depth);
+    nodes.push_back(packed);
+}
+
+std::vector<std::byte> ExpressionImageWriter::serialize() const {
+    requireLittleEndian();
+
+    std::vector<std::uint32_t> symbolOffsets{0};
+    for (const auto& symbol : symbols) {
+        size_t end = symbolOffsets.back() + symbol.size();
+        if (end > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::runtime_error("Expression image symbol table is limited to 4 GiB");
+        }
+        symbolOffsets.push_back(static_cast<std::uint32_t>(end));
+    }
+
+    std::vector<std::uint32_t> nameIndex(expressions.size());
+    for (size_t i = 0; i < nameIndex.size(); ++i) nameIndex[i] = static_cast<std::uint32_t>(i);
+    std::stable_sort(nameIndex.begin(), nameIndex.end(), [this](std::uint32_t a, std::uint32_t b) {
+        return symbols[expressions[a].name] < symbols[expressions[b].name];
+    });
+
+    ImageHeader header{};
+    std::memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+    header.version = ExpressionImage::FORMAT_VERSION;
+    header.expressionCount = static_cast<std::uint32_t>(expressions.size());
+    header.symbolCount = static_cast<std::uint32_t>(symbols.size());
+    header.constantCount = static_cast<std::uint32_t>(constants.size());
+    header.nodeCount = static_cast<std::uint32_t>(nodes.size());
+    header.slotCount = static_cast<std::uint32_t>(slots.size());
+
+    size_t offset = sizeof(ImageHeader);
+    auto place = [&offset](size_t bytes) {
+        size_t start = alignTo8(offset);
+        offset = start + bytes;
+        return static_cast<std::uint64_t>(start);
+    };
+    header.symbolOffsets = place(symbolOffsets.size() * sizeof(std::uint32_t));
+    header.symbolBytes = place(symbolOffsets.back());
+    header.constants = place(constants.size() * sizeof(double));
+    header.nodes = place(nodes.size() * sizeof(ImageNode));
+    header.slots = place(slots.size() * sizeof(std::uint32_t));
+    header.expressions = place(expressions.size() * sizeof(ImageExpression));
+    header.nameIndex = place(nameIndex.size() * sizeof(std::uint32_t));
+    header.fileSize = alignTo8(offset);
+
+    std::vector<std::byte> image(header.fileSize);
+    auto copy = [&image](std::uint64_t at, const void* source, size_t bytes) {
+        if (bytes) std::memcpy(image.data() + at, source, bytes);
+    };
+    copy(0, &header, sizeof(header));
+    copy(header.symbolOffsets, symbolOffsets.data(), symbolOffsets.size() * sizeof(std::uint32_t));
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        copy(header.symbolBytes + symbolOffsets[i], symbols[i].data(), symbols[i].size());
+    }
+    copy(header.constants, constants.data(), constants.size() * sizeof(double));
+    copy(header.nodes, nodes.data(), nodes.size() * sizeof(ImageNode));
+    copy(header.slots, slots.data(), slots.size() * sizeof(std::uint32_t));
+    copy(header.expressions, expressions.data(), expressions.size() * sizeof(ImageExpression));
+    copy(header.nameIndex, nameIndex.data(), nameIndex.size() * sizeof(std::uint32_t));
+    return image;
+}
+
+void ExpressionImageWriter::save(const std::string& path) const {
+    std::vector<std::byte> image = serialize();
+    std::ofstream out(path, std::ios::binary);
+    if (!out) throw std::runtime_error("Cannot create " + path);
+    out.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+    if (!out) throw std::runtime_error("Write failed: " + path);
+}
+
+ExpressionImage ExpressionImage::open(const std::string& path) {
+    ExpressionImage image;
+#ifdef EXPRESSION_IMAGE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open " + path);
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("Not an expression image: " + path);
+    }
+    auto size = static_cast<size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) throw std::runtime_error("Cannot map " + path);
+    image.mapping = mapping;
+    image.data = std::span<const std::byte>(static_cast<const std::byte*>(mapping), size);
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Cannot open " + path);
+    in.seekg(0, std::ios::end);
+    image.owned.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(image.owned.data()), static_cast<std::streamsize>(image.owned.size()));
+    if (!in) throw std::runtime_error("Cannot read " + path);
+    image.data = image.owned;
+#endif
+    image.attach(image.data);
+    return image;
+}
+
+ExpressionImage ExpressionImage::view(std::span<const std::byte> bytes) {
+    ExpressionImage image;
+    image.attach(bytes);
+    return image;
+}
+
+// Point the section pointers into the bytes after checking they fit
+void ExpressionImage::attach(std::span<const std::byte> bytes) {
+    requireLittleEndian();
+    data = bytes;
+    if (bytes.size() < sizeof(ImageHeader) || std::memcmp(bytes.data(), IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0) {
+        throw std::runtime_error("Not an expression image");
+    }
+    if (reinterpret_cast<std::uintptr_t>(bytes.data()) % 8 != 0) {
+        throw std::runtime_error("Expression image must be 8-byte aligned");
+    }
+
+    header = reinterpret_cast<const ImageHeader*>(bytes.data());
+    if (header->version != FORMAT_VERSION) {
+        throw std::runtime_error("Unsupported expression image version " + std::to_string(header->version));
+    }
+    if (header->fileSize != bytes.size()) {
+        throw std::runtime_error("Truncated expression image");
+    }
+
+    auto section = [&](std::uint64_t offset, std::uint64_t count, size_t elementSize) {
+        if (offset % 8 != 0 || offset > bytes.size() || count > (bytes.size() - offset) / elementSize) {
+            throw std::runtime_error("Corrupt expression image: section out of bounds");
+        }
+        return bytes.data() + offset;
+    };
+    symbolOffsets = reinterpret_cast<const std::uint32_t*>(
+        section(header->symbolOffsets, std::uint64_t(header->symbolCount) + 1, sizeof(std::uint32_t)));
+    symbolBytes = reinterpret_cast<const char*>(section(header->symbolBytes, symbolOffsets[header->symbolCount], 1));
+    constants = reinterpret_cast<const double*>(section(header->constants, header->constantCount, sizeof(double)));
+    nodes = reinterpret_cast<const ImageNode*>(section(header->nodes, header->nodeCount, sizeof(ImageNode)));
+    slots = reinterpret_cast<const std::uint32_t*>(section(header->slots, header->slotCount, sizeof(std::uint32_t)));
+    expressions = reinterpret_cast<const ImageExpression*>(
+        section(header->expressions, header->expressionCount, sizeof(ImageExpression)));
+    nameIndex = reinterpret_cast<const std::uint32_t*>(
+        section(header->nameIndex, header->expressionCount, sizeof(std::uint32_t)));
+}
+
+void ExpressionImage::release() {
+#ifdef EXPRESSION_IMAGE_MMAP
+    if (mapping) ::munmap(mapping, data.size());
+#endif
+    mapping = nullptr;
+}
+
+ExpressionImage::ExpressionImage(ExpressionImage&& other) noexcept {
+    *this = std::move(other);
+}
+
+ExpressionImage& ExpressionImage::operator=(ExpressionImage&& other) noexcept {
+    if (this != &other) {
+        release();
+        // Moving the vector keeps its buffer, so the section pointers stay valid
+        data = other.data;
+        mapping = std::exchange(other.mapping, nullptr);
+        owned = std::move(other.owned);
+        header = other.header;
+        symbolOffsets = other.symbolOffsets;
+        symbolBytes = other.symbolBytes;
+        constants = other.constants;
+        nodes = other.nodes;
+        slots = other.slots;
+        expressions = other.expressions;
+        nameIndex = other.nameIndex;
+    }
+    return *this;
+}
+
+ExpressionImage::~ExpressionImage() {
+    release();
+}
+
+std::string_view ExpressionImage::symbol(std::uint32_t index) const {
+    return std::string_view(symbolBytes + symbolOffsets[index], symbolOffsets[index + 1] - symbolOffsets[index]);
+}
+
+MappedExpression ExpressionImage::operator[](size_t index) const {
+    if (index >= size()) {
+        throw std::out_of_range("Expression index " + std::to_string(index) + " out of range");
+    }
+    return MappedExpression(this, &expressions[index]);
+}
+
+size_t ExpressionImage::find(std::string_view name) const {
+    const std::uint32_t* end = nameIndex + size();
+    const std::uint32_t* it = std::lower_bound(nameIndex, end, name, [this](std::uint32_t index, std::string_view key) {
+        return symbol(expressions[index].name) < key;
+    });
+    if (it == end || symbol(expressions[*it].name) != name) return NOT_FOUND;
+    return *it;
+}
+
+void ExpressionImage::verify() const {
+    auto fail = [](const std::string& what) {
+        throw std::runtime_error("Corrupt expression image: " + what);
+    };
+
+    for (std::uint32_t i = 0; i < header->symbolCount; ++i) {
+        if (symbolOffsets[i] > symbolOffsets[i + 1]) fail("symbol " + std::to_string(i));
+    }
+    for (std::uint32_t i = 0; i < header->slotCount; ++i) {
+        if (slots[i] >= header->symbolCount) fail("slot " + std::to_string(i));
+    }
+    // find() binary-searches the name index, so it must list every expression
+    // once, sorted by name
+    std::vector<bool> listed(header->expressionCount);
+    for (std::uint32_t i = 0; i < header->expressionCount; ++i) {
+        std::uint32_t index = nameIndex[i];
+        if (index >= header->expressionCount || listed[index] || expressions[index].name >= header->symbolCount) {
+            fail("name index " + std::to_string(i));
+        }
+        listed[index] = true;
+        if (i > 0 && symbol(expressions[index].name) < symbol(expressions[nameIndex[i - 1]].name)) {
+            fail("name index " + std::to_string(i) + " out of order");
+        }
+    }
+
+    for (std::uint32_t e = 0; e < header->expressionCount; ++e) {
+        const ImageExpression& entry = expressions[e];
+        std::string where = "expression " + std::to_string(e);
+        if (entry.name >= header->symbolCount || entry.nodeCount == 0 ||
+            entry.firstNode > header->nodeCount || entry.nodeCount > header->nodeCount - entry.firstNode ||
+            entry.firstSlot > header->slotCount || entry.slotCount > header->slotCount - entry.firstSlot) {
+            fail(where);
+        }
+
+        // Replay the stack depth; every node needs its operands on the stack and
+        // every operand must be in range
+        size_t depth = 0;
+        for (std::uint32_t i = entry.firstNode; i < entry.firstNode + entry.nodeCount; ++i) {
+            const ImageNode& node = nodes[i];
+            bool valid = false;
+            switch(static_cast<NodeType>(node.kind)) {
+                case NodeType::NUMBER: valid = node.childCount == 0 && node.operand < header->constantCount; break;
+                case NodeType::VARIABLE: valid = node.childCount == 0 && node.operand < entry.slotCount; break;
+                case NodeType::BINARY_OP: valid = node.childCount == 2; break;
+                case NodeType::UNARY_OP: valid = node.childCount == 1; break;
+                case NodeType::FUNCTION_CALL:
+                    // execute() applies resolved functions to the top value in place;
+                    // UNKNOWN only throws, with any argument count
+                    valid = node.operand < header->symbolCount &&
+                            (node.op == static_cast<std::uint8_t>(ImageFunction::UNKNOWN) ||
+                             (node.op < static_cast<std::uint8_t>(ImageFunction::UNKNOWN) && node.childCount == 1));
+                    break;
+            }
+            if (!valid) fail(where + ", node " + std::to_string(i - entry.firstNode));
+            if (depth < node.childCount) {
+                fail(where + ", node " + std::to_string(i - entry.firstNode) + ": missing operands");
+            }
+            depth = depth - node.childCount + 1;
+            if (depth > entry.maxStackDepth) fail(where + ": stack depth");
+        }
+        if (depth != 1) fail(where + ": unbalanced nodes");
+    }
+}
+
+std::string_view MappedExpression::getName() const {
+    return image->symbol(entry->name);
+}
+
+std::string_view MappedExpression::getVariable(size_t slot) const {
+    return image->symbol(image->slots[entry->firstSlot + slot]);
+}
+
+double MappedExpression::evaluate(const VariableMap& variables) const {
+    std::vector<double> values(entry->slotCount);
+    std::vector<unsigned char> defined(entry->slotCount);
+    for (size_t slot = 0; slot < values.size(); ++slot) {
+        auto it = variables.find(std::string(getVariable(slot)));
+        if (it != variables.end()) {
+            values[slot] = it->second;
+            defined[slot] = 1;
+        }
+    }
+    return execute(values.data(), defined.data());
+}
+
+double MappedExpression::evaluate(std::span<const double> slots) const {
+    if (slots.size() != entry->slotCount) {
+        throw std::runtime_error("Expected " + std::to_string(entry->slotCount) + " variable values but got " +
+                                 std::to_string(slots.size()));
+    }
+    return execute(slots.data(), nullptr);
+}
+
+// Postorder scan over the mapped nodes (same results and errors as ASTNode::evaluate)
+double MappedExpression::execute(const double* values, const unsigned char* defined) const {
+    constexpr size_t INLINE_STACK = 64;
+    double inlineStack[INLINE_STACK];
+    std::vector<double> heapStack;
+    double* stack = inlineStack;
+    if (entry->maxStackDepth > INLINE_STACK) {
+        heapStack.resize(entry->maxStackDepth);
+        stack = heapStack.data();
+    }
+
+    size_t top = 0;    // number of values on the stack
+    const ImageNode* node = image->nodes + entry->firstNode;
+    const ImageNode* end = node + entry->nodeCount;
+    for (; node != end; ++node) {
+        switch(static_cast<NodeType>(node->kind)) {
+            case NodeType::NUMBER:
+                stack[top++] = image->constants[node->operand];
+                break;
+
+            case NodeType::VARIABLE:
+                if (defined && !defined[node->operand]) {
+                    throw std::runtime_error("Undefined variable: " + std::string(getVariable(node->operand)));
+                }
+                stack[top++] = values[node->operand];
+                break;
+
+            case NodeType::BINARY_OP: {
+                double rightVal = stack[--top];
+                double& leftVal = stack[top - 1];
+                switch(static_cast<OperatorType>(node->op)) {
+                    case OperatorType::ADD: leftVal = leftVal + rightVal; break;
+                    case OperatorType::SUBTRACT: leftVal = leftVal - rightVal; break;
+                    case OperatorType::MULTIPLY: leftVal = leftVal * rightVal; break;
+                    case OperatorType::DIVIDE:
+                        if (rightVal == 0) throw std::runtime_error("Division by zero");
+                        leftVal = leftVal / rightVal;
+                        break;
+                    case OperatorType::POWER: leftVal = std::pow(leftVal, rightVal); break;
+                    default: throw std::runtime_error("Unknown binary operator");
+                }
+                break;
+            }
+
+            case NodeType::UNARY_OP:
+                if (static_cast<OperatorType>(node->op) != OperatorType::NEGATIVE) {
+                    throw std::runtime_error("Unknown unary operator");
+                }
+                stack[top - 1] = -stack[top - 1];
+                break;
+
+            case NodeType::FUNCTION_CALL: {
+                // Only single-argument built-ins are resolved by the writer
+                auto function = static_cast<ImageFunction>(node->op);
+                if (function >= ImageFunction::UNKNOWN) {
+                    throw std::runtime_error("Unknown function or wrong number of arguments: " +
+                                             std::string(image->symbol(node->operand)));
+                }
+                double& arg = stack[top - 1];
+                switch(function) {
+                    case ImageFunction::SIN: arg = std::sin(arg); break;
+                    case ImageFunction::COS: arg = std::cos(arg); break;
+                    case ImageFunction::SQRT:
+                        if (arg < 0) throw std::runtime_error("Square root of negative number");
+                        arg = std::sqrt(arg);
+                        break;
+                    case ImageFunction::LOG:
+                        if (arg <= 0) throw std::runtime_error("Log of non-positive number");
+                        arg = std::log(arg);
+                        break;
+                    case ImageFunction::EXP: arg = std::exp(arg); break;
+                    case ImageFunction::ABS: arg = std::abs(arg); break;
+                    case ImageFunction::UNKNOWN: break;
+                }
+                break;
+            }
+        }
+    }
+    return stack[0];
+}
+
+// Rebuild a shared_ptr tree from the mapped nodes
+ASTNodePtr MappedExpression::toAST() const {
+    std::vector<ASTNodePtr> stack;
+    stack.reserve(entry->maxStackDepth);
+
+    const ImageNode* node = image->nodes + entry->firstNode;
+    const ImageNode* end = node + entry->nodeCount;
+    for (; node != end; ++node) {
+        auto op = static_cast<OperatorType>(node->op);
+        switch(static_cast<NodeType>(node->kind)) {
+            case NodeType::NUMBER:
+                stack.push_back(ASTNode::createNumber(image->constants[node->operand]));
+                break;
+            case NodeType::VARIABLE:
+                stack.push_back(ASTNode::createVariable(std::string(getVariable(node->operand))));
+                break;
+            case NodeType::BINARY_OP: {
+                ASTNodePtr right = stack.back();
+                stack.pop_back();
+                stack.back() = ASTNode::createBinaryOp(op, stack.back(), right);
+                break;
+            }
+            case NodeType::UNARY_OP:
+                stack.back() = ASTNode::createUnaryOp(op, stack.back());
+                break;
+            case NodeType::FUNCTION_CALL: {
+                std::vector<ASTNodePtr> args(stack.end() - node->childCount, stack.end());
+                stack.resize(stack.size() - node->childCount);
+                stack.push_back(ASTNode::createFunctionCall(std::string(image->symbol(node->operand)), args));
+                break;
+            }
+        }
+    }
+    return stack.back();
+}
@@ -0,0 +1,171 @@
+#ifndef EXPRESSION_IMAGE_H
+#define EXPRESSION_IMAGE_H
+
+#include "AST_NODE.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// On-disk image of many parsed expressions, evaluated straight from the file
+// bytes (normally an mmap'd file) with no deserialization step. All integers
+// and doubles are little-endian; every section starts 8-byte aligned.
+//
+//   ImageHeader
+//   symbol offsets   uint32[symbolCount + 1] into the symbol bytes
+//   symbol bytes     variable, function and expression names, not terminated
+//   constants        double[constantCount]
+//   nodes            ImageNode[nodeCount], each expression in postorder
+//   slots            uint32[slotCount]: symbol of each expression variable
+//   expressions      ImageExpression[expressionCount]
+//   name index       uint32[expressionCount]: expressions sorted by name
+struct ImageHeader {
+    char magic[8];                  // "EXPRIMG1"
+    std::uint32_t version;
+    std::uint32_t expressionCount;
+    std::uint32_t symbolCount;
+    std::uint32_t constantCount;
+    std::uint32_t nodeCount;
+    std::uint32_t slotCount;
+    std::uint64_t symbolOffsets;    // section offsets from the start of the file
+    std::uint64_t symbolBytes;
+    std::uint64_t constants;
+    std::uint64_t nodes;
+    std::uint64_t slots;
+    std::uint64_t expressions;
+    std::uint64_t nameIndex;
+    std::uint64_t fileSize;
+};
+
+struct ImageNode {
+    std::uint8_t kind;              // NodeType
+    std::uint8_t op;                // OperatorType, or ImageFunction for FUNCTION_CALL
+    std::uint16_t childCount;
+    std::uint32_t operand;          // constant index, variable slot or function name symbol
+};
+
+struct ImageExpression {
+    std::uint32_t firstNode;
+    std::uint32_t nodeCount;
+    std::uint32_t firstSlot;
+    std::uint32_t slotCount;        // variables, in collectVariables() order
+    std::uint32_t name;             // symbol index
+    std::uint32_t maxStackDepth;
+};
+
+// Built-in functions resolved when the image is written
+enum class ImageFunction : std::uint8_t { SIN, COS, SQRT, LOG, EXP, ABS, UNKNOWN };
+
+static_assert(sizeof(ImageHeader) == 96 && sizeof(ImageNode) == 8 && sizeof(ImageExpression) == 24,
+              "ExpressionImage structures are part of the file format");
+
+class ExpressionImage;
+
+// One expression inside an image; a view that is valid while the image is
+class MappedExpression {
+public:
+    // Same results and errors as ASTNode::evaluate
+    double evaluate(const VariableMap& variables = {}) const;
+    // Values in slot order (getVariable(0), getVariable(1), ...)
+    double evaluate(std::span<const double> slots) const;
+
+    std::string_view getName() const;
+    size_t getVariableCount() const { return entry->slotCount; }
+    std::string_view getVariable(size_t slot) const;
+    size_t getNodeCount() const { return entry->nodeCount; }
+
+    // Rebuild the tree (for display or for the other evaluators)
+    ASTNodePtr toAST() const;
+    std::string toString() const { return toAST()->toString(); }
+
+private:
+    friend class ExpressionImage;
+    MappedExpression(const ExpressionImage* image, const ImageExpression* entry) : image(image), entry(entry) {}
+
+    const ExpressionImage* image;
+    const ImageExpression* entry;
+
+    double execute(const double* slots, const unsigned char* defined) const;
+};
+
+// Read-only image over a file mapping or a caller-owned buffer
+class ExpressionImage {
+public:
+    static constexpr std::uint32_t FORMAT_VERSION = 1;
+    static constexpr size_t NOT_FOUND = std::numeric_limits<size_t>::max();
+
+    // Map a file read-only (read into memory where mmap is unavailable).
+    // Checks the header and section bounds; see verify() for the contents.
+    static ExpressionImage open(const std::string& path);
+    // Use bytes the caller keeps alive; must be 8-byte aligned
+    static ExpressionImage view(std::span<const std::byte> bytes);
+
+    ExpressionImage(ExpressionImage&& other) noexcept;
+    ExpressionImage& operator=(ExpressionImage&& other) noexcept;
+    ExpressionImage(const ExpressionImage&) = delete;
+    ExpressionImage& operator=(const ExpressionImage&) = delete;
+    ~ExpressionImage();
+
+    size_t size() const { return header->expressionCount; }
+    MappedExpression operator[](size_t index) const;
+    // Expression with the given name, or NOT_FOUND (binary search)
+    size_t find(std::string_view name) const;
+
+    // Check every index, node arity and the name order; throws std::runtime_error
+    // on the first bad one. Not done by open(), which touches only the header.
+    void verify() const;
+
+    std::string_view symbol(std::uint32_t index) const;
+    std::span<const std::byte> bytes() const { return data; }
+
+private:
+    friend class MappedExpression;
+
+    std::span<const std::byte> data;
+    void* mapping = nullptr;            // munmap on destruction
+    std::vector<std::byte> owned;       // fallback when the file could not be mapped
+    const ImageHeader* header = nullptr;
+    const std::uint32_t* symbolOffsets = nullptr;
+    const char* symbolBytes = nullptr;
+    const double* constants = nullptr;
+    const ImageNode* nodes = nullptr;
+    const std::uint32_t* slots = nullptr;
+    const ImageExpression* expressions = nullptr;
+    const std::uint32_t* nameIndex = nullptr;
+
+    ExpressionImage() = default;
+    void attach(std::span<const std::byte> bytes);
+    void release();
+};
+
+// Collects expressions and writes them as one image
+class ExpressionImageWriter {
+public:
+    // Returns the expression's index in the image
+    size_t add(const ASTNodePtr& ast, const std::string& name = "");
+
+    std::vector<std::byte> serialize() const;
+    void save(const std::string& path) const;
+
+    size_t size() const { return expressions.size(); }
+
+private:
+    std::vector<std::string> symbols;
+    std::unordered_map<std::string, std::uint32_t> symbolIndex;
+    std::vector<double> constants;
+    std::unordered_map<std::uint64_t, std::uint32_t> constantIndex;   // by bit pattern
+    std::vector<ImageNode> nodes;
+    std::vector<std::uint32_t> slots;
+    std::vector<ImageExpression> expressions;
+
+    std::uint32_t addSymbol(const std::string& text);
+    std::uint32_t addConstant(double value);
+    void appendNode(const ASTNode* node, const std::vector<std::string>& variables, size_t& depth,
+                    size_t& maxDepth);
+};
+
+#endif // EXPRESSION_IMAGE_H
@@ -0,0 +1,135 @@
+#include "ExpressionProfiler.h"
+#include "ASTTraversal.h"
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+
+thread_local ExpressionProfiler* ExpressionProfiler::active = nullptr;
+
+// Node text as print(0, true) shows it
+static std::string labelOf(const ASTNode& node) {
+    std::stringstream ss;
+    switch (node.type) {
+        case NodeType::NUMBER: ss << node.number.value; break;
+        case NodeType::VARIABLE: ss << node.variable.name; break;
+        case NodeType::BINARY_OP:
+        case NodeType::UNARY_OP: ss << ASTNode::opToString(node.op.op); break;
+        case NodeType::FUNCTION_CALL: ss << node.function.functionName << "()"; break;
+    }
+    return ss.str();
+}
+
+static const char* tokenKindName(TokenKind kind) {
+    switch (kind) {
+        case TokenKind::NUMBER: return "number";
+        case TokenKind::FUNCTION: return "function";
+        case TokenKind::VARIABLE: return "variable";
+        case TokenKind::OPERATOR: return "operator";
+        case TokenKind::UNARY_OPERATOR: return "unary operator";
+        case TokenKind::INVALID: return "invalid";
+    }
+    return "?";
+}
+
+static std::string microseconds(std::uint64_t nanoseconds) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3) << static_cast<double>(nanoseconds) / 1000.0 << " us";
+    return ss.str();
+}
+
+ExpressionProfiler::Scope::Scope(ExpressionProfiler& profiler) : previous(active) {
+    active = &profiler;
+}
+
+ExpressionProfiler::Scope::~Scope() {
+    active = previous;
+}
+
+ExpressionProfiler::Tracker::~Tracker() {
+    if (std::uncaught_exceptions() <= uncaught) return;
+    for (const OpenNode& node : open) record(node, true);
+}
+
+void ExpressionProfiler::Tracker::record(const OpenNode& node, bool failed) {
+    auto elapsed = std::chrono::steady_clock::now() - node.start;
+    ++node.stats->calls;
+    node.stats->nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    if (failed) ++node.stats->failures;
+}
+
+ExpressionProfiler::Stats* ExpressionProfiler::activeParseStats(TokenKind kind) {
+    return active ? &active->parseStats[static_cast<size_t>(kind)] : nullptr;
+}
+
+const ExpressionProfiler::Stats* ExpressionProfiler::find(const ASTNode* node) const {
+    auto it = nodes.find(node);
+    return it == nodes.end() ? nullptr : &it->second;
+}
+
+void ExpressionProfiler::reset() {
+    nodes.clear();
+    parseStats = {};
+}
+
+// Own time: the node's total minus its children's totals
+std::uint64_t ExpressionProfiler::selfNanoseconds(const ASTNode& node) const {
+    const Stats* stats = find(&node);
+    if (!stats) return 0;
+    std::uint64_t children = 0;
+    for (size_t i = 0; i < ASTTraversal::childCount(node); ++i) {
+        if (const Stats* childStats = find(ASTTraversal::child(node, i))) children += childStats->nanoseconds;
+    }
+    return stats->nanoseconds > children ? stats->nanoseconds - children : 0;
+}
+
+void ExpressionProfiler::printTree(const ASTNode& root, std::ostream& out) const {
+    // Every non-root line uses "|--- ", like ASTNode::print(0, true)
+    std::string prefix;
+    ASTTraversal::walk(root, [&](const TraversalStep& step) {
+        const ASTNode& node = *step.node;
+        if (step.parent) out << prefix << "|--- ";
+        out << labelOf(node);
+        if (const Stats* stats = find(&node)) {
+            out << "  [" << stats->calls << (stats->calls == 1 ? " call, " : " calls, ")
+                << microseconds(stats->nanoseconds) << ", self " << microseconds(selfNanoseconds(node));
+            if (stats->failures) out << ", " << stats->failures << " failed";
+            out << "]";
+        } else {
+            out << "  [not evaluated]";
+        }
+        out << "\n";
+        if (step.parent) prefix += step.index + 1 == ASTTraversal::childCount(*step.parent) ? "    " : "|   ";
+        return Visit::CONTINUE;
+    }, [&](const TraversalStep& step) {
+        if (step.parent) prefix.resize(prefix.size() - 4);
+    });
+}
+
+void ExpressionProfiler::writeFoldedStacks(const ASTNode& root, std::ostream& out) const {
+    std::string stack;
+    std::vector<size_t> lengths;
+    ASTTraversal::walk(root, [&](const TraversalStep& step) {
+        lengths.push_back(stack.size());
+        if (!stack.empty()) stack += ';';
+        stack += labelOf(*step.node);
+
+        // Children of a node that never ran never ran either
+        if (!find(step.node)) return Visit::SKIP_CHILDREN;
+        if (std::uint64_t self = selfNanoseconds(*step.node)) out << stack << " " << self << "\n";
+        return Visit::CONTINUE;
+    }, [&](const TraversalStep&) {
+        stack.resize(lengths.back());
+        lengths.pop_back();
+    });
+}
+
+void ExpressionProfiler::printParseStats(std::ostream& out) const {
+    for (size_t kind = 0; kind < parseStats.size(); ++kind) {
+        const Stats& stats = parseStats[kind];
+        if (!stats.calls) continue;
+        out << std::left << std::setw(16) << tokenKindName(static_cast<TokenKind>(kind)) << std::right
+            << std::setw(10) << stats.calls << " tokens" << std::setw(16) << microseconds(stats.nanoseconds);
+        if (stats.failures) out << ", " << stats.failures << " failed";
+        out << "\n";
+    }
+}
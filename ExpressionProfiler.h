@@ -0,0 +1,154 @@
+#ifndef EXPRESSION_PROFILER_H
+#define EXPRESSION_PROFILER_H
+
+#include "AST_NODE.h"
+#include "PostfixTokenizer.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <iosfwd>
+#include <unordered_map>
+#include <vector>
+
+// Per-node call counts, times and failures for ASTNode::evaluate, and per
+// token kind for PostfixToAST::processToken. The hooks are only compiled in
+// when EXPRESSION_PROFILING is defined (make PROFILE=1); otherwise they expand
+// to nothing and the profiler never sees a call. When compiled in, a thread's
+// calls are recorded only while a Scope is open on it.
+class ExpressionProfiler {
+public:
+#ifdef EXPRESSION_PROFILING
+    static constexpr bool COMPILED_IN = true;
+#else
+    static constexpr bool COMPILED_IN = false;
+#endif
+
+    struct Stats {
+        std::uint64_t calls = 0;
+        std::uint64_t nanoseconds = 0;    // including children
+        std::uint64_t failures = 0;       // calls that threw or returned an error
+    };
+
+    // Records the calling thread into `profiler` until destroyed (scopes nest)
+    class Scope {
+    public:
+        explicit Scope(ExpressionProfiler& profiler);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        ExpressionProfiler* previous;
+    };
+
+    // Times one call into `stats`; does nothing for nullptr. The call counts as
+    // failed if it throws or fail() is called.
+    class Timer {
+    public:
+        explicit Timer(Stats* stats)
+            : stats(stats), uncaught(std::uncaught_exceptions()),
+              start(stats ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point()) {}
+        ~Timer() {
+            if (!stats) return;
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            ++stats->calls;
+            stats->nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+            if (failed || std::uncaught_exceptions() > uncaught) ++stats->failures;
+        }
+
+        void fail() { failed = true; }
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+    private:
+        Stats* stats;
+        int uncaught;
+        bool failed = false;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    // Times the nodes of an explicit-stack traversal into the thread's active
+    // profiler: enter() when a node is reached, leave() once it has its value,
+    // fail() when evaluation stops with an error. Nodes still open at fail(),
+    // or when an exception destroys the tracker, count as failed.
+    class Tracker {
+    public:
+        Tracker() : profiler(active), uncaught(std::uncaught_exceptions()) {}
+        ~Tracker();
+
+        void enter(const ASTNode* node) {
+            if (profiler) open.push_back({&profiler->nodes[node], std::chrono::steady_clock::now()});
+        }
+        void leave() {
+            if (!profiler) return;
+            record(open.back(), false);
+            open.pop_back();
+        }
+        void fail() {
+            for (const OpenNode& node : open) record(node, true);
+            open.clear();
+        }
+
+        Tracker(const Tracker&) = delete;
+        Tracker& operator=(const Tracker&) = delete;
+
+    private:
+        struct OpenNode {
+            Stats* stats;
+            std::chrono::steady_clock::time_point start;
+        };
+
+        ExpressionProfiler* profiler;
+        int uncaught;
+        std::vector<OpenNode> open;
+
+        static void record(const OpenNode& node, bool failed);
+    };
+
+    // processToken entry of the thread's active profiler, or nullptr outside a Scope
+    static Stats* activeParseStats(TokenKind kind);
+
+    // nullptr if the node was never evaluated. Nodes are keyed by address, so
+    // a node shared by several parents (HashConsBuilder) has one entry.
+    const Stats* find(const ASTNode* node) const;
+    const Stats& getParseStats(TokenKind kind) const { return parseStats[static_cast<size_t>(kind)]; }
+    void reset();
+
+    // Same layout as ASTNode::print(0, true), each node followed by its calls,
+    // total and self time, and failures
+    void printTree(const ASTNode& root, std::ostream& out) const;
+    // One "root;child;...;node selfNanoseconds" line per node, for
+    // flamegraph.pl or speedscope
+    void writeFoldedStacks(const ASTNode& root, std::ostream& out) const;
+    // One line per token kind seen by processToken
+    void printParseStats(std::ostream& out) const;
+
+private:
+    std::unordered_map<const ASTNode*, Stats> nodes;
+    std::array<Stats, static_cast<size_t>(TokenKind::INVALID) + 1> parseStats{};
+
+    static thread_local ExpressionProfiler* active;
+
+    std::uint64_t selfNanoseconds(const ASTNode& node) const;
+};
+
+#ifdef EXPRESSION_PROFILING
+#define PROFILE_TRAVERSAL() ExpressionProfiler::Tracker profileTracker
+#define PROFILE_ENTER(node) profileTracker.enter(node)
+#define PROFILE_LEAVE() profileTracker.leave()
+#define PROFILE_FAIL() profileTracker.fail()
+#define PROFILE_PARSE_TOKEN(kind) ExpressionProfiler::Timer profileTimer(ExpressionProfiler::activeParseStats(kind))
+#define PROFILE_PARSE_FAIL() profileTimer.fail()
+#else
+#define PROFILE_TRAVERSAL() ((void)0)
+#define PROFILE_ENTER(node) ((void)(node))
+#define PROFILE_LEAVE() ((void)0)
+#define PROFILE_FAIL() ((void)0)
+#define PROFILE_PARSE_TOKEN(kind) ((void)(kind))
+#define PROFILE_PARSE_FAIL() ((void)0)
+#endif
+
+#endif // EXPRESSION_PROFILER_H
@@ -0,0 +1,132 @@
+#include "ExpressionSimplifier.h"
+#include <cmath>
+#include <stdexcept>
+
+static bool isConstant(const ASTNodePtr& node, double value) {
+    return node->type == NodeType::NUMBER && node->number.value == value;
+}
+
+// Simplify a tree and record how many nodes were dropped
+ASTNodePtr ExpressionSimplifier::simplify(const ASTNodePtr& ast) {
+    ASTNodePtr result = simplifyNode(ast);
+    removedNodes = countNodes(ast) - countNodes(result);
+    return result;
+}
+
+// Count nodes recursively
+size_t ExpressionSimplifier::countNodes(const ASTNodePtr& ast) {
+    switch(ast->type) {
+        case NodeType::BINARY_OP:
+            return 1 + countNodes(ast->op.left) + countNodes(ast->op.right);
+        case NodeType::UNARY_OP:
+            return 1 + countNodes(ast->op.left);
+        case NodeType::FUNCTION_CALL: {
+            size_t count = 1;
+            for (const auto& arg : ast->function.arguments) count += countNodes(arg);
+            return count;
+        }
+        default:
+            return 1;
+    }
+}
+
+// Replace a node whose children are all numbers by its value, unless
+// evaluating it throws or gives inf/NaN, which toString cannot write back as
+// a number (0 ^ -1 stays as it is)
+ASTNodePtr ExpressionSimplifier::tryFold(const ASTNodePtr& node) {
+    double value;
+    try {
+        value = node->evaluate();
+    } catch (const std::exception&) {
+        return node;
+    }
+    return std::isfinite(value) ? ASTNode::createNumber(value) : node;
+}
+
+// A zero that can be dropped from an addition. x + (+0) turns x = -0 into +0,
+// so only -0 qualifies in IEEE-exact mode.
+bool ExpressionSimplifier::isIdentityZero(const ASTNodePtr& node) const {
+    if (!isConstant(node, 0.0)) return false;
+    return !ieeeExact || std::signbit(node->number.value);
+}
+
+// Simplify children first, then fold or apply identities
+ASTNodePtr ExpressionSimplifier::simplifyNode(const ASTNodePtr& node) const {
+    switch(node->type) {
+        case NodeType::BINARY_OP: {
+            ASTNodePtr left = simplifyNode(node->op.left);
+            ASTNodePtr right = simplifyNode(node->op.right);
+            return simplifyBinary(node, left, right);
+        }
+
+        case NodeType::UNARY_OP: {
+            ASTNodePtr operand = simplifyNode(node->op.left);
+            // -(-x) => x
+            if (node->op.op == OperatorType::NEGATIVE && operand->type == NodeType::UNARY_OP &&
+                operand->op.op == OperatorType::NEGATIVE) {
+                return operand->op.left;
+            }
+            ASTNodePtr result = operand == node->op.left ? node : ASTNode::createUnaryOp(node->op.op, operand);
+            return operand->type == NodeType::NUMBER ? tryFold(result) : result;
+        }
+
+        case NodeType::FUNCTION_CALL: {
+            std::vector<ASTNodePtr> args;
+            args.reserve(node->function.arguments.size());
+            bool changed = false;
+            bool allConstant = true;
+            for (const auto& arg : node->function.arguments) {
+                args.push_back(simplifyNode(arg));
+                changed |= args.back() != arg;
+                allConstant &= args.back()->type == NodeType::NUMBER;
+            }
+            ASTNodePtr result = changed ? ASTNode::createFunctionCall(node->function.functionName, args) : node;
+            return allConstant ? tryFold(result) : result;
+        }
+
+        default:
+            return node;
+    }
+}
+
+// Fold constant operands or drop an identity element
+ASTNodePtr ExpressionSimplifier::simplifyBinary(const ASTNodePtr& node, const ASTNodePtr& left,
+                                                const ASTNodePtr& right) const {
+    OperatorType op = node->op.op;
+    ASTNodePtr result = (left == node->op.left && right == node->op.right)
+        ? node : ASTNode::createBinaryOp(op, left, right);
+
+    if (left->type == NodeType::NUMBER && right->type == NodeType::NUMBER) {
+        ASTNodePtr folded = tryFold(result);
+        if (folded != result) return folded;
+    }
+
+    switch(op) {
+        case OperatorType::ADD:
+            if (isIdentityZero(right)) return left;
+            if (isIdentityZero(left)) return right;
+            break;
+        case OperatorType::SUBTRACT:
+            // x - (+0) keeps the sign of every x
+            if (isConstant(right, 0.0) && (!ieeeExact || !std::signbit(right->number.value))) return left;
+            break;
+        case OperatorType::MULTIPLY:
+            if (isConstant(right, 1.0)) return left;
+            if (isConstant(left, 1.0)) return right;
+            break;
+        case OperatorType::DIVIDE:
+            if (isConstant(right, 1.0)) return left;
+            break;
+        case OperatorType::POWER:
+            if (isConstant(right, 1.0)) return left;
+            // A folded negative base prints as "-8 ^ y", which parses as
+            // -(8 ^ y); keep the base as it was written
+            if (left != node->op.left && left->type == NodeType::NUMBER && std::signbit(left->number.value)) {
+                return ASTNode::createBinaryOp(op, node->op.left, right);
+            }
+            break;
+        default:
+            break;
+    }
+    return result;
+}
@@ -0,0 +1,40 @@
+#ifndef EXPRESSION_SIMPLIFIER_H
+#define EXPRESSION_SIMPLIFIER_H
+
+#include "AST_NODE.h"
+
+// Returns an equivalent, smaller copy of an AST. Constant subtrees are folded
+// with ASTNode::evaluate itself, so anything that would throw is left in place
+// and still throws at evaluation. Subtrees that evaluate to inf or NaN are kept
+// too, as is a negative base of ^ ("-8 ^ y" would read as -(8 ^ y)), so the
+// toString() output parses back to the same value. Identities only drop nodes
+// when the other operand is kept, so variable errors are reported as before:
+//   x + 0, 0 + x, x - 0, x * 1, 1 * x, x / 1, x ^ 1, -(-x)
+// With ieeeExact set, x + 0 is only applied when it cannot change the sign of
+// a zero, so results stay bit-identical to the original tree.
+class ExpressionSimplifier {
+public:
+    explicit ExpressionSimplifier(bool ieeeExact = false) : ieeeExact(ieeeExact) {}
+
+    // Simplified tree; unchanged subtrees are shared with the input
+    ASTNodePtr simplify(const ASTNodePtr& ast);
+
+    // Nodes removed by the last simplify()
+    size_t getRemovedNodes() const { return removedNodes; }
+
+    bool isIeeeExact() const { return ieeeExact; }
+
+    // Number of nodes in a tree
+    static size_t countNodes(const ASTNodePtr& ast);
+
+private:
+    bool ieeeExact;
+    size_t removedNodes = 0;
+
+    ASTNodePtr simplifyNode(const ASTNodePtr& node) const;
+    ASTNodePtr simplifyBinary(const ASTNodePtr& node, const ASTNodePtr& left, const ASTNodePtr& right) const;
+    bool isIdentityZero(const ASTNodePtr& node) const;
+    static ASTNodePtr tryFold(const ASTNodePtr& node);
+};
+
+#endif // EXPRESSION_SIMPLIFIER_H
@@ -0,0 +1,327 @@
+#include "FlatAST.h"
+#include "ASTTraversal.h"
+#include <stdexcept>
+#include <cmath>
+#include <algorithm>
+#include <bit>
+#include <unordered_map>
+
+// Convert a shared_ptr tree into postorder arrays
+FlatAST FlatAST::fromAST(const ASTNodePtr& ast) {
+    if (!ast) {
+        throw std::runtime_error("Cannot flatten an empty AST");
+    }
+
+    FlatAST flat;
+    flat.variables = ast->collectVariables();
+    flat.appendNode(ast.get());
+    return flat;
+}
+
+// Append a subtree in postorder, on an explicit stack so depth is unbounded
+void FlatAST::appendNode(const ASTNode* root) {
+    std::vector<std::uint32_t> starts;
+    // Equal constants (by bit pattern, so 0 and -0 stay apart) share a pool entry
+    std::unordered_map<std::uint64_t, std::uint32_t> constantIndex;
+    ASTTraversal::walk(*root, [&](const TraversalStep&) {
+        starts.push_back(static_cast<std::uint32_t>(kinds.size()));
+        return Visit::CONTINUE;
+    }, [&](const TraversalStep& step) {
+        const ASTNode* node = step.node;
+        std::uint32_t childCount = static_cast<std::uint32_t>(ASTTraversal::childCount(*node));
+        std::uint32_t operand = 0;
+        OperatorType op = OperatorType::NONE;
+
+        switch(node->type) {
+            case NodeType::NUMBER: {
+                auto [it, added] = constantIndex.try_emplace(std::bit_cast<std::uint64_t>(node->number.value),
+                                                             static_cast<std::uint32_t>(constants.size()));
+                if (added) constants.push_back(node->number.value);
+                operand = it->second;
+                break;
+            }
+
+            case NodeType::VARIABLE: {
+                auto it = std::lower_bound(variables.begin(), variables.end(), node->variable.name);
+                operand = static_cast<std::uint32_t>(it - variables.begin());
+                break;
+            }
+
+            case NodeType::BINARY_OP:
+            case NodeType::UNARY_OP:
+                op = node->op.op;
+                break;
+
+            case NodeType::FUNCTION_CALL: {
+                const std::string& name = node->function.functionName;
+                auto it = std::find(functionNames.begin(), functionNames.end(), name);
+                if (it == functionNames.end()) {
+                    functionNames.push_back(name);
+                    it = functionNames.end() - 1;
+                }
+                operand = static_cast<std::uint32_t>(it - functionNames.begin());
+                break;
+            }
+        }
+
+        kinds.push_back(node->type);
+        ops.push_back(op);
+        childCounts.push_back(childCount);
+        operands.push_back(operand);
+        subtreeStarts.push_back(starts.back());
+        starts.pop_back();
+    });
+}
+
+// Rebuild a shared_ptr tree
+ASTNodePtr FlatAST::toAST() const {
+    std::vector<ASTNodePtr> stack;
+
+    for (size_t i = 0; i < kinds.size(); ++i) {
+        switch(kinds[i]) {
+            case NodeType::NUMBER:
+                stack.push_back(ASTNode::createNumber(constants[operands[i]]));
+                break;
+            case NodeType::VARIABLE:
+                stack.push_back(ASTNode::createVariable(variables[operands[i]]));
+                break;
+            case NodeType::BINARY_OP: {
+                ASTNodePtr right = stack.back();
+                stack.pop_back();
+                stack.back() = ASTNode::createBinaryOp(ops[i], stack.back(), right);
+                break;
+            }
+            case NodeType::UNARY_OP:
+                stack.back() = ASTNode::createUnaryOp(ops[i], stack.back());
+                break;
+            case NodeType::FUNCTION_CALL: {
+                std::vector<ASTNodePtr> args(stack.end() - childCounts[i], stack.end());
+                stack.resize(stack.size() - childCounts[i]);
+                stack.push_back(ASTNode::createFunctionCall(functionNames[operands[i]], args));
+                break;
+            }
+        }
+    }
+
+    return stack.back();
+}
+
+// Evaluate with a value stack (same results and errors as ASTNode::evaluate)
+double FlatAST::evaluate(const VariableMap& variableMap) const {
+    // Resolve slots once; a missing variable only fails when it is reached
+    std::vector<const double*> slots(variables.size(), nullptr);
+    for (size_t i = 0; i < variables.size(); ++i) {
+        auto it = variableMap.find(variables[i]);
+        if (it != variableMap.end()) slots[i] = &it->second;
+    }
+
+    std::vector<double> stack;
+    stack.reserve(kinds.size());
+
+    for (size_t i = 0; i < kinds.size(); ++i) {
+        switch(kinds[i]) {
+            case NodeType::NUMBER:
+                stack.push_back(constants[operands[i]]);
+                break;
+
+            case NodeType::VARIABLE:
+                if (!slots[operands[i]]) {
+                    throw std::runtime_error("Undefined variable: " + variables[operands[i]]);
+                }
+                stack.push_back(*slots[operands[i]]);
+                break;
+
+            case NodeType::BINARY_OP: {
+                double rightVal = stack.back();
+                stack.pop_back();
+                double& leftVal = stack.back();
+                switch(ops[i]) {
+                    case OperatorType::ADD: leftVal = leftVal + rightVal; break;
+                    case OperatorType::SUBTRACT: leftVal = leftVal - rightVal; break;
+                    case OperatorType::MULTIPLY: leftVal = leftVal * rightVal; break;
+                    case OperatorType::DIVIDE:
+                        if (rightVal == 0) throw std::runtime_error("Division by zero");
+                        leftVal = leftVal / rightVal;
+                        break;
+                    case OperatorType::POWER: leftVal = std::pow(leftVal, rightVal); break;
+                    default: throw std::runtime_error("Unknown binary operator");
+                }
+                break;
+            }
+
+            case NodeType::UNARY_OP:
+                if (ops[i] != OperatorType::NEGATIVE) throw std::runtime_error("Unknown unary operator");
+                stack.back() = -stack.back();
+                break;
+
+            case NodeType::FUNCTION_CALL: {
+                const std::string& funcName = functionNames[operands[i]];
+                if (childCounts[i] != 1) {
+                    throw std::runtime_error("Unknown function or wrong number of arguments: " + funcName);
+                }
+
+                double& arg = stack.back();
+                if (funcName == "sin") {
+                    arg = std::sin(arg);
+                } else if (funcName == "cos") {
+                    arg = std::cos(arg);
+                } else if (funcName == "sqrt") {
+                    if (arg < 0) throw std::runtime_error("Square root of negative number");
+                    arg = std::sqrt(arg);
+                } else if (funcName == "log") {
+                    if (arg <= 0) throw std::runtime_error("Log of non-positive number");
+                    arg = std::log(arg);
+                } else if (funcName == "exp") {
+                    arg = std::exp(arg);
+                } else if (funcName == "abs") {
+                    arg = std::abs(arg);
+                } else {
+                    throw std::runtime_error("Unknown function or wrong number of arguments: " + funcName);
+                }
+                break;
+            }
+        }
+    }
+
+    return stack.back();
+}
+
+// Render infix text in one pass into a single buffer (same output as
+// ASTNode::toString). A node's last child ends right before it and each
+// earlier child ends right before the next one's subtreeStart, so children
+// are found without building per-node strings; pending work sits on an
+// explicit stack of nodes and literal pieces, pushed in reverse order.
+std::string FlatAST::toString() const {
+    struct Pending {
+        enum Kind : std::uint8_t { NODE, TEXT, OPERATOR } kind;
+        std::uint32_t node;     // NODE, or the binary node whose operator to append
+        const char* text;       // TEXT
+    };
+    std::vector<Pending> stack;
+    std::string out;
+    // Each pooled constant is formatted once, on first use
+    std::vector<std::string> constantText(constants.size());
+
+    // Precedence of a child, -1 for operands that never need parentheses
+    auto childPrecedence = [this](std::uint32_t node) {
+        if (kinds[node] == NodeType::BINARY_OP || kinds[node] == NodeType::UNARY_OP) {
+            return ASTNode::getPrecedence(ops[node]);
+        }
+        return -1;
+    };
+    // Push a child, wrapped in parentheses if needed
+    auto pushChild = [&stack](std::uint32_t node, bool parens) {
+        if (parens) stack.push_back({Pending::TEXT, 0, ")"});
+        stack.push_back({Pending::NODE, node, nullptr});
+        if (parens) stack.push_back({Pending::TEXT, 0, "("});
+    };
+
+    if (!kinds.empty()) stack.push_back({Pending::NODE, static_cast<std::uint32_t>(kinds.size() - 1), nullptr});
+    while (!stack.empty()) {
+        Pending pending = stack.back();
+        stack.pop_back();
+        if (pending.kind == Pending::TEXT) {
+            out += pending.text;
+            continue;
+        }
+        if (pending.kind == Pending::OPERATOR) {
+            out += ' ';
+            out += ASTNode::opToString(ops[pending.node]);
+            out += ' ';
+            continue;
+        }
+
+        std::uint32_t i = pending.node;
+        switch(kinds[i]) {
+            case NodeType::NUMBER: {
+                std::string& text = constantText[operands[i]];
+                if (text.empty()) text = ASTNode::numberToString(constants[operands[i]]);
+                out += text;
+                break;
+            }
+
+            case NodeType::VARIABLE:
+                out += variables[operands[i]];
+                break;
+
+            case NodeType::BINARY_OP: {
+                std::uint32_t right = i - 1;
+                std::uint32_t left = subtreeStarts[right] - 1;
+                int precedence = ASTNode::getPrecedence(ops[i]);
+                int leftPrecedence = childPrecedence(left);
+                int rightPrecedence = childPrecedence(right);
+
+                pushChild(right, rightPrecedence >= 0 && rightPrecedence <= precedence);
+                stack.push_back({Pending::OPERATOR, i, nullptr});
+                pushChild(left, leftPrecedence >= 0 && leftPrecedence < precedence);
+                break;
+            }
+
+            case NodeType::UNARY_OP:
+                if (ops[i] == OperatorType::NEGATIVE) {
+                    out += '-';
+                    stack.push_back({Pending::NODE, i - 1, nullptr});
+                } else {
+                    out += ASTNode::opToString(ops[i]);
+                    out += '(';
+                    stack.push_back({Pending::TEXT, 0, ")"});
+                    stack.push_back({Pending::NODE, i - 1, nullptr});
+                }
+                break;
+
+            case NodeType::FUNCTION_CALL: {
+                out += functionNames[operands[i]];
+                out += '(';
+                stack.push_back({Pending::TEXT, 0, ")"});
+                // Arguments from the last to the first, so the first is emitted first
+                std::uint32_t child = i;
+                for (std::uint32_t arg = 0; arg < childCounts[i]; ++arg) {
+                    child = arg == 0 ? i - 1 : subtreeStarts[child] - 1;
+                    if (arg > 0) stack.push_back({Pending::TEXT, 0, ", "});
+                    stack.push_back({Pending::NODE, child, nullptr});
+                }
+                break;
+            }
+        }
+    }
+
+    return out;
+}
+
+// Collect the variables that are referenced by at least one node
+std::vector<std::string> FlatAST::collectVariables() const {
+    std::vector<bool> used(variables.size(), false);
+    for (size_t i = 0; i < kinds.size(); ++i) {
+        if (kinds[i] == NodeType::VARIABLE) used[operands[i]] = true;
+    }
+
+    // Slots are already sorted and unique
+    std::vector<std::string> result;
+    for (size_t slot = 0; slot < variables.size(); ++slot) {
+        if (used[slot]) result.push_back(variables[slot]);
+    }
+    return result;
+}
+
+// Check if any node is a variable
+bool FlatAST::hasVariables() const {
+    return std::find(kinds.begin(), kinds.end(), NodeType::VARIABLE) != kinds.end();
+}
+
+// Bytes held by all arrays and strings
+size_t FlatAST::memoryBytes() const {
+    size_t bytes = sizeof(FlatAST);
+    bytes += kinds.capacity() * sizeof(NodeType);
+    bytes += ops.capacity() * sizeof(OperatorType);
+    bytes += childCounts.capacity() * sizeof(std::uint32_t);
+    bytes += operands.capacity() * sizeof(std::uint32_t);
+    bytes += subtreeStarts.capacity() * sizeof(std::uint32_t);
+    bytes += constants.capacity() * sizeof(double);
+    for (const auto& names : {&variables, &functionNames}) {
+        bytes += names->capacity() * sizeof(std::string);
+        for (const auto& name : *names) {
+            if (name.capacity() > 15) bytes += name.capacity() + 1;
+        }
+    }
+    return bytes;
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef FLAT_AST_H
+#define FLAT_AST_H
+
+#include "AST_NODE.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Immutable struct-of-arrays tree. Nodes are stored in postorder, so every
+// operation is a single linear scan; the children of node i are the
+// subtrees that end right before it.
+class FlatAST {
+public:
+    // Convert from and to the shared_ptr tree
+    static FlatAST fromAST(const ASTNodePtr& ast);
+    ASTNodePtr toAST() const;
+
+    // Same behaviour as the ASTNode functions, as linear scans
+    double evaluate(const VariableMap& variables = {}) const;
+    std::string toString() const;
+    std::vector<std::string> collectVariables() const;
+    bool hasVariables() const;
+
+    // Layout accessors
+    size_t size() const { return kinds.size(); }
+    NodeType getKind(size_t node) const { return kinds[node]; }
+    OperatorType getOperator(size_t node) const { return ops[node]; }
+    std::uint32_t getChildCount(size_t node) const { return childCounts[node]; }
+    std::uint32_t getOperand(size_t node) const { return operands[node]; }
+    std::uint32_t getSubtreeStart(size_t node) const { return subtreeStarts[node]; }
+    const std::vector<double>& getConstants() const { return constants; }
+    const std::vector<std::string>& getVariables() const { return variables; }
+    const std::vector<std::string>& getFunctionNames() const { return functionNames; }
+
+    // Bytes held by all arrays and strings
+    size_t memoryBytes() const;
+
+private:
+    std::vector<NodeType> kinds;
+    std::vector<OperatorType> ops;                 // BINARY_OP / UNARY_OP
+    std::vector<std::uint32_t> childCounts;
+    std::vector<std::uint32_t> operands;           // constant, variable slot or function name index
+    std::vector<std::uint32_t> subtreeStarts;      // index of the first node of each subtree
+    std::vector<double> constants;                 // one entry per distinct value (bit pattern)
+    std::vector<std::string> variables;            // slot order, same as ASTNode::collectVariables()
+    std::vector<std::string> functionNames;
+
+    void appendNode(const ASTNode* node);
+};
+
+#endif // FLAT_AST_H
\ No newline at end of file
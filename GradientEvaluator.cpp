@@ -0,0 +1,459 @@
+#include "GradientEvaluator.h"
+#include "BatchEvaluator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+GradientEvaluator::GradientEvaluator(const ASTNodePtr& ast) {
+    if (!ast) {
+        throw std::runtime_error("Cannot differentiate an empty AST");
+    }
+    variables = ast->collectVariables();
+    std::unordered_map<const ASTNode*, std::uint32_t> seen;
+    addNode(ast.get(), seen);
+}
+
+std::uint32_t GradientEvaluator::addNode(const ASTNode* node,
+                                         std::unordered_map<const ASTNode*, std::uint32_t>& seen) {
+    auto found = seen.find(node);
+    if (found != seen.end()) return found->second;
+
+    std::vector<std::uint32_t> children;
+    switch(node->type) {
+        case NodeType::BINARY_OP:
+            children.push_back(addNode(node->op.left.get(), seen));
+            children.push_back(addNode(node->op.right.get(), seen));
+            break;
+        case NodeType::UNARY_OP:
+            children.push_back(addNode(node->op.left.get(), seen));
+            break;
+        case NodeType::FUNCTION_CALL:
+            for (const auto& arg : node->function.arguments) {
+                children.push_back(addNode(arg.get(), seen));
+            }
+            break;
+        default:
+            break;
+    }
+
+    Node entry{};
+    entry.type = node->type;
+    entry.op = OperatorType::NONE;
+    entry.function = Function::UNKNOWN;
+    entry.firstChild = static_cast<std::uint32_t>(childIndices.size());
+    entry.childCount = static_cast<std::uint32_t>(children.size());
+    childIndices.insert(childIndices.end(), children.begin(), children.end());
+
+    switch(node->type) {
+        case NodeType::NUMBER:
+            constants.push_back(node->number.value);
+            entry.operand = static_cast<std::uint32_t>(constants.size() - 1);
+            break;
+        case NodeType::VARIABLE: {
+            auto it = std::lower_bound(variables.begin(), variables.end(), node->variable.name);
+            entry.operand = static_cast<std::uint32_t>(it - variables.begin());
+            break;
+        }
+        case NodeType::BINARY_OP:
+        case NodeType::UNARY_OP:
+            entry.op = node->op.op;
+            break;
+        case NodeType::FUNCTION_CALL: {
+            // Same dispatch as ASTNode::evaluate: single-argument built-ins only
+            static const char* names[] = {"sin", "cos", "sqrt", "log", "exp", "abs"};
+            const std::string& name = node->function.functionName;
+            if (children.size() == 1) {
+                for (size_t f = 0; f < std::size(names); ++f) {
+                    if (name == names[f]) entry.function = static_cast<Function>(f);
+                }
+            }
+            functionNames.push_back(name);
+            entry.operand = static_cast<std::uint32_t>(functionNames.size() - 1);
+            break;
+        }
+    }
+
+    nodes.push_back(entry);
+    std::uint32_t index = static_cast<std::uint32_t>(nodes.size() - 1);
+    seen.emplace(node, index);
+    return index;
+}
+
+double GradientEvaluator::evaluate(std::span<const double> values, std::span<double> gradient) const {
+    if (values.size() != variables.size() || gradient.size() != variables.size()) {
+        throw std::runtime_error("Expected " + std::to_string(variables.size()) + " values and gradient entries");
+    }
+    std::vector<const double*> inputs(variables.size());
+    std::vector<double*> outputs(variables.size());
+    for (size_t i = 0; i < variables.size(); ++i) {
+        inputs[i] = &values[i];
+        outputs[i] = &gradient[i];
+    }
+
+    std::vector<double> scratch(2 * nodes.size());
+    std::string errorMessage;
+    double result = 0;
+    if (sweep(inputs.data(), nullptr, 1, &result, outputs.data(), scratch.data(), scratch.data() + nodes.size(),
+              errorMessage) == 0) {
+        throw std::runtime_error(errorMessage);
+    }
+    return result;
+}
+
+double GradientEvaluator::evaluate(const VariableMap& variableMap, std::vector<double>& gradient) const {
+    std::vector<double> values(variables.size());
+    std::vector<unsigned char> defined(variables.size());
+    std::vector<const double*> inputs(variables.size());
+    std::vector<double*> outputs(variables.size());
+    gradient.assign(variables.size(), 0.0);
+    for (size_t i = 0; i < variables.size(); ++i) {
+        auto it = variableMap.find(variables[i]);
+        if (it != variableMap.end()) {
+            values[i] = it->second;
+            defined[i] = 1;
+        }
+        inputs[i] = &values[i];
+        outputs[i] = &gradient[i];
+    }
+
+    std::vector<double> scratch(2 * nodes.size());
+    std::string errorMessage;
+    double result = 0;
+    if (sweep(inputs.data(), defined.data(), 1, &result, outputs.data(), scratch.data(),
+              scratch.data() + nodes.size(), errorMessage) == 0) {
+        throw std::runtime_error(errorMessage);
+    }
+    return result;
+}
+
+void GradientEvaluator::evaluate(const std::vector<std::span<const double>>& columns, std::span<double> output,
+                                 const std::vector<std::span<double>>& gradients) const {
+    if (columns.size() != variables.size() || gradients.size() != variables.size()) {
+        throw std::runtime_error("Expected " + std::to_string(variables.size()) + " columns but got " +
+                                 std::to_string(columns.size()) + " inputs and " +
+                                 std::to_string(gradients.size()) + " gradients");
+    }
+    for (size_t i = 0; i < variables.size(); ++i) {
+        if (columns[i].size() < output.size() || gradients[i].size() < output.size()) {
+            throw std::runtime_error("Column for variable '" + variables[i] + "' is shorter than the output");
+        }
+    }
+
+    constexpr size_t CHUNK_SIZE = BatchEvaluator::CHUNK_SIZE;
+    std::vector<double> scratch(2 * nodes.size() * CHUNK_SIZE);
+    std::vector<const double*> inputs(variables.size());
+    std::vector<double*> outputs(variables.size());
+    std::string errorMessage;
+
+    for (size_t start = 0; start < output.size(); start += CHUNK_SIZE) {
+        size_t count = std::min(CHUNK_SIZE, output.size() - start);
+        for (size_t i = 0; i < variables.size(); ++i) {
+            inputs[i] = columns[i].data() + start;
+            outputs[i] = gradients[i].data() + start;
+        }
+        double* values = scratch.data();
+        double* adjoints = values + nodes.size() * count;
+        size_t failed = sweep(inputs.data(), nullptr, count, output.data() + start, outputs.data(), values,
+                              adjoints, errorMessage);
+        if (failed < count) {
+            throw BatchEvaluationError(errorMessage, start + failed);
+        }
+    }
+}
+
+// Index of the first lane where failing(lane) holds, or count
+template <typename Predicate>
+static size_t firstLane(size_t count, Predicate failing) {
+    for (size_t lane = 0; lane < count; ++lane) {
+        if (failing(lane)) return lane;
+    }
+    return count;
+}
+
+size_t GradientEvaluator::sweep(const double* const* inputs, const unsigned char* defined, size_t count,
+                                double* output, double* const* gradients, double* values, double* adjoints,
+                                std::string& errorMessage) const {
+    // Nodes run in order, so the first failure seen for a lane is the one
+    // ASTNode::evaluate reports; the lowest such lane wins
+    size_t firstFailure = count;
+    auto fail = [&](size_t lane, const std::string& message) {
+        if (lane < firstFailure) {
+            firstFailure = lane;
+            errorMessage = message;
+        }
+    };
+
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const Node& node = nodes[i];
+        double* v = values + i * count;
+        const double* a = node.childCount > 0 ? values + childIndices[node.firstChild] * count : nullptr;
+        const double* b = node.childCount > 1 ? values + childIndices[node.firstChild + 1] * count : nullptr;
+
+        switch(node.type) {
+            case NodeType::NUMBER:
+                std::fill(v, v + count, constants[node.operand]);
+                break;
+
+            case NodeType::VARIABLE:
+                if (defined && !defined[node.operand]) {
+                    fail(0, "Undefined variable: " + variables[node.operand]);
+                    std::fill(v, v + count, 0.0);
+                } else {
+                    std::copy(inputs[node.operand], inputs[node.operand] + count, v);
+                }
+                break;
+
+            case NodeType::BINARY_OP:
+                switch(node.op) {
+                    case OperatorType::ADD: for (size_t l = 0; l < count; ++l) v[l] = a[l] + b[l]; break;
+                    case OperatorType::SUBTRACT: for (size_t l = 0; l < count; ++l) v[l] = a[l] - b[l]; break;
+                    case OperatorType::MULTIPLY: for (size_t l = 0; l < count; ++l) v[l] = a[l] * b[l]; break;
+                    case OperatorType::DIVIDE: {
+                        size_t lane = firstLane(count, [&](size_t l) { return b[l] == 0; });
+                        if (lane < count) fail(lane, "Division by zero");
+                        for (size_t l = 0; l < count; ++l) v[l] = a[l] / b[l];
+                        break;
+                    }
+                    case OperatorType::POWER: for (size_t l = 0; l < count; ++l) v[l] = std::pow(a[l], b[l]); break;
+                    default:
+                        fail(0, "Unknown binary operator");
+                        std::fill(v, v + count, 0.0);
+                        break;
+                }
+                break;
+
+            case NodeType::UNARY_OP:
+                if (node.op == OperatorType::NEGATIVE) {
+                    for (size_t l = 0; l < count; ++l) v[l] = -a[l];
+                } else {
+                    fail(0, "Unknown unary operator");
+                    std::fill(v, v + count, 0.0);
+                }
+                break;
+
+            case NodeType::FUNCTION_CALL:
+                switch(node.function) {
+                    case Function::SIN: for (size_t l = 0; l < count; ++l) v[l] = std::sin(a[l]); break;
+                    case Function::COS: for (size_t l = 0; l < count; ++l) v[l] = std::cos(a[l]); break;
+                    case Function::SQRT: {
+                        size_t lane = firstLane(count, [&](size_t l) { return a[l] < 0; });
+                        if (lane < count) fail(lane, "Square root of negative number");
+                        for (size_t l = 0; l < count; ++l) v[l] = std::sqrt(a[l]);
+                        break;
+                    }
+                    case Function::LOG: {
+                        size_t lane = firstLane(count, [&](size_t l) { return a[l] <= 0; });
+                        if (lane < count) fail(lane, "Log of non-positive number");
+                        for (size_t l = 0; l < count; ++l) v[l] = std::log(a[l]);
+                        break;
+                    }
+                    case Function::EXP: for (size_t l = 0; l < count; ++l) v[l] = std::exp(a[l]); break;
+                    case Function::ABS: for (size_t l = 0; l < count; ++l) v[l] = std::abs(a[l]); break;
+                    case Function::UNKNOWN:
+                        fail(0, "Unknown function or wrong number of arguments: " + functionNames[node.operand]);
+                        std::fill(v, v + count, 0.0);
+                        break;
+                }
+                break;
+        }
+    }
+    if (firstFailure < count) return firstFailure;
+
+    const double* result = values + (nodes.size() - 1) * count;
+    std::copy(result, result + count, output);
+
+    // Reverse sweep: a shared node sums the adjoints of all its uses
+    std::fill(adjoints, adjoints + nodes.size() * count, 0.0);
+    std::fill(adjoints + (nodes.size() - 1) * count, adjoints + nodes.size() * count, 1.0);
+    for (size_t slot = 0; slot < variables.size(); ++slot) {
+        std::fill(gradients[slot], gradients[slot] + count, 0.0);
+    }
+
+    for (size_t i = nodes.size(); i-- > 0;) {
+        const Node& node = nodes[i];
+        const double* g = adjoints + i * count;
+        const double* v = values + i * count;
+        const double* a = nullptr;
+        const double* b = nullptr;
+        double* ga = nullptr;
+        double* gb = nullptr;
+        if (node.childCount > 0) {
+            a = values + childIndices[node.firstChild] * count;
+            ga = adjoints + childIndices[node.firstChild] * count;
+        }
+        if (node.childCount > 1) {
+            b = values + childIndices[node.firstChild + 1] * count;
+            gb = adjoints + childIndices[node.firstChild + 1] * count;
+        }
+
+        switch(node.type) {
+            case NodeType::NUMBER:
+                break;
+
+            case NodeType::VARIABLE: {
+                double* gradient = gradients[node.operand];
+                for (size_t l = 0; l < count; ++l) gradient[l] += g[l];
+                break;
+            }
+
+            case NodeType::BINARY_OP:
+                switch(node.op) {
+                    case OperatorType::ADD:
+                        for (size_t l = 0; l < count; ++l) { ga[l] += g[l]; gb[l] += g[l]; }
+                        break;
+                    case OperatorType::SUBTRACT:
+                        for (size_t l = 0; l < count; ++l) { ga[l] += g[l]; gb[l] -= g[l]; }
+                        break;
+                    case OperatorType::MULTIPLY:
+                        for (size_t l = 0; l < count; ++l) { ga[l] += g[l] * b[l]; gb[l] += g[l] * a[l]; }
+                        break;
+                    case OperatorType::DIVIDE:
+                        for (size_t l = 0; l < count; ++l) { ga[l] += g[l] / b[l]; gb[l] -= g[l] * v[l] / b[l]; }
+                        break;
+                    case OperatorType::POWER:
+                        for (size_t l = 0; l < count; ++l) {
+                            if (b[l] != 0) ga[l] += g[l] * b[l] * std::pow(a[l], b[l] - 1);
+                            if (a[l] > 0) {
+                                gb[l] += g[l] * v[l] * std::log(a[l]);
+                            } else if (a[l] < 0 || b[l] <= 0) {
+                                gb[l] += std::numeric_limits<double>::quiet_NaN();
+                            }
+                        }
+                        break;
+                    default:
+                        break;
+                }
+                break;
+
+            case NodeType::UNARY_OP:
+                for (size_t l = 0; l < count; ++l) ga[l] -= g[l];
+                break;
+
+            case NodeType::FUNCTION_CALL:
+                switch(node.function) {
+                    case Function::SIN: for (size_t l = 0; l < count; ++l) ga[l] += g[l] * std::cos(a[l]); break;
+                    case Function::COS: for (size_t l = 0; l < count; ++l) ga[l] -= g[l] * std::sin(a[l]); break;
+                    case Function::SQRT: for (size_t l = 0; l < count; ++l) ga[l] += g[l] * 0.5 / v[l]; break;
+                    case Function::LOG: for (size_t l = 0; l < count; ++l) ga[l] += g[l] / a[l]; break;
+                    case Function::EXP: for (size_t l = 0; l < count; ++l) ga[l] += g[l] * v[l]; break;
+                    case Function::ABS:
+                        for (size_t l = 0; l < count; ++l) ga[l] += a[l] > 0 ? g[l] : (a[l] < 0 ? -g[l] : 0.0);
+                        break;
+                    case Function::UNKNOWN:
+                        break;
+                }
+                break;
+        }
+    }
+    return count;
+}
+
+static bool isZero(const ASTNodePtr& node) {
+    return node->type == NodeType::NUMBER && node->number.value == 0;
+}
+
+static bool isOne(const ASTNodePtr& node) {
+    return node->type == NodeType::NUMBER && node->number.value == 1;
+}
+
+// Builders that leave out the terms a zero or unit derivative makes trivial
+static ASTNodePtr sum(const ASTNodePtr& left, const ASTNodePtr& right) {
+    if (isZero(left)) return right;
+    if (isZero(right)) return left;
+    return ASTNode::createBinaryOp(OperatorType::ADD, left, right);
+}
+
+static ASTNodePtr negate(const ASTNodePtr& node) {
+    if (isZero(node)) return node;
+    return ASTNode::createUnaryOp(OperatorType::NEGATIVE, node);
+}
+
+static ASTNodePtr difference(const ASTNodePtr& left, const ASTNodePtr& right) {
+    if (isZero(right)) return left;
+    if (isZero(left)) return negate(right);
+    return ASTNode::createBinaryOp(OperatorType::SUBTRACT, left, right);
+}
+
+static ASTNodePtr product(const ASTNodePtr& left, const ASTNodePtr& right) {
+    if (isZero(left) || isZero(right)) return ASTNode::createNumber(0);
+    if (isOne(left)) return right;
+    if (isOne(right)) return left;
+    return ASTNode::createBinaryOp(OperatorType::MULTIPLY, left, right);
+}
+
+static ASTNodePtr quotient(const ASTNodePtr& left, const ASTNodePtr& right) {
+    if (isZero(left)) return left;
+    return ASTNode::createBinaryOp(OperatorType::DIVIDE, left, right);
+}
+
+static ASTNodePtr differentiate(const ASTNodePtr& node, const std::string& variable) {
+    switch(node->type) {
+        case NodeType::NUMBER:
+            return ASTNode::createNumber(0);
+
+        case NodeType::VARIABLE:
+            return ASTNode::createNumber(node->variable.name == variable ? 1 : 0);
+
+        case NodeType::BINARY_OP: {
+            const ASTNodePtr& a = node->op.left;
+            const ASTNodePtr& b = node->op.right;
+            ASTNodePtr da = differentiate(a, variable);
+            ASTNodePtr db = differentiate(b, variable);
+            switch(node->op.op) {
+                case OperatorType::ADD: return sum(da, db);
+                case OperatorType::SUBTRACT: return difference(da, db);
+                case OperatorType::MULTIPLY: return sum(product(da, b), product(a, db));
+                case OperatorType::DIVIDE:
+                    // da / b - a * db / (b * b)
+                    return difference(quotient(da, b), quotient(product(a, db), product(b, b)));
+                case OperatorType::POWER:
+                    if (isZero(db)) {
+                        // b * a ^ (b - 1) * da
+                        ASTNodePtr exponent = ASTNode::createBinaryOp(OperatorType::SUBTRACT, b,
+                                                                      ASTNode::createNumber(1));
+                        return product(product(b, ASTNode::createBinaryOp(OperatorType::POWER, a, exponent)), da);
+                    }
+                    if (isZero(da)) {
+                        // a ^ b * log(a) * db
+                        return product(product(node, ASTNode::createFunctionCall("log", {a})), db);
+                    }
+                    // a ^ b * (db * log(a) + b * da / a)
+                    return product(node, sum(product(db, ASTNode::createFunctionCall("log", {a})),
+                                             quotient(product(b, da), a)));
+                default:
+                    throw std::runtime_error("Unknown binary operator");
+            }
+        }
+
+        case NodeType::UNARY_OP:
+            if (node->op.op != OperatorType::NEGATIVE) throw std::runtime_error("Unknown unary operator");
+            return negate(differentiate(node->op.left, variable));
+
+        case NodeType::FUNCTION_CALL: {
+            const std::string& name = node->function.functionName;
+            if (node->function.arguments.size() != 1) {
+                throw std::runtime_error("Unknown function or wrong number of arguments: " + name);
+            }
+            const ASTNodePtr& a = node->function.arguments[0];
+            ASTNodePtr da = differentiate(a, variable);
+            if (name == "sin") return product(ASTNode::createFunctionCall("cos", {a}), da);
+            if (name == "cos") return negate(product(ASTNode::createFunctionCall("sin", {a}), da));
+            if (name == "sqrt") {
+                return quotient(da, ASTNode::createBinaryOp(OperatorType::MULTIPLY, ASTNode::createNumber(2), node));
+            }
+            if (name == "log") return quotient(da, a);
+            if (name == "exp") return product(node, da);
+            if (name == "abs") return product(quotient(a, node), da);
+            throw std::runtime_error("Unknown function or wrong number of arguments: " + name);
+        }
+    }
+    throw std::runtime_error("Unknown node type");
+}
+
+ASTNodePtr GradientEvaluator::derivative(const ASTNodePtr& ast, const std::string& variable) {
+    if (!ast) {
+        throw std::runtime_error("Cannot differentiate an empty AST");
+    }
+    return differentiate(ast, variable);
+}
@@ -0,0 +1,77 @@
+#ifndef GRADIENT_EVALUATOR_H
+#define GRADIENT_EVALUATOR_H
+
+#include "AST_NODE.h"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Value and gradient of an expression in one forward and one reverse sweep
+// (reverse-mode automatic differentiation). The tree is flattened once,
+// children first, with shared DAG nodes stored once; the forward sweep keeps
+// every node's value and the reverse sweep pushes adjoints back to the
+// variables. Values and errors are the same as ASTNode::evaluate.
+//
+// Derivatives at the edges of a function's domain: d|x|/dx is 0 at x = 0,
+// d(a^b)/da is 0 when b = 0, and d(a^b)/db is 0 for a = 0 and b > 0 and NaN
+// for a < 0 (or a = 0 and b <= 0).
+class GradientEvaluator {
+public:
+    explicit GradientEvaluator(const ASTNodePtr& ast);
+
+    // Variable names in gradient order (same as collectVariables())
+    const std::vector<std::string>& getVariables() const { return variables; }
+
+    // Value at `values` (one per variable); gradient[i] receives d/d getVariables()[i]
+    double evaluate(std::span<const double> values, std::span<double> gradient) const;
+    // Same with named variables; gradient is resized to getVariables().size()
+    double evaluate(const VariableMap& variables, std::vector<double>& gradient) const;
+
+    // Every row of the columns (as BatchEvaluator), BatchEvaluator::CHUNK_SIZE
+    // rows per sweep; gradients[i] receives the column of d/d getVariables()[i].
+    // Throws BatchEvaluationError for the lowest failing row.
+    void evaluate(const std::vector<std::span<const double>>& columns, std::span<double> output,
+                  const std::vector<std::span<double>>& gradients) const;
+
+    // Distinct nodes in the flattened tree
+    size_t getNodeCount() const { return nodes.size(); }
+
+    // Symbolic d(ast)/d(variable) as a new tree sharing subtrees with `ast`.
+    // Terms that are identically zero are left out; pass the result to
+    // ExpressionSimplifier to fold constants. d|x|/dx is written x / |x|, so it
+    // throws "Division by zero" at x = 0 where the sweep above gives 0.
+    // Throws std::runtime_error for anything but the built-in functions.
+    static ASTNodePtr derivative(const ASTNodePtr& ast, const std::string& variable);
+
+private:
+    enum class Function : std::uint8_t { SIN, COS, SQRT, LOG, EXP, ABS, UNKNOWN };
+
+    // Nodes are stored children first; the root is last
+    struct Node {
+        NodeType type;
+        OperatorType op;
+        Function function;
+        std::uint32_t firstChild;      // into childIndices
+        std::uint32_t childCount;
+        std::uint32_t operand;         // NUMBER: constant, VARIABLE: slot, FUNCTION_CALL: name
+    };
+
+    std::vector<Node> nodes;
+    std::vector<std::uint32_t> childIndices;
+    std::vector<double> constants;
+    std::vector<std::string> functionNames;
+    std::vector<std::string> variables;
+
+    std::uint32_t addNode(const ASTNode* node, std::unordered_map<const ASTNode*, std::uint32_t>& seen);
+
+    // Forward and reverse sweep over `count` lanes. values and adjoints hold
+    // count doubles per node; inputs[slot] and gradients[slot] point at the
+    // lanes' variable values and gradient outputs. defined (if set) marks the
+    // slots that have a value. Returns the first failing lane, or count.
+    size_t sweep(const double* const* inputs, const unsigned char* defined, size_t count, double* output,
+                 double* const* gradients, double* values, double* adjoints, std::string& errorMessage) const;
+};
+
+#endif // GRADIENT_EVALUATOR_H
@@ -0,0 +1,281 @@
+#include "HashConsBuilder.h"
+#include "ASTTraversal.h"
+#include <bit>
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+
+// Combine kind, operator, value, name and child addresses
+size_t HashConsBuilder::KeyHash::operator()(const Key& key) const {
+    size_t hash = std::hash<std::uint64_t>()(key.bits);
+    auto mix = [&hash](size_t value) { hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2); };
+    mix(static_cast<size_t>(key.type));
+    mix(static_cast<size_t>(key.op));
+    mix(std::hash<std::string>()(key.name));
+    for (const ASTNode* child : key.children) {
+        mix(std::hash<const ASTNode*>()(child));
+    }
+    return hash;
+}
+
+// Return the node stored under key, creating it on first use
+template <typename Create>
+ASTNodePtr HashConsBuilder::intern(Key&& key, Create&& create) {
+    ++totalNodes;
+    auto it = nodes.find(key);
+    if (it != nodes.end()) {
+        return it->second;
+    }
+    ASTNodePtr node = create();
+    nodes.emplace(std::move(key), node);
+    return node;
+}
+
+// Numbers match by bit pattern, so 0 and -0 stay distinct
+ASTNodePtr HashConsBuilder::number(double value) {
+    return intern(Key{NodeType::NUMBER, OperatorType::NONE, std::bit_cast<std::uint64_t>(value), {}, {}},
+                  [&] { return ASTNode::createNumber(value); });
+}
+
+ASTNodePtr HashConsBuilder::variable(const std::string& name) {
+    return intern(Key{NodeType::VARIABLE, OperatorType::NONE, 0, name, {}},
+                  [&] { return ASTNode::createVariable(name); });
+}
+
+ASTNodePtr HashConsBuilder::binaryOp(OperatorType op, const ASTNodePtr& left, const ASTNodePtr& right) {
+    return intern(Key{NodeType::BINARY_OP, op, 0, {}, {left.get(), right.get()}},
+                  [&] { return ASTNode::createBinaryOp(op, left, right); });
+}
+
+ASTNodePtr HashConsBuilder::unaryOp(OperatorType op, const ASTNodePtr& operand) {
+    return intern(Key{NodeType::UNARY_OP, op, 0, {}, {operand.get()}},
+                  [&] { return ASTNode::createUnaryOp(op, operand); });
+}
+
+ASTNodePtr HashConsBuilder::functionCall(const std::string& funcName, const std::vector<ASTNodePtr>& args) {
+    Key key{NodeType::FUNCTION_CALL, OperatorType::NONE, 0, funcName, {}};
+    key.children.reserve(args.size());
+    for (const auto& arg : args) {
+        key.children.push_back(arg.get());
+    }
+    return intern(std::move(key), [&] { return ASTNode::createFunctionCall(funcName, args); });
+}
+
+// Forget all nodes
+void HashConsBuilder::clear() {
+    nodes.clear();
+    totalNodes = 0;
+}
+
+// Deduplicate a tree
+ASTNodePtr HashConsBuilder::build(const ASTNodePtr& ast) {
+    if (!ast) {
+        throw std::runtime_error("Cannot build an empty AST");
+    }
+    // Input nodes reached twice (the input is already a DAG) are rebuilt once
+    std::unordered_map<const ASTNode*, Built> built;
+    return buildNode(ast, built).node;
+}
+
+// Rebuild children first so their shared nodes form the parent's key
+HashConsBuilder::Built HashConsBuilder::buildNode(const ASTNodePtr& node,
+                                                  std::unordered_map<const ASTNode*, Built>& built) {
+    auto it = built.find(node.get());
+    if (it != built.end()) {
+        totalNodes += it->second.treeSize;
+        return it->second;
+    }
+
+    Built result{nullptr, 1};
+    switch(node->type) {
+        case NodeType::NUMBER:
+            result.node = number(node->number.value);
+            break;
+
+        case NodeType::VARIABLE:
+            result.node = variable(node->variable.name);
+            break;
+
+        case NodeType::BINARY_OP: {
+            Built left = buildNode(node->op.left, built);
+            Built right = buildNode(node->op.right, built);
+            result.node = binaryOp(node->op.op, left.node, right.node);
+            result.treeSize += left.treeSize + right.treeSize;
+            break;
+        }
+
+        case NodeType::UNARY_OP: {
+            Built operand = buildNode(node->op.left, built);
+            result.node = unaryOp(node->op.op, operand.node);
+            result.treeSize += operand.treeSize;
+            break;
+        }
+
+        case NodeType::FUNCTION_CALL: {
+            std::vector<ASTNodePtr> args;
+            args.reserve(node->function.arguments.size());
+            for (const auto& arg : node->function.arguments) {
+                Built child = buildNode(arg, built);
+                args.push_back(child.node);
+                result.treeSize += child.treeSize;
+            }
+            result.node = functionCall(node->function.functionName, args);
+            break;
+        }
+    }
+
+    built.emplace(node.get(), result);
+    return result;
+}
+
+// Count parents of every operator and function node, descending into each node once
+static void countParents(const ASTNode* node, std::unordered_map<const ASTNode*, size_t>& parents) {
+    auto visitChild = [&parents](const ASTNode* child) {
+        if (child->type == NodeType::NUMBER || child->type == NodeType::VARIABLE) return;
+        if (parents[child]++ == 0) countParents(child, parents);
+    };
+    switch(node->type) {
+        case NodeType::BINARY_OP:
+            visitChild(node->op.left.get());
+            visitChild(node->op.right.get());
+            break;
+        case NodeType::UNARY_OP:
+            visitChild(node->op.left.get());
+            break;
+        case NodeType::FUNCTION_CALL:
+            for (const auto& arg : node->function.arguments) visitChild(arg.get());
+            break;
+        default:
+            break;
+    }
+}
+
+// Operator and function nodes with more than one parent
+std::unordered_set<const ASTNode*> HashConsBuilder::findSharedNodes(const ASTNodePtr& dag) {
+    std::unordered_map<const ASTNode*, size_t> parents;
+    countParents(dag.get(), parents);
+
+    std::unordered_set<const ASTNode*> shared;
+    for (const auto& [node, count] : parents) {
+        if (count > 1) shared.insert(node);
+    }
+    return shared;
+}
+
+std::unordered_set<const ASTNode*> HashConsBuilder::findSharedNodes(const std::vector<ASTNodePtr>& dags) {
+    std::unordered_map<const ASTNode*, size_t> parents;
+    for (const auto& dag : dags) {
+        const ASTNode* root = dag.get();
+        if (root->type == NodeType::NUMBER || root->type == NodeType::VARIABLE) continue;
+        if (parents[root]++ == 0) countParents(root, parents);
+    }
+
+    std::unordered_set<const ASTNode*> shared;
+    for (const auto& [node, count] : parents) {
+        if (count > 1) shared.insert(node);
+    }
+    return shared;
+}
+
+DagEvaluator::DagEvaluator(const ASTNodePtr& dag) : dag(dag) {
+    // Step index of every node flattened so far; a node reached again is not
+    // descended into a second time
+    std::unordered_map<const ASTNode*, std::uint32_t> index;
+    ASTTraversal::walk(*dag, [&](const TraversalStep& step) {
+        return index.count(step.node) ? Visit::SKIP_CHILDREN : Visit::CONTINUE;
+    }, [&](const TraversalStep& step) {
+        const ASTNode* node = step.node;
+        if (index.count(node)) return;
+
+        Step entry{node, Function::UNKNOWN, static_cast<std::uint32_t>(children.size()),
+                   static_cast<std::uint32_t>(ASTTraversal::childCount(*node))};
+        for (size_t i = 0; i < entry.childCount; ++i) children.push_back(index.at(ASTTraversal::child(*node, i)));
+
+        if (node->type == NodeType::FUNCTION_CALL && entry.childCount == 1) {
+            // Same dispatch as ASTNode::evaluate: single-argument built-ins only
+            static const char* names[] = {"sin", "cos", "sqrt", "log", "exp", "abs"};
+            for (size_t f = 0; f < std::size(names); ++f) {
+                if (node->function.functionName == names[f]) entry.function = static_cast<Function>(f);
+            }
+        }
+        index.emplace(node, static_cast<std::uint32_t>(steps.size()));
+        steps.push_back(entry);
+    });
+    values.resize(steps.size());
+}
+
+// One pass over the distinct nodes; the first error in visiting order is thrown
+double DagEvaluator::evaluate(const VariableMap& variables) {
+    for (size_t i = 0; i < steps.size(); ++i) {
+        const Step& step = steps[i];
+        const ASTNode* node = step.node;
+        const std::uint32_t* args = children.data() + step.firstChild;
+        double result;
+        switch(node->type) {
+            case NodeType::NUMBER:
+                result = node->number.value;
+                break;
+
+            case NodeType::VARIABLE: {
+                auto it = variables.find(node->variable.name);
+                if (it == variables.end()) throw std::runtime_error("Undefined variable: " + node->variable.name);
+                result = it->second;
+                break;
+            }
+
+            case NodeType::BINARY_OP: {
+                double leftVal = values[args[0]];
+                double rightVal = values[args[1]];
+                switch(node->op.op) {
+                    case OperatorType::ADD: result = leftVal + rightVal; break;
+                    case OperatorType::SUBTRACT: result = leftVal - rightVal; break;
+                    case OperatorType::MULTIPLY: result = leftVal * rightVal; break;
+                    case OperatorType::DIVIDE:
+                        if (rightVal == 0) throw std::runtime_error("Division by zero");
+                        result = leftVal / rightVal;
+                        break;
+                    case OperatorType::POWER: result = std::pow(leftVal, rightVal); break;
+                    default: throw std::runtime_error("Unknown binary operator");
+                }
+                break;
+            }
+
+            case NodeType::UNARY_OP:
+                if (node->op.op != OperatorType::NEGATIVE) throw std::runtime_error("Unknown unary operator");
+                result = -values[args[0]];
+                break;
+
+            case NodeType::FUNCTION_CALL: {
+                double arg = step.childCount ? values[args[0]] : 0;
+                switch(step.function) {
+                    case Function::SIN: result = std::sin(arg); break;
+                    case Function::COS: result = std::cos(arg); break;
+                    case Function::SQRT:
+                        if (arg < 0) throw std::runtime_error("Square root of negative number");
+                        result = std::sqrt(arg);
+                        break;
+                    case Function::LOG:
+                        if (arg <= 0) throw std::runtime_error("Log of non-positive number");
+                        result = std::log(arg);
+                        break;
+                    case Function::EXP: result = std::exp(arg); break;
+                    case Function::ABS: result = std::abs(arg); break;
+                    default:
+                        throw std::runtime_error("Unknown function or wrong number of arguments: " +
+                                                 node->function.functionName);
+                }
+                break;
+            }
+
+            default:
+                throw std::runtime_error("Unknown node type");
+        }
+        values[i] = result;
+    }
+    return values.back();
+}
+
+// Evaluate a DAG, computing each shared node once
+double HashConsBuilder::evaluate(const ASTNodePtr& dag, const VariableMap& variables) {
+    return DagEvaluator(dag).evaluate(variables);
+}
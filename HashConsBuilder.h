@@ -0,0 +1,107 @@
+#ifndef HASH_CONS_BUILDER_H
+#define HASH_CONS_BUILDER_H
+
+#include "AST_NODE.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Builds ASTs in which structurally identical subtrees are one shared node,
+// turning trees into DAGs. Nodes are never modified after construction, so
+// toString, print and the other tree functions work on the result unchanged.
+class HashConsBuilder {
+public:
+    // Deduplicate a tree (or DAG) against every node built so far
+    ASTNodePtr build(const ASTNodePtr& ast);
+
+    // Node factories that return the existing node when one matches
+    ASTNodePtr number(double value);
+    ASTNodePtr variable(const std::string& name);
+    ASTNodePtr binaryOp(OperatorType op, const ASTNodePtr& left, const ASTNodePtr& right);
+    ASTNodePtr unaryOp(OperatorType op, const ASTNodePtr& operand);
+    ASTNodePtr functionCall(const std::string& funcName, const std::vector<ASTNodePtr>& args);
+
+    // Statistics: distinct nodes held versus nodes requested (tree size of
+    // every build() input plus one per factory call)
+    size_t getUniqueNodes() const { return nodes.size(); }
+    size_t getTotalNodes() const { return totalNodes; }
+
+    // Forget all nodes; DAGs already built stay valid
+    void clear();
+
+    // Same results and errors as ASTNode::evaluate, but a node reached through
+    // several parents is computed only once per call. Flattens the DAG on every
+    // call; use a DagEvaluator to evaluate the same DAG repeatedly.
+    static double evaluate(const ASTNodePtr& dag, const VariableMap& variables = {});
+
+    // Operator and function nodes with more than one parent
+    static std::unordered_set<const ASTNode*> findSharedNodes(const ASTNodePtr& dag);
+
+    // Same over several DAGs, each root counting as one parent: nodes used by
+    // more than one expression, or more than once in one
+    static std::unordered_set<const ASTNode*> findSharedNodes(const std::vector<ASTNodePtr>& dags);
+
+private:
+    // Node identity: kind, operator, value bits or name, canonical children
+    struct Key {
+        NodeType type;
+        OperatorType op;
+        std::uint64_t bits;
+        std::string name;
+        std::vector<const ASTNode*> children;
+
+        bool operator==(const Key& other) const = default;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    // Shared node and tree size of an input node already seen by build()
+    struct Built {
+        ASTNodePtr node;
+        size_t treeSize;
+    };
+
+    std::unordered_map<Key, ASTNodePtr, KeyHash> nodes;
+    size_t totalNodes = 0;
+
+    template <typename Create>
+    ASTNodePtr intern(Key&& key, Create&& create);
+    Built buildNode(const ASTNodePtr& node, std::unordered_map<const ASTNode*, Built>& built);
+};
+
+// Evaluates one DAG many times. The constructor flattens the DAG once into its
+// distinct nodes, children before parents in ASTNode::evaluate's visiting
+// order, so each call is a linear pass that computes every node once, shared
+// or not. Calls hash only the variable names and reuse one value buffer, so an
+// evaluator must not be shared between threads.
+class DagEvaluator {
+public:
+    explicit DagEvaluator(const ASTNodePtr& dag);
+
+    // Same results and errors as ASTNode::evaluate
+    double evaluate(const VariableMap& variables = {});
+
+    // Distinct nodes, each computed once per call
+    size_t getNodeCount() const { return steps.size(); }
+
+private:
+    enum class Function : std::uint8_t { SIN, COS, SQRT, LOG, EXP, ABS, UNKNOWN };
+
+    struct Step {
+        const ASTNode* node;
+        Function function;             // FUNCTION_CALL only
+        std::uint32_t firstChild;      // into children
+        std::uint32_t childCount;
+    };
+
+    ASTNodePtr dag;                    // keeps the nodes alive
+    std::vector<Step> steps;
+    std::vector<std::uint32_t> children;   // step indices
+    std::vector<double> values;            // one per step
+};
+
+#endif // HASH_CONS_BUILDER_H
@@ -0,0 +1,254 @@
+#include "IncrementalEvaluator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+IncrementalEvaluator::IncrementalEvaluator(const ASTNodePtr& ast, const VariableMap& initial)
+    : messages{"Division by zero", "Square root of negative number", "Log of non-positive number",
+               "Unknown binary operator", "Unknown unary operator"} {
+    if (!ast) {
+        throw std::runtime_error("Cannot evaluate an empty AST");
+    }
+
+    variables = ast->collectVariables();
+    slots.assign(variables.size(), 0.0);
+    defined.assign(variables.size(), 0);
+    readers.resize(variables.size());
+    for (const auto& name : variables) {
+        undefinedErrors.push_back(addMessage("Undefined variable: " + name));
+    }
+    for (size_t slot = 0; slot < variables.size(); ++slot) {
+        auto it = initial.find(variables[slot]);
+        if (it != initial.end()) {
+            slots[slot] = it->second;
+            defined[slot] = 1;
+        }
+    }
+
+    // Flatten children first; a node reached through several parents is added once
+    std::unordered_map<const ASTNode*, std::uint32_t> seen;
+    std::vector<std::vector<std::uint32_t>> parents;
+    addNode(ast.get(), seen, parents);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        nodes[i].firstParent = static_cast<std::uint32_t>(parentIndices.size());
+        nodes[i].parentCount = static_cast<std::uint32_t>(parents[i].size());
+        parentIndices.insert(parentIndices.end(), parents[i].begin(), parents[i].end());
+    }
+    // The first result() computes every node
+    queued.assign(nodes.size(), 0);
+    pending.resize(heights.back() + 1);
+    lowestPending = pending.size();
+    for (std::uint32_t i = 0; i < nodes.size(); ++i) enqueue(i);
+}
+
+std::uint32_t IncrementalEvaluator::addMessage(const std::string& message) {
+    auto it = std::find(messages.begin(), messages.end(), message);
+    if (it != messages.end()) {
+        return static_cast<std::uint32_t>(it - messages.begin());
+    }
+    messages.push_back(message);
+    return static_cast<std::uint32_t>(messages.size() - 1);
+}
+
+std::uint32_t IncrementalEvaluator::addNode(const ASTNode* node,
+                                            std::unordered_map<const ASTNode*, std::uint32_t>& seen,
+                                            std::vector<std::vector<std::uint32_t>>& parents) {
+    auto found = seen.find(node);
+    if (found != seen.end()) return found->second;
+
+    std::vector<std::uint32_t> children;
+    switch(node->type) {
+        case NodeType::BINARY_OP:
+            children.push_back(addNode(node->op.left.get(), seen, parents));
+            children.push_back(addNode(node->op.right.get(), seen, parents));
+            break;
+        case NodeType::UNARY_OP:
+            children.push_back(addNode(node->op.left.get(), seen, parents));
+            break;
+        case NodeType::FUNCTION_CALL:
+            for (const auto& arg : node->function.arguments) {
+                children.push_back(addNode(arg.get(), seen, parents));
+            }
+            break;
+        default:
+            break;
+    }
+
+    Node entry{};
+    entry.type = node->type;
+    entry.op = OperatorType::NONE;
+    entry.function = Function::UNKNOWN;
+    entry.firstChild = static_cast<std::uint32_t>(childIndices.size());
+    entry.childCount = static_cast<std::uint32_t>(children.size());
+    entry.error = NO_ERROR;
+    childIndices.insert(childIndices.end(), children.begin(), children.end());
+
+    std::uint32_t index = static_cast<std::uint32_t>(nodes.size());
+    switch(node->type) {
+        case NodeType::NUMBER:
+            entry.value = node->number.value;
+            break;
+        case NodeType::VARIABLE: {
+            auto it = std::lower_bound(variables.begin(), variables.end(), node->variable.name);
+            entry.operand = static_cast<std::uint32_t>(it - variables.begin());
+            readers[entry.operand].push_back(index);
+            break;
+        }
+        case NodeType::BINARY_OP:
+        case NodeType::UNARY_OP:
+            entry.op = node->op.op;
+            break;
+        case NodeType::FUNCTION_CALL: {
+            // Same dispatch as ASTNode::evaluate: single-argument built-ins only
+            static const char* names[] = {"sin", "cos", "sqrt", "log", "exp", "abs"};
+            const std::string& name = node->function.functionName;
+            if (children.size() == 1) {
+                for (size_t f = 0; f < std::size(names); ++f) {
+                    if (name == names[f]) entry.function = static_cast<Function>(f);
+                }
+            }
+            if (entry.function == Function::UNKNOWN) {
+                entry.operand = addMessage("Unknown function or wrong number of arguments: " + name);
+            }
+            break;
+        }
+    }
+
+    std::uint32_t height = 0;
+    for (std::uint32_t child : children) height = std::max(height, heights[child] + 1);
+
+    nodes.push_back(entry);
+    heights.push_back(height);
+    parents.emplace_back();
+    for (std::uint32_t child : children) {
+        // A child used twice by one parent (x * x) still lists that parent once
+        if (parents[child].empty() || parents[child].back() != index) parents[child].push_back(index);
+    }
+    seen.emplace(node, index);
+    return index;
+}
+
+size_t IncrementalEvaluator::slotOf(const std::string& name) const {
+    auto it = std::lower_bound(variables.begin(), variables.end(), name);
+    return (it != variables.end() && *it == name) ? static_cast<size_t>(it - variables.begin()) : NOT_FOUND;
+}
+
+bool IncrementalEvaluator::set(const std::string& name, double value) {
+    size_t slot = slotOf(name);
+    if (slot == NOT_FOUND) return false;
+    set(slot, value);
+    return true;
+}
+
+void IncrementalEvaluator::set(size_t slot, double value) {
+    if (slot >= slots.size()) {
+        throw std::runtime_error("Variable slot " + std::to_string(slot) + " out of range");
+    }
+    if (defined[slot] && std::memcmp(&slots[slot], &value, sizeof(double)) == 0) return;
+    slots[slot] = value;
+    defined[slot] = 1;
+    for (std::uint32_t reader : readers[slot]) enqueue(reader);
+}
+
+void IncrementalEvaluator::enqueue(std::uint32_t index) {
+    if (queued[index]) return;
+    queued[index] = 1;
+    size_t height = heights[index];
+    pending[height].push_back(index);
+    lowestPending = std::min(lowestPending, height);
+    highestPending = std::max(highestPending, height);
+}
+
+double IncrementalEvaluator::result() {
+    // A node's parents are all higher, so they are queued before their bucket is reached
+    lastRecomputed = 0;
+    for (size_t height = lowestPending; height <= highestPending; ++height) {
+        for (std::uint32_t index : pending[height]) {
+            queued[index] = 0;
+            Node& node = nodes[index];
+            ++lastRecomputed;
+            if (recompute(node)) {
+                for (std::uint32_t i = 0; i < node.parentCount; ++i) {
+                    enqueue(parentIndices[node.firstParent + i]);
+                }
+            }
+        }
+        pending[height].clear();
+    }
+    lowestPending = pending.size();
+    highestPending = 0;
+    totalRecomputed += lastRecomputed;
+
+    const Node& root = nodes.back();
+    if (root.error != NO_ERROR) {
+        throw std::runtime_error(messages[root.error]);
+    }
+    return root.value;
+}
+
+// Recompute one node from its children's cached state; returns whether its
+// value (bit for bit) or its error changed
+bool IncrementalEvaluator::recompute(Node& node) {
+    const std::uint32_t* children = childIndices.data() + node.firstChild;
+    double value = 0;
+    std::uint32_t error = NO_ERROR;
+
+    // As in ASTNode::evaluate, the first failing operand's error wins
+    for (std::uint32_t i = 0; i < node.childCount && error == NO_ERROR; ++i) {
+        error = nodes[children[i]].error;
+    }
+
+    if (error == NO_ERROR) {
+        auto arg = [&](std::uint32_t i) { return nodes[children[i]].value; };
+
+        switch(node.type) {
+            case NodeType::NUMBER:
+                return false;
+            case NodeType::VARIABLE:
+                if (defined[node.operand]) value = slots[node.operand];
+                else error = undefinedErrors[node.operand];
+                break;
+            case NodeType::BINARY_OP:
+                switch(node.op) {
+                    case OperatorType::ADD: value = arg(0) + arg(1); break;
+                    case OperatorType::SUBTRACT: value = arg(0) - arg(1); break;
+                    case OperatorType::MULTIPLY: value = arg(0) * arg(1); break;
+                    case OperatorType::DIVIDE:
+                        if (arg(1) == 0) error = DIVISION_BY_ZERO;
+                        else value = arg(0) / arg(1);
+                        break;
+                    case OperatorType::POWER: value = std::pow(arg(0), arg(1)); break;
+                    default: error = UNKNOWN_BINARY; break;
+                }
+                break;
+            case NodeType::UNARY_OP:
+                if (node.op == OperatorType::NEGATIVE) value = -arg(0);
+                else error = UNKNOWN_UNARY;
+                break;
+            case NodeType::FUNCTION_CALL:
+                switch(node.function) {
+                    case Function::SIN: value = std::sin(arg(0)); break;
+                    case Function::COS: value = std::cos(arg(0)); break;
+                    case Function::SQRT:
+                        if (arg(0) < 0) error = NEGATIVE_SQRT;
+                        else value = std::sqrt(arg(0));
+                        break;
+                    case Function::LOG:
+                        if (arg(0) <= 0) error = NON_POSITIVE_LOG;
+                        else value = std::log(arg(0));
+                        break;
+                    case Function::EXP: value = std::exp(arg(0)); break;
+                    case Function::ABS: value = std::abs(arg(0)); break;
+                    case Function::UNKNOWN: error = node.operand; break;
+                }
+                break;
+        }
+    }
+
+    bool changed = error != node.error || std::memcmp(&value, &node.value, sizeof(double)) != 0;
+    node.value = value;
+    node.error = error;
+    return changed;
+}
@@ -0,0 +1,92 @@
+#ifndef INCREMENTAL_EVALUATOR_H
+#define INCREMENTAL_EVALUATOR_H
+
+#include "AST_NODE.h"
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Stateful evaluator for inputs that change a few at a time. Every node keeps
+// its last value (or error); set() queues the nodes that read the variable,
+// and result() recomputes queued nodes level by level from the leaves up, queuing a node's
+// parents only when its value or error actually changed. Results and errors
+// are the same as ASTNode::evaluate with the current assignment.
+class IncrementalEvaluator {
+public:
+    static constexpr size_t NOT_FOUND = std::numeric_limits<size_t>::max();
+
+    // Variables missing from `initial` stay undefined until set
+    explicit IncrementalEvaluator(const ASTNodePtr& ast, const VariableMap& initial = {});
+
+    // Assign a variable; returns false if the expression does not use it
+    bool set(const std::string& name, double value);
+    // Same by slot (see getVariables() / slotOf()), without the name lookup
+    void set(size_t slot, double value);
+
+    // Current value; throws std::runtime_error with the ASTNode::evaluate message
+    double result();
+
+    // Variable names in slot order (same as collectVariables())
+    const std::vector<std::string>& getVariables() const { return variables; }
+    size_t slotOf(const std::string& name) const;
+
+    // Distinct nodes (shared DAG nodes count once)
+    size_t getNodeCount() const { return nodes.size(); }
+    // Nodes recomputed by the last result() call, and over the evaluator's lifetime
+    size_t getLastRecomputed() const { return lastRecomputed; }
+    std::uint64_t getTotalRecomputed() const { return totalRecomputed; }
+
+private:
+    static constexpr std::uint32_t NO_ERROR = std::numeric_limits<std::uint32_t>::max();
+
+    // Fixed messages, first in `messages`
+    enum : std::uint32_t { DIVISION_BY_ZERO, NEGATIVE_SQRT, NON_POSITIVE_LOG, UNKNOWN_BINARY, UNKNOWN_UNARY };
+
+    enum class Function : std::uint8_t { SIN, COS, SQRT, LOG, EXP, ABS, UNKNOWN };
+
+    // Nodes are stored children first
+    struct Node {
+        NodeType type;
+        OperatorType op;
+        Function function;
+        std::uint32_t firstChild;      // into childIndices
+        std::uint32_t childCount;
+        std::uint32_t firstParent;     // into parentIndices
+        std::uint32_t parentCount;
+        std::uint32_t operand;         // VARIABLE: slot; UNKNOWN function: message
+        double value;
+        std::uint32_t error;           // message index or NO_ERROR
+    };
+
+    std::vector<Node> nodes;
+    std::vector<std::uint32_t> childIndices;
+    std::vector<std::uint32_t> parentIndices;
+    std::vector<std::string> messages;
+
+    std::vector<std::string> variables;
+    std::vector<double> slots;
+    std::vector<unsigned char> defined;
+    std::vector<std::vector<std::uint32_t>> readers;   // slot -> VARIABLE nodes
+    std::vector<std::uint32_t> undefinedErrors;        // slot -> message
+
+    // Nodes waiting for recomputation, bucketed by height (leaves 0, parents
+    // above all their children) so each bucket only depends on lower ones
+    std::vector<std::uint32_t> heights;
+    std::vector<std::vector<std::uint32_t>> pending;
+    std::vector<unsigned char> queued;
+    size_t lowestPending = 0;
+    size_t highestPending = 0;
+
+    size_t lastRecomputed = 0;
+    std::uint64_t totalRecomputed = 0;
+
+    std::uint32_t addNode(const ASTNode* node, std::unordered_map<const ASTNode*, std::uint32_t>& seen,
+                          std::vector<std::vector<std::uint32_t>>& parents);
+    std::uint32_t addMessage(const std::string& message);
+    void enqueue(std::uint32_t index);
+    bool recompute(Node& node);
+};
+
+#endif // INCREMENTAL_EVALUATOR_H
@@ -0,0 +1,230 @@
+#include "InfixParser.h"
+#include "PostfixToAST.h"
+#include <charconv>
+#include <cctype>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Builds shared_ptr nodes
+struct SharedNodeBuilder {
+    using Node = ASTNodePtr;
+
+    Node number(double value) { return ASTNode::createNumber(value); }
+    Node variable(std::string_view name) { return ASTNode::createVariable(std::string(name)); }
+    Node binary(OperatorType op, Node left, Node right) {
+        return ASTNode::createBinaryOp(op, std::move(left), std::move(right));
+    }
+    Node unary(OperatorType op, Node operand) { return ASTNode::createUnaryOp(op, std::move(operand)); }
+    Node call(std::string_view name, const std::vector<Node>& args) {
+        return ASTNode::createFunctionCall(std::string(name), args);
+    }
+};
+
+// Builds nodes inside an ExpressionArena
+struct ArenaNodeBuilder {
+    using Node = const ArenaNode*;
+    ExpressionArena& arena;
+
+    Node number(double value) { return arena.createNumber(value); }
+    Node variable(std::string_view name) { return arena.createVariable(name); }
+    Node binary(OperatorType op, Node left, Node right) { return arena.createBinaryOp(op, left, right); }
+    Node unary(OperatorType op, Node operand) { return arena.createUnaryOp(op, operand); }
+    Node call(std::string_view name, const std::vector<Node>& args) {
+        return arena.createFunctionCall(name, args);
+    }
+};
+
+// Recursive-descent / precedence-climbing parser over a string_view. The
+// first error is kept in `error` and every parse step returns an empty node
+// from then on, so nothing throws.
+template <typename Builder>
+class InfixParserImpl {
+public:
+    using Node = typename Builder::Node;
+
+    InfixParserImpl(std::string_view text, Builder builder) : text(text), builder(builder) {}
+
+    Expected<Node, ParseError> parseAll() {
+        Node node = parseExpression(1);
+        if (!failed()) {
+            skipSpaces();
+            if (pos < text.size()) {
+                if (text[pos] == ')') fail(ErrorCode::MISMATCHED_PARENTHESES, "Mismatched parentheses");
+                else unexpected();
+            }
+        }
+        if (failed()) return Unexpected(std::move(error));
+        return node;
+    }
+
+private:
+    std::string_view text;
+    Builder builder;
+    size_t pos = 0;
+    ParseError error;
+
+    // Unary minus sits between * / and ^, as in ASTNode::getPrecedence
+    static constexpr int unaryPrecedence = 3;
+
+    bool failed() const { return error.code != ErrorCode::NONE; }
+
+    Node fail(ErrorCode code, std::string message) {
+        if (!failed()) error = {code, std::move(message)};
+        return Node{};
+    }
+
+    void skipSpaces() {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+    }
+
+    Node unexpected() {
+        if (pos >= text.size()) {
+            return fail(ErrorCode::UNEXPECTED_END, "Unexpected end of expression");
+        }
+        return fail(ErrorCode::INVALID_CHARACTER, std::string("Unexpected character '") + text[pos] +
+                                                  "' at position " + std::to_string(pos));
+    }
+
+    // Binary operator at the cursor, or NONE
+    OperatorType peekBinaryOperator() {
+        skipSpaces();
+        if (pos >= text.size()) return OperatorType::NONE;
+        switch(text[pos]) {
+            case '+': return OperatorType::ADD;
+            case '-': return OperatorType::SUBTRACT;
+            case '*': return OperatorType::MULTIPLY;
+            case '/': return OperatorType::DIVIDE;
+            case '^': return OperatorType::POWER;
+            default: return OperatorType::NONE;
+        }
+    }
+
+    // Left-associative binary operators with precedence >= minPrecedence;
+    // chains are built in a loop, so long sums do not recurse
+    Node parseExpression(int minPrecedence) {
+        Node left = parseUnary();
+        if (failed()) return Node{};
+        for (;;) {
+            OperatorType op = peekBinaryOperator();
+            if (op == OperatorType::NONE) break;
+            int precedence = ASTNode::getPrecedence(op);
+            if (precedence < minPrecedence) break;
+            ++pos;
+            Node right = parseExpression(precedence + 1);
+            if (failed()) return Node{};
+            left = builder.binary(op, std::move(left), std::move(right));
+        }
+        return left;
+    }
+
+    Node parseUnary() {
+        skipSpaces();
+        if (pos < text.size() && text[pos] == '-') {
+            ++pos;
+            Node operand = parseExpression(unaryPrecedence + 1);
+            if (failed()) return Node{};
+            return builder.unary(OperatorType::NEGATIVE, std::move(operand));
+        }
+        return parsePrimary();
+    }
+
+    Node parsePrimary() {
+        skipSpaces();
+        if (pos >= text.size()) return unexpected();
+
+        char c = text[pos];
+        if (c == '(') {
+            ++pos;
+            Node node = parseExpression(1);
+            if (failed()) return Node{};
+            skipSpaces();
+            if (pos >= text.size() || text[pos] != ')') {
+                return fail(ErrorCode::MISMATCHED_PARENTHESES, "Mismatched parentheses");
+            }
+            ++pos;
+            return node;
+        }
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            return parseNumber();
+        }
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            return parseIdentifier();
+        }
+        return unexpected();
+    }
+
+    Node parseNumber() {
+        double value = 0;
+        auto [end, status] = std::from_chars(text.data() + pos, text.data() + text.size(), value);
+        if (status != std::errc()) {
+            return fail(ErrorCode::INVALID_NUMBER, "Invalid number at position " + std::to_string(pos));
+        }
+        pos = end - text.data();
+        return builder.number(value);
+    }
+
+    Node parseIdentifier() {
+        size_t start = pos;
+        while (pos < text.size() &&
+               (std::isalnum(static_cast<unsigned char>(text[pos])) || text[pos] == '_')) {
+            ++pos;
+        }
+        std::string_view name = text.substr(start, pos - start);
+
+        skipSpaces();
+        if (pos >= text.size() || text[pos] != '(') {
+            return builder.variable(name);
+        }
+
+        if (!PostfixToAST::isFunction(name)) {
+            return fail(ErrorCode::UNKNOWN_FUNCTION, "Unknown function: " + std::string(name));
+        }
+        ++pos;
+
+        std::vector<Node> args;
+        skipSpaces();
+        if (pos < text.size() && text[pos] == ')') {
+            ++pos;
+            return builder.call(name, args);
+        }
+        for (;;) {
+            args.push_back(parseExpression(1));
+            if (failed()) return Node{};
+            skipSpaces();
+            if (pos < text.size() && text[pos] == ',') {
+                ++pos;
+                continue;
+            }
+            if (pos < text.size() && text[pos] == ')') {
+                ++pos;
+                break;
+            }
+            if (pos >= text.size()) return fail(ErrorCode::MISMATCHED_PARENTHESES, "Mismatched parentheses");
+            return unexpected();
+        }
+        return builder.call(name, args);
+    }
+};
+
+// Parse into a shared_ptr tree
+ASTNodePtr InfixParser::parse(std::string_view infix) {
+    auto ast = tryParse(infix);
+    if (!ast) throw std::runtime_error(ast.error().message);
+    return *ast;
+}
+
+// Parse into an arena
+const ArenaNode* InfixParser::parse(std::string_view infix, ExpressionArena& arena) {
+    auto ast = tryParse(infix, arena);
+    if (!ast) throw std::runtime_error(ast.error().message);
+    return *ast;
+}
+
+Expected<ASTNodePtr, ParseError> InfixParser::tryParse(std::string_view infix) {
+    return InfixParserImpl<SharedNodeBuilder>(infix, SharedNodeBuilder{}).parseAll();
+}
+
+Expected<const ArenaNode*, ParseError> InfixParser::tryParse(std::string_view infix, ExpressionArena& arena) {
+    return InfixParserImpl<ArenaNodeBuilder>(infix, ArenaNodeBuilder{arena}).parseAll();
+}
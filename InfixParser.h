@@ -0,0 +1,29 @@
+#ifndef INFIX_PARSER_H
+#define INFIX_PARSER_H
+
+#include "AST_NODE.h"
+#include "ExpressionArena.h"
+#include "Expected.h"
+#include <string_view>
+
+// Single-pass infix parser (precedence climbing) that builds the AST directly,
+// without an intermediate postfix string, token vector or console output.
+//
+// Grammar: + - * / ^ (all left-associative, same as InfixToPostfix), unary
+// minus, parentheses, decimal numbers, identifiers and calls to the functions
+// known to PostfixToAST, e.g. "sqrt(x^2 + y^2) / -z".
+// The InfixToPostfix + PostfixToAST path stays available for compatibility.
+class InfixParser {
+public:
+    // Parse into a shared_ptr tree
+    static ASTNodePtr parse(std::string_view infix);
+
+    // Parse into an arena (no per-node heap allocation)
+    static const ArenaNode* parse(std::string_view infix, ExpressionArena& arena);
+
+    // Same parses, returning the error instead of throwing it
+    static Expected<ASTNodePtr, ParseError> tryParse(std::string_view infix);
+    static Expected<const ArenaNode*, ParseError> tryParse(std::string_view infix, ExpressionArena& arena);
+};
+
+#endif // INFIX_PARSER_H
\ No newline at end of file
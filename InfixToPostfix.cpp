@@ -28,22 +28,30 @@ void InfixToPostfix::handleOperator(char op) {
     opStack.push(op);
 }
 
-void InfixToPostfix::handleRightParen() {
+// Returns false if there is no matching '('
+bool InfixToPostfix::handleRightParen() {
     while (!opStack.empty() && opStack.top() != '(') {
         output += opStack.top();
         output += ' ';
         opStack.pop();
     }
     
-    if (opStack.empty()) throw "Mismatched parentheses";
+    if (opStack.empty()) return false;
     opStack.pop();  // Remove '('
+    return true;
 }
 
 std::string InfixToPostfix::convertInfixToPostfix(const std::string& infix) {
+    std::cout << "Infix: " << infix << std::endl;
+    auto postfix = tryConvertInfixToPostfix(infix);
+    if (!postfix) throw std::runtime_error(postfix.error().message);
+    return std::move(*postfix);
+}
+
+Expected<std::string, ParseError> InfixToPostfix::tryConvertInfixToPostfix(const std::string& infix) {
     initPrecedence();
     opStack = std::stack<char>();  // Clear stack
     output.clear();
-    std::cout << "Infix: " << infix << std::endl;
     
     for (size_t i = 0; i < infix.length(); ++i) {
         char token = infix[i];
@@ -61,23 +69,27 @@ std::string InfixToPostfix::convertInfixToPostfix(const std::string& infix) {
             opStack.push(token);
         }
         else if (token == ')') {
-            handleRightParen();
+            if (!handleRightParen()) {
+                return Unexpected(ParseError{ErrorCode::MISMATCHED_PARENTHESES, "Mismatched parentheses"});
+            }
         }
         else if (isOp(token)) {
             handleOperator(token);
         }
         else {
-            throw std::runtime_error("Invalid character in expression");
+            return Unexpected(ParseError{ErrorCode::INVALID_CHARACTER, "Invalid character in expression"});
         }
     }
     
     // Pop remaining operators
     while (!opStack.empty()) {
-        if (opStack.top() == '(') throw "Mismatched parentheses";
+        if (opStack.top() == '(') {
+            return Unexpected(ParseError{ErrorCode::MISMATCHED_PARENTHESES, "Mismatched parentheses"});
+        }
         output += opStack.top();
         output += ' ';
         opStack.pop();
     }
     
     return output;
-}
\ No newline at end of file
+}
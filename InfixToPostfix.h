@@ -1,6 +1,7 @@
 #ifndef INFIX_TO_POSTFIX_H
 #define INFIX_TO_POSTFIX_H
 
+#include "Expected.h"
 #include <string>
 #include <stack>
 #include <unordered_map>
@@ -16,10 +17,13 @@ private:
     bool isOperandChar(char c);
     int prec(char op);
     void handleOperator(char op);
-    void handleRightParen();
+    bool handleRightParen();
 
 public:
+    // Echoes the input to std::cout; throws std::runtime_error on bad input
     std::string convertInfixToPostfix(const std::string& infix);
+    // Same conversion with no echo, returning the error instead of throwing
+    Expected<std::string, ParseError> tryConvertInfixToPostfix(const std::string& infix);
 };
 
 #endif // INFIX_TO_POSTFIX_H
\ No newline at end of file
@@ -0,0 +1,371 @@
+#include "IntervalEvaluator.h"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+static constexpr double INF = std::numeric_limits<double>::infinity();
+static constexpr double TWO_PI = 2 * std::numbers::pi;
+
+// One ulp outward, for results of libm functions that are not exactly rounded
+static Interval widen(Interval range) {
+    if (!range.isEmpty()) {
+        range.lo = std::nextafter(range.lo, -INF);
+        range.hi = std::nextafter(range.hi, INF);
+    }
+    return range;
+}
+
+// Smallest range holding the non-NaN candidates (empty if there are none)
+static Interval hull(std::initializer_list<double> candidates) {
+    Interval range = Interval::empty();
+    for (double value : candidates) {
+        if (std::isnan(value)) continue;
+        range.lo = std::min(range.lo, value);
+        range.hi = std::max(range.hi, value);
+    }
+    return range;
+}
+
+static Interval join(Interval a, const Interval& b) {
+    a.lo = std::min(a.lo, b.lo);
+    a.hi = std::max(a.hi, b.hi);
+    return a;
+}
+
+static bool containsZero(const Interval& range) {
+    return range.lo <= 0 && range.hi >= 0;
+}
+
+static bool hasInfinity(const Interval& range) {
+    return range.lo == -INF || range.hi == INF;
+}
+
+static bool isInteger(double value) {
+    return std::isfinite(value) && std::trunc(value) == value;
+}
+
+static Interval divideRange(const Interval& a, Interval b, Interval flags) {
+    if (containsZero(b)) {
+        flags.canFail = true;                 // rows with b == 0 throw
+        if (b.lo == 0 && b.hi == 0) return {INF, -INF, flags.canBeNaN, true};
+        if (b.lo < 0 && b.hi > 0) return {-INF, INF, flags.canBeNaN || hasInfinity(a), true};
+        // One-sided: the rows that do not throw have |b| >= the smallest denormal
+        if (b.lo == 0) b.lo = std::numeric_limits<double>::denorm_min();
+        if (b.hi == 0) b.hi = -std::numeric_limits<double>::denorm_min();
+    }
+    double q1 = a.lo / b.lo, q2 = a.lo / b.hi, q3 = a.hi / b.lo, q4 = a.hi / b.hi;
+    if (std::isnan(q1) || std::isnan(q2) || std::isnan(q3) || std::isnan(q4)) {
+        return {-INF, INF, true, flags.canFail};     // inf / inf
+    }
+    Interval range = hull({q1, q2, q3, q4});
+    range.canBeNaN = flags.canBeNaN || (hasInfinity(a) && hasInfinity(b));
+    range.canFail = flags.canFail;
+    return range;
+}
+
+static Interval powerRange(const Interval& a, const Interval& b, const Interval& flags) {
+    Interval range;
+    if (b.lo == b.hi && isInteger(b.lo)) {
+        // Integer exponent: defined for every base, monotone on each side of zero
+        double n = b.lo;
+        if (n == 0) {
+            range = Interval::point(1);
+        } else {
+            range = widen(hull({std::pow(a.lo, n), std::pow(a.hi, n)}));
+            bool odd = std::fmod(n, 2) != 0;
+            if (n > 0 && !odd && a.lo < 0 && a.hi > 0) {
+                range.lo = 0;
+            } else if (n < 0 && containsZero(a)) {
+                range.hi = INF;                      // x -> 0
+                if (odd) range.lo = -INF;
+            }
+            if (!odd) range.lo = std::max(range.lo, 0.0);
+        }
+        range.canBeNaN = flags.canBeNaN;
+        range.canFail = flags.canFail;
+        return range;
+    }
+
+    // For x >= 0, x^y = exp(y log x) is extreme at the corners of the box
+    range = Interval::empty();
+    bool nonNegative = true;
+    if (a.hi >= 0) {
+        double x = a.lo > 0 ? a.lo : 0.0;    // +0: the sign of -0 is handled below
+        range = hull({std::pow(x, b.lo), std::pow(x, b.hi), std::pow(a.hi, b.lo), std::pow(a.hi, b.hi)});
+    }
+    if (containsZero(a) && b.lo <= -1) {
+        range.lo = -INF;                     // (-0) ^ (negative odd integer)
+        nonNegative = false;
+    }
+    bool canBeNaN = flags.canBeNaN;
+    if (a.lo < 0) {
+        canBeNaN = true;    // negative base, non-integer exponent
+        if (std::floor(b.hi) >= std::ceil(b.lo)) {
+            // Integer exponents in range: |x|^y with either sign
+            double small = a.hi < 0 ? -a.hi : 0.0;
+            double large = -a.lo;
+            Interval magnitude = hull({std::pow(small, b.lo), std::pow(small, b.hi), std::pow(large, b.lo),
+                                       std::pow(large, b.hi)});
+            if (!magnitude.isEmpty()) {
+                range = join(range, {-magnitude.hi, magnitude.hi});
+                nonNegative = false;
+            }
+        }
+        if (a.lo == -INF) range = join(range, hull({std::pow(-INF, b.lo), std::pow(-INF, b.hi)}));
+    }
+    range = widen(range);
+    if (nonNegative && !range.isEmpty()) range.lo = std::max(range.lo, 0.0);
+    range.canBeNaN = canBeNaN;
+    range.canFail = flags.canFail;
+    return range;
+}
+
+// sin or cos over [lo, hi]: the endpoint values, or +-1 where a peak or
+// trough (at `peak` / `trough` plus multiples of 2 pi) falls inside
+static Interval periodicRange(double lo, double hi, double (*function)(double), double peak, double trough) {
+    if (!std::isfinite(lo) || !std::isfinite(hi)) return {-1, 1, true};
+    // Far from zero the peak positions are not accurate enough to rule them out
+    if (hi - lo >= TWO_PI || std::max(std::abs(lo), std::abs(hi)) > 1e6) return {-1, 1};
+
+    Interval range = widen(hull({function(lo), function(hi)}));
+    auto reaches = [&](double at) {
+        double k = std::ceil((lo - at) / TWO_PI - 1e-9);
+        return at + k * TWO_PI <= hi + 1e-9;
+    };
+    if (reaches(peak)) range.hi = 1;
+    if (reaches(trough)) range.lo = -1;
+    range.lo = std::max(range.lo, -1.0);
+    range.hi = std::min(range.hi, 1.0);
+    return range;
+}
+
+IntervalEvaluator::IntervalEvaluator(const ASTNodePtr& ast) {
+    if (!ast) {
+        throw std::runtime_error("Cannot analyse an empty AST");
+    }
+    variables = ast->collectVariables();
+    std::unordered_map<const ASTNode*, std::uint32_t> seen;
+    addNode(ast.get(), seen);
+}
+
+std::uint32_t IntervalEvaluator::addNode(const ASTNode* node,
+                                         std::unordered_map<const ASTNode*, std::uint32_t>& seen) {
+    auto found = seen.find(node);
+    if (found != seen.end()) return found->second;
+
+    std::vector<std::uint32_t> children;
+    switch(node->type) {
+        case NodeType::BINARY_OP:
+            children.push_back(addNode(node->op.left.get(), seen));
+            children.push_back(addNode(node->op.right.get(), seen));
+            break;
+        case NodeType::UNARY_OP:
+            children.push_back(addNode(node->op.left.get(), seen));
+            break;
+        case NodeType::FUNCTION_CALL:
+            for (const auto& arg : node->function.arguments) {
+                children.push_back(addNode(arg.get(), seen));
+            }
+            break;
+        default:
+            break;
+    }
+
+    Node entry{};
+    entry.type = node->type;
+    entry.op = OperatorType::NONE;
+    entry.function = Function::UNKNOWN;
+    entry.firstChild = static_cast<std::uint32_t>(childIndices.size());
+    entry.childCount = static_cast<std::uint32_t>(children.size());
+    childIndices.insert(childIndices.end(), children.begin(), children.end());
+
+    switch(node->type) {
+        case NodeType::NUMBER:
+            constants.push_back(node->number.value);
+            entry.operand = static_cast<std::uint32_t>(constants.size() - 1);
+            break;
+        case NodeType::VARIABLE: {
+            auto it = std::lower_bound(variables.begin(), variables.end(), node->variable.name);
+            entry.operand = static_cast<std::uint32_t>(it - variables.begin());
+            break;
+        }
+        case NodeType::BINARY_OP:
+        case NodeType::UNARY_OP:
+            entry.op = node->op.op;
+            break;
+        case NodeType::FUNCTION_CALL: {
+            // Same dispatch as ASTNode::evaluate: single-argument built-ins only
+            static const char* names[] = {"sin", "cos", "sqrt", "log", "exp", "abs"};
+            if (children.size() == 1) {
+                for (size_t f = 0; f < std::size(names); ++f) {
+                    if (node->function.functionName == names[f]) entry.function = static_cast<Function>(f);
+                }
+            }
+            break;
+        }
+    }
+
+    nodes.push_back(entry);
+    std::uint32_t index = static_cast<std::uint32_t>(nodes.size() - 1);
+    seen.emplace(node, index);
+    return index;
+}
+
+Interval IntervalEvaluator::evaluate(const IntervalMap& bounds) const {
+    std::vector<Interval> slots(variables.size());
+    for (size_t i = 0; i < variables.size(); ++i) {
+        auto it = bounds.find(variables[i]);
+        if (it == bounds.end()) {
+            throw std::runtime_error("Undefined variable: " + variables[i]);
+        }
+        slots[i] = it->second;
+    }
+    return evaluate(slots);
+}
+
+Interval IntervalEvaluator::evaluate(std::span<const Interval> bounds) const {
+    if (bounds.size() != variables.size()) {
+        throw std::runtime_error("Expected " + std::to_string(variables.size()) + " bounds but got " +
+                                 std::to_string(bounds.size()));
+    }
+
+    std::vector<Interval> ranges(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const Node& node = nodes[i];
+        Interval& range = ranges[i];
+
+        // NaN and failure flags flow up from every child; an empty child
+        // (no value at all) leaves nothing to compute
+        Interval flags = Interval::empty();
+        bool anyEmpty = false;
+        for (std::uint32_t c = 0; c < node.childCount; ++c) {
+            const Interval& child = ranges[childIndices[node.firstChild + c]];
+            flags.canBeNaN = flags.canBeNaN || child.canBeNaN;
+            flags.canFail = flags.canFail || child.canFail;
+            anyEmpty = anyEmpty || child.isEmpty();
+        }
+        const Interval& a = node.childCount > 0 ? ranges[childIndices[node.firstChild]] : flags;
+        const Interval& b = node.childCount > 1 ? ranges[childIndices[node.firstChild + 1]] : flags;
+
+        bool known = (node.type == NodeType::BINARY_OP && node.op >= OperatorType::ADD &&
+                      node.op <= OperatorType::POWER) ||
+                     (node.type == NodeType::UNARY_OP && node.op == OperatorType::NEGATIVE) ||
+                     (node.type == NodeType::FUNCTION_CALL && node.function != Function::UNKNOWN);
+        if (node.type != NodeType::NUMBER && node.type != NodeType::VARIABLE && (anyEmpty || !known)) {
+            range = flags;
+            range.canFail = flags.canFail || !known;
+            // NaN / 0 still throws
+            if (node.type == NodeType::BINARY_OP && node.op == OperatorType::DIVIDE && !b.isEmpty() &&
+                containsZero(b)) {
+                range.canFail = true;
+            }
+            // NaN ^ 0 and 1 ^ NaN are 1
+            if (known && node.op == OperatorType::POWER && node.type == NodeType::BINARY_OP &&
+                ((a.isEmpty() && a.canBeNaN && !b.isEmpty() && b.contains(0)) ||
+                 (b.isEmpty() && b.canBeNaN && !a.isEmpty() && a.contains(1)))) {
+                range.lo = range.hi = 1;
+            }
+            continue;
+        }
+
+        switch(node.type) {
+            case NodeType::NUMBER: {
+                double value = constants[node.operand];
+                range = std::isnan(value) ? Interval{INF, -INF, true} : Interval::point(value);
+                break;
+            }
+
+            case NodeType::VARIABLE:
+                range = bounds[node.operand];
+                break;
+
+            case NodeType::BINARY_OP:
+                switch(node.op) {
+                    case OperatorType::ADD:
+                        range = {a.lo + b.lo, a.hi + b.hi, flags.canBeNaN, flags.canFail};
+                        // inf + -inf
+                        if ((a.hi == INF && b.lo == -INF) || (a.lo == -INF && b.hi == INF)) range.canBeNaN = true;
+                        break;
+                    case OperatorType::SUBTRACT:
+                        range = {a.lo - b.hi, a.hi - b.lo, flags.canBeNaN, flags.canFail};
+                        if ((a.hi == INF && b.hi == INF) || (a.lo == -INF && b.lo == -INF)) range.canBeNaN = true;
+                        break;
+                    case OperatorType::MULTIPLY: {
+                        // 0 * inf is NaN; values next to it run from 0 to the other corners
+                        auto times = [](double x, double y) {
+                            double product = x * y;
+                            return std::isnan(product) ? 0.0 : product;
+                        };
+                        range = hull({times(a.lo, b.lo), times(a.lo, b.hi), times(a.hi, b.lo), times(a.hi, b.hi)});
+                        range.canBeNaN = flags.canBeNaN || (containsZero(a) && hasInfinity(b)) ||
+                                         (containsZero(b) && hasInfinity(a));
+                        range.canFail = flags.canFail;
+                        break;
+                    }
+                    case OperatorType::DIVIDE:
+                        range = divideRange(a, b, flags);
+                        break;
+                    default:
+                        range = powerRange(a, b, flags);
+                        break;
+                }
+                // Opposite infinities give NaN at an endpoint; the range is then unbounded there
+                if (std::isnan(range.lo)) range.lo = -INF;
+                if (std::isnan(range.hi)) range.hi = INF;
+                break;
+
+            case NodeType::UNARY_OP:
+                range = {-a.hi, -a.lo, flags.canBeNaN, flags.canFail};
+                break;
+
+            case NodeType::FUNCTION_CALL:
+                switch(node.function) {
+                    case Function::SIN:
+                        range = periodicRange(a.lo, a.hi, [](double x) { return std::sin(x); },
+                                              std::numbers::pi / 2, -std::numbers::pi / 2);
+                        break;
+                    case Function::COS:
+                        range = periodicRange(a.lo, a.hi, [](double x) { return std::cos(x); }, 0,
+                                              std::numbers::pi);
+                        break;
+                    case Function::SQRT:
+                        if (a.hi < 0) {
+                            range = Interval::empty();
+                        } else {
+                            range = {std::sqrt(std::max(a.lo, 0.0)), std::sqrt(a.hi)};
+                        }
+                        range.canFail = a.lo < 0;
+                        break;
+                    case Function::LOG:
+                        if (a.hi <= 0) {
+                            range = Interval::empty();
+                        } else {
+                            double lowest = a.lo > 0 ? a.lo : std::numeric_limits<double>::denorm_min();
+                            range = widen({std::log(lowest), std::log(a.hi)});
+                        }
+                        range.canFail = a.lo <= 0;
+                        break;
+                    case Function::EXP:
+                        range = widen({std::exp(a.lo), std::exp(a.hi)});
+                        range.lo = std::max(range.lo, 0.0);
+                        break;
+                    case Function::ABS:
+                        if (a.lo >= 0) {
+                            range = {a.lo, a.hi};
+                        } else if (a.hi <= 0) {
+                            range = {-a.hi, -a.lo};
+                        } else {
+                            range = {0, std::max(-a.lo, a.hi)};
+                        }
+                        break;
+                    case Function::UNKNOWN:
+                        break;
+                }
+                range.canBeNaN = range.canBeNaN || flags.canBeNaN;
+                range.canFail = range.canFail || flags.canFail;
+                break;
+        }
+    }
+    return ranges.back();
+}
@@ -0,0 +1,69 @@
+#ifndef INTERVAL_EVALUATOR_H
+#define INTERVAL_EVALUATOR_H
+
+#include "AST_NODE.h"
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Closed range of doubles, with flags for what else a value in it may be.
+// lo > hi is the empty range (every evaluation fails or gives NaN).
+struct Interval {
+    double lo = -std::numeric_limits<double>::infinity();
+    double hi = std::numeric_limits<double>::infinity();
+    bool canBeNaN = false;
+    bool canFail = false;     // some point may throw (division by zero, sqrt/log domain, ...)
+
+    static Interval point(double value) { return {value, value}; }
+    static Interval empty() {
+        return {std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+    }
+
+    bool isEmpty() const { return lo > hi; }
+    bool contains(double value) const { return lo <= value && value <= hi; }
+};
+
+using IntervalMap = std::unordered_map<std::string, Interval>;
+
+// Range analysis: for variables bounded by intervals, an interval holding
+// every non-NaN value ASTNode::evaluate can return, and whether it can return
+// NaN or throw. Bounds are sound for the double results, not just the real
+// ones: +, -, *, / and sqrt round monotonically, and libm results (exp, log,
+// pow, sin, cos) are widened by one ulp.
+class IntervalEvaluator {
+public:
+    explicit IntervalEvaluator(const ASTNodePtr& ast);
+
+    // Variable names in bounds order (same as collectVariables())
+    const std::vector<std::string>& getVariables() const { return variables; }
+
+    // bounds[i] holds getVariables()[i]
+    Interval evaluate(std::span<const Interval> bounds) const;
+    // Throws "Undefined variable: x" for a variable without bounds
+    Interval evaluate(const IntervalMap& bounds) const;
+
+private:
+    enum class Function : std::uint8_t { SIN, COS, SQRT, LOG, EXP, ABS, UNKNOWN };
+
+    // Nodes are stored children first; the root is last
+    struct Node {
+        NodeType type;
+        OperatorType op;
+        Function function;
+        std::uint32_t firstChild;      // into childIndices
+        std::uint32_t childCount;
+        std::uint32_t operand;         // NUMBER: constant, VARIABLE: slot
+    };
+
+    std::vector<Node> nodes;
+    std::vector<std::uint32_t> childIndices;
+    std::vector<double> constants;
+    std::vector<std::string> variables;
+
+    std::uint32_t addNode(const ASTNode* node, std::unordered_map<const ASTNode*, std::uint32_t>& seen);
+};
+
+#endif // INTERVAL_EVALUATOR_H
@@ -0,0 +1,326 @@
+#include "JitExpression.h"
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__x86_64__) && !defined(_WIN32)
+#define JIT_EXPRESSION_X86_64 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef JIT_EXPRESSION_X86_64
+
+// ---------------------------------------------------------------------------
+// x86-64 encoding helpers. Register use (System V ABI):
+//   rbx   slots pointer (callee-saved, copied from rdi)
+//   xmm0  top of the value stack; the rest of the stack and the temporaries
+//         live in the frame at [rsp + 8 * i]
+//   xmm1  second operand, xmm2 zero for the domain checks
+// Code is straight-line: every error jumps to one exit that returns ERROR_RESULT.
+
+using Code = std::vector<std::uint8_t>;
+
+static void emitBytes(Code& code, std::initializer_list<std::uint8_t> bytes) {
+    for (std::uint8_t byte : bytes) code.push_back(byte);
+}
+
+static void emitImm32(Code& code, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) code.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+}
+
+static void emitImm64(Code& code, std::uint64_t value) {
+    for (int i = 0; i < 8; ++i) code.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+}
+
+// movsd xmm0, [rsp + offset]
+static void loadFrame(Code& code, std::uint32_t offset) {
+    emitBytes(code, {0xF2, 0x0F, 0x10, 0x84, 0x24});
+    emitImm32(code, offset);
+}
+
+// movsd [rsp + offset], xmm0
+static void storeFrame(Code& code, std::uint32_t offset) {
+    emitBytes(code, {0xF2, 0x0F, 0x11, 0x84, 0x24});
+    emitImm32(code, offset);
+}
+
+// movsd xmm0, [rbx + offset]
+static void loadSlot(Code& code, std::uint32_t offset) {
+    emitBytes(code, {0xF2, 0x0F, 0x10, 0x83});
+    emitImm32(code, offset);
+}
+
+// mov rax, bits; movq xmm0, rax
+static void loadBits(Code& code, std::uint64_t bits) {
+    emitBytes(code, {0x48, 0xB8});
+    emitImm64(code, bits);
+    emitBytes(code, {0x66, 0x48, 0x0F, 0x6E, 0xC0});
+}
+
+// mov rax, target; call rax
+static void callAbsolute(Code& code, const void* target) {
+    emitBytes(code, {0x48, 0xB8});
+    emitImm64(code, reinterpret_cast<std::uintptr_t>(target));
+    emitBytes(code, {0xFF, 0xD0});
+}
+
+// Conditional jump (0F cc rel32) to the error exit, patched once its address is known
+static void jumpToError(Code& code, std::uint8_t condition, std::vector<size_t>& patches) {
+    emitBytes(code, {0x0F, condition});
+    patches.push_back(code.size());
+    emitImm32(code, 0);
+}
+
+static constexpr std::uint8_t JE = 0x84;
+static constexpr std::uint8_t JB = 0x82;
+static constexpr std::uint8_t JBE = 0x86;
+
+// xorpd xmm2, xmm2; ucomisd xmmN, xmm2; jp +6 (unordered never fails); jcc error
+static void checkAgainstZero(Code& code, std::uint8_t ucomisdModRM, std::uint8_t condition,
+                             std::vector<size_t>& patches) {
+    emitBytes(code, {0x66, 0x0F, 0x57, 0xD2});
+    emitBytes(code, {0x66, 0x0F, 0x2E, ucomisdModRM});
+    emitBytes(code, {0x7A, 0x06});
+    jumpToError(code, condition, patches);
+}
+
+using UnaryFunction = double (*)(double);
+using BinaryFunction = double (*)(double, double);
+
+// Translate bytecode into machine code; returns false for unsupported input
+static bool generateCode(const CompiledExpression& compiled, Code& code) {
+    const auto& constants = compiled.getConstants();
+    size_t tempBase = compiled.getMaxStackDepth();
+    size_t frameSize = ((tempBase + compiled.getTempCount()) * 8 + 15) & ~static_cast<size_t>(15);
+    if (frameSize > 0x7FFFFFF0u) return false;
+    auto frameOffset = [](size_t index) { return static_cast<std::uint32_t>(index * 8); };
+
+    std::vector<size_t> errorPatches;
+
+    // push rbx; mov rbx, rdi; sub rsp, frameSize (rsp stays 16-byte aligned for calls)
+    emitBytes(code, {0x53, 0x48, 0x89, 0xFB, 0x48, 0x81, 0xEC});
+    emitImm32(code, static_cast<std::uint32_t>(frameSize));
+
+    size_t depth = 0;
+    bool raised = false;
+    auto spillTop = [&] {
+        if (depth > 0) storeFrame(code, frameOffset(depth - 1));
+    };
+    // movsd xmm1, xmm0; movsd xmm0, [second from top]
+    auto popOperands = [&] {
+        emitBytes(code, {0xF2, 0x0F, 0x10, 0xC8});
+        loadFrame(code, frameOffset(depth - 2));
+        --depth;
+    };
+
+    for (const Instruction& ins : compiled.getInstructions()) {
+        if (raised) break;
+        switch(ins.op) {
+            case OpCode::PUSH_CONST: {
+                spillTop();
+                std::uint64_t bits;
+                std::memcpy(&bits, &constants[ins.operand], sizeof(bits));
+                loadBits(code, bits);
+                ++depth;
+                break;
+            }
+            case OpCode::LOAD_VAR:
+                spillTop();
+                loadSlot(code, frameOffset(ins.operand));
+                ++depth;
+                break;
+            case OpCode::STORE_TEMP:
+                storeFrame(code, frameOffset(tempBase + ins.operand));
+                break;
+            case OpCode::LOAD_TEMP:
+                spillTop();
+                loadFrame(code, frameOffset(tempBase + ins.operand));
+                ++depth;
+                break;
+
+            case OpCode::ADD: popOperands(); emitBytes(code, {0xF2, 0x0F, 0x58, 0xC1}); break;
+            case OpCode::SUBTRACT: popOperands(); emitBytes(code, {0xF2, 0x0F, 0x5C, 0xC1}); break;
+            case OpCode::MULTIPLY: popOperands(); emitBytes(code, {0xF2, 0x0F, 0x59, 0xC1}); break;
+            case OpCode::DIVIDE:
+                popOperands();
+                checkAgainstZero(code, 0xCA, JE, errorPatches);   // b == 0
+                emitBytes(code, {0xF2, 0x0F, 0x5E, 0xC1});
+                break;
+            case OpCode::POWER:
+                popOperands();
+                callAbsolute(code, reinterpret_cast<const void*>(static_cast<BinaryFunction>(std::pow)));
+                break;
+
+            // Sign bit flips through rax: movq rax, xmm0; btc/btr rax, 63; movq xmm0, rax
+            case OpCode::NEGATIVE:
+                emitBytes(code, {0x66, 0x48, 0x0F, 0x7E, 0xC0, 0x48, 0x0F, 0xBA, 0xF8, 0x3F,
+                                 0x66, 0x48, 0x0F, 0x6E, 0xC0});
+                break;
+            case OpCode::ABS:
+                emitBytes(code, {0x66, 0x48, 0x0F, 0x7E, 0xC0, 0x48, 0x0F, 0xBA, 0xF0, 0x3F,
+                                 0x66, 0x48, 0x0F, 0x6E, 0xC0});
+                break;
+
+            case OpCode::SQRT:
+                checkAgainstZero(code, 0xC2, JB, errorPatches);   // a < 0
+                emitBytes(code, {0xF2, 0x0F, 0x51, 0xC0});
+                break;
+            case OpCode::LOG:
+                checkAgainstZero(code, 0xC2, JBE, errorPatches);  // a <= 0
+                callAbsolute(code, reinterpret_cast<const void*>(static_cast<UnaryFunction>(std::log)));
+                break;
+            case OpCode::SIN:
+                callAbsolute(code, reinterpret_cast<const void*>(static_cast<UnaryFunction>(std::sin)));
+                break;
+            case OpCode::COS:
+                callAbsolute(code, reinterpret_cast<const void*>(static_cast<UnaryFunction>(std::cos)));
+                break;
+            case OpCode::EXP:
+                callAbsolute(code, reinterpret_cast<const void*>(static_cast<UnaryFunction>(std::exp)));
+                break;
+
+            case OpCode::RAISE:
+                // Everything after an unconditional error is unreachable: jmp error
+                code.push_back(0xE9);
+                errorPatches.push_back(code.size());
+                emitImm32(code, 0);
+                raised = true;
+                break;
+
+            default:
+                return false;
+        }
+    }
+
+    // Normal exit: add rsp, frameSize; pop rbx; ret
+    auto emitEpilogue = [&] {
+        emitBytes(code, {0x48, 0x81, 0xC4});
+        emitImm32(code, static_cast<std::uint32_t>(frameSize));
+        emitBytes(code, {0x5B, 0xC3});
+    };
+    emitEpilogue();
+
+    // Error exit returns the sentinel NaN
+    size_t errorExit = code.size();
+    loadBits(code, JitExpression::ERROR_RESULT);
+    emitEpilogue();
+
+    for (size_t patch : errorPatches) {
+        auto rel = static_cast<std::int32_t>(errorExit - (patch + 4));
+        std::memcpy(&code[patch], &rel, sizeof(rel));
+    }
+    return true;
+}
+
+#endif // JIT_EXPRESSION_X86_64
+
+// Compile to bytecode, then to native code when possible
+JitExpression::JitExpression(const ASTNodePtr& ast, bool enableJit) : compiled(ast) {
+#ifdef JIT_EXPRESSION_X86_64
+    if (!enableJit) return;
+
+    Code machineCode;
+    if (!generateCode(compiled, machineCode)) return;
+
+    // Write the code into a fresh mapping, then make it read-only and executable
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t size = (machineCode.size() + pageSize - 1) / pageSize * pageSize;
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) return;
+
+    std::memcpy(memory, machineCode.data(), machineCode.size());
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, size);
+        return;
+    }
+
+    code = memory;
+    mappedSize = size;
+    codeSize = machineCode.size();
+    function = reinterpret_cast<Function>(memory);
+#else
+    (void)enableJit;
+#endif
+}
+
+JitExpression::~JitExpression() {
+    release();
+}
+
+JitExpression::JitExpression(JitExpression&& other) noexcept
+    : compiled(std::move(other.compiled)), function(other.function), code(other.code),
+      mappedSize(other.mappedSize), codeSize(other.codeSize) {
+    other.function = nullptr;
+    other.code = nullptr;
+    other.mappedSize = 0;
+    other.codeSize = 0;
+}
+
+JitExpression& JitExpression::operator=(JitExpression&& other) noexcept {
+    if (this != &other) {
+        release();
+        compiled = std::move(other.compiled);
+        function = std::exchange(other.function, nullptr);
+        code = std::exchange(other.code, nullptr);
+        mappedSize = std::exchange(other.mappedSize, 0);
+        codeSize = std::exchange(other.codeSize, 0);
+    }
+    return *this;
+}
+
+// Unmap the native code
+void JitExpression::release() {
+#ifdef JIT_EXPRESSION_X86_64
+    if (code) munmap(code, mappedSize);
+#endif
+    code = nullptr;
+    function = nullptr;
+}
+
+bool JitExpression::isSupported() {
+#ifdef JIT_EXPRESSION_X86_64
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Native call; on the error sentinel the interpreter reproduces the exception
+// (or the value, if the sentinel was a genuine NaN result)
+double JitExpression::evaluate(const double* slots) const {
+    if (!function) {
+        return compiled.evaluate(slots);
+    }
+    double result = function(slots);
+    std::uint64_t bits;
+    std::memcpy(&bits, &result, sizeof(bits));
+    if (bits == ERROR_RESULT) {
+        return compiled.evaluate(slots);
+    }
+    return result;
+}
+
+// Evaluate from slot-ordered values
+double JitExpression::evaluate(std::span<const double> slots) const {
+    if (slots.size() < compiled.getVariables().size()) {
+        return compiled.evaluate(slots);   // throws the size error
+    }
+    return evaluate(slots.data());
+}
+
+// Evaluate with VariableMap; missing variables go through the interpreter so
+// the error order matches ASTNode::evaluate
+double JitExpression::evaluate(const VariableMap& variables) const {
+    const auto& names = compiled.getVariables();
+    std::vector<double> slots(names.size());
+    for (size_t i = 0; i < names.size(); ++i) {
+        auto it = variables.find(names[i]);
+        if (it == variables.end()) {
+            return compiled.evaluate(variables);
+        }
+        slots[i] = it->second;
+    }
+    return evaluate(slots.data());
+}
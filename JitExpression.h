@@ -0,0 +1,61 @@
+#ifndef JIT_EXPRESSION_H
+#define JIT_EXPRESSION_H
+
+#include "AST_NODE.h"
+#include "CompiledExpression.h"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Native x86-64 code for an expression, generated from its bytecode into an
+// mmap'd executable buffer. Arithmetic uses scalar SSE2 and the built-in
+// functions call the same libm routines as ASTNode::evaluate, so results are
+// bit-identical. On platforms without JIT support (or when disabled) every
+// call runs the CompiledExpression interpreter instead.
+class JitExpression {
+public:
+    // Native entry point; reads variables in slot order (see getBinding())
+    using Function = double (*)(const double* slots);
+
+    // Bit pattern the native code returns when an evaluation error occurs
+    static constexpr std::uint64_t ERROR_RESULT = 0x7FF8DEADBEEF0001ULL;
+
+    explicit JitExpression(const ASTNodePtr& ast, bool enableJit = true);
+    ~JitExpression();
+
+    JitExpression(const JitExpression&) = delete;
+    JitExpression& operator=(const JitExpression&) = delete;
+    JitExpression(JitExpression&& other) noexcept;
+    JitExpression& operator=(JitExpression&& other) noexcept;
+
+    // Same results and errors as ASTNode::evaluate. When the native code
+    // reports an error, the interpreter re-runs the row to throw it.
+    double evaluate(const double* slots) const;
+    double evaluate(std::span<const double> slots) const;
+    double evaluate(const VariableMap& variables = {}) const;
+
+    // Raw native function, or nullptr when running on the interpreter.
+    // Returns a NaN with the ERROR_RESULT bits instead of throwing.
+    Function getFunction() const { return function; }
+    bool isNative() const { return function != nullptr; }
+
+    VariableBinding getBinding() const { return compiled.getBinding(); }
+    const std::vector<std::string>& getVariables() const { return compiled.getVariables(); }
+    const CompiledExpression& getCompiled() const { return compiled; }
+    size_t getCodeSize() const { return codeSize; }
+
+    // True when this build can generate native code
+    static bool isSupported();
+
+private:
+    CompiledExpression compiled;
+    Function function = nullptr;
+    void* code = nullptr;      // mapped region
+    size_t mappedSize = 0;
+    size_t codeSize = 0;
+
+    void release();
+};
+
+#endif // JIT_EXPRESSION_H
@@ -0,0 +1,198 @@
+#include "MultiExpressionEngine.h"
+#include "HashConsBuilder.h"
+#include "SimdKernels.h"
+#include <algorithm>
+
+static const std::string divisionByZero = "Division by zero";
+static const std::string negativeSqrt = "Square root of negative number";
+static const std::string nonPositiveLog = "Log of non-positive number";
+
+MultiExpressionEngine::MultiExpressionEngine(const std::vector<ASTNodePtr>& expressions)
+    : compiled(merge(expressions, totalNodes, uniqueNodes)) {}
+
+// One builder for every expression, so subterms they have in common become shared nodes
+std::vector<ASTNodePtr> MultiExpressionEngine::merge(const std::vector<ASTNodePtr>& expressions,
+                                                     size_t& totalNodes, size_t& uniqueNodes) {
+    HashConsBuilder builder;
+    std::vector<ASTNodePtr> roots;
+    roots.reserve(expressions.size());
+    for (const auto& expression : expressions) {
+        if (!expression) {
+            throw std::runtime_error("Cannot compile an empty AST");
+        }
+        roots.push_back(builder.build(expression));
+    }
+    totalNodes = builder.getTotalNodes();
+    uniqueNodes = builder.getUniqueNodes();
+    return roots;
+}
+
+std::vector<std::optional<BatchEvaluationError>> MultiExpressionEngine::evaluate(
+        const std::vector<std::span<const double>>& columns, const std::vector<std::span<double>>& outputs) const {
+    const auto& variables = compiled.getVariables();
+    if (outputs.size() != compiled.getOutputCount()) {
+        throw std::runtime_error("Expected " + std::to_string(compiled.getOutputCount()) +
+                                 " output columns but got " + std::to_string(outputs.size()));
+    }
+    size_t rows = outputs.empty() ? 0 : outputs[0].size();
+    for (const auto& output : outputs) {
+        if (output.size() != rows) {
+            throw std::runtime_error("Output columns must all have the same length");
+        }
+    }
+    if (columns.size() != variables.size()) {
+        throw std::runtime_error("Expected " + std::to_string(variables.size()) +
+                                 " columns but got " + std::to_string(columns.size()));
+    }
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (columns[i].size() < rows) {
+            throw std::runtime_error("Column for variable '" + variables[i] + "' is shorter than the output");
+        }
+    }
+
+    // Stack registers followed by one register per temporary, each with its failure
+    size_t depth = std::max<size_t>(compiled.getMaxStackDepth(), 1);
+    std::vector<double> buffers((depth + compiled.getTempCount()) * CHUNK_SIZE);
+    std::vector<const double*> operands(depth);
+    std::vector<Failure> failures(depth + compiled.getTempCount());
+    std::vector<std::optional<BatchEvaluationError>> errors(outputs.size());
+
+    for (size_t start = 0; start < rows; start += CHUNK_SIZE) {
+        size_t count = std::min(CHUNK_SIZE, rows - start);
+        evaluateChunk(columns, start, count, outputs, buffers.data(), operands.data(), failures.data(), errors);
+    }
+    return errors;
+}
+
+std::vector<std::vector<double>> MultiExpressionEngine::evaluate(
+        const std::vector<std::span<const double>>& columns) const {
+    size_t rows = columns.empty() ? 0 : columns[0].size();
+    for (const auto& column : columns) {
+        rows = std::min(rows, column.size());
+    }
+    std::vector<std::vector<double>> results(compiled.getOutputCount(), std::vector<double>(rows));
+    std::vector<std::span<double>> outputs(results.begin(), results.end());
+    for (auto& error : evaluate(columns, outputs)) {
+        if (error) throw *error;
+    }
+    return results;
+}
+
+// Like BatchEvaluator::evaluateChunk, but a failure travels with the value
+// it poisons instead of stopping the chunk, so every output gets its own
+// error. Merging keeps the lowest lane, and on equal lanes the earlier
+// instruction (the order ASTNode::evaluate visits nodes in).
+void MultiExpressionEngine::evaluateChunk(const std::vector<std::span<const double>>& columns,
+                                          size_t start, size_t count,
+                                          const std::vector<std::span<double>>& outputs, double* buffers,
+                                          const double** operands, Failure* failures,
+                                          std::vector<std::optional<BatchEvaluationError>>& errors) const {
+    const auto& constants = compiled.getConstants();
+    size_t tempBase = std::max<size_t>(compiled.getMaxStackDepth(), 1);
+    double* temps = buffers + tempBase * CHUNK_SIZE;
+    const Failure none{count, nullptr};
+
+    auto mergeFailure = [](Failure& into, const Failure& other) {
+        if (other.lane < into.lane) into = other;
+    };
+
+    size_t sp = 0;
+    for (const Instruction& ins : compiled.getInstructions()) {
+        switch(ins.op) {
+            case OpCode::PUSH_CONST: {
+                double* out = buffers + sp * CHUNK_SIZE;
+                std::fill(out, out + count, constants[ins.operand]);
+                failures[sp] = none;
+                operands[sp++] = out;
+                break;
+            }
+            case OpCode::LOAD_VAR:
+                failures[sp] = none;
+                operands[sp++] = columns[ins.operand].data() + start;
+                break;
+            case OpCode::STORE_TEMP: {
+                double* out = temps + ins.operand * CHUNK_SIZE;
+                std::copy(operands[sp - 1], operands[sp - 1] + count, out);
+                failures[tempBase + ins.operand] = failures[sp - 1];
+                operands[sp - 1] = out;
+                break;
+            }
+            case OpCode::LOAD_TEMP:
+                failures[sp] = failures[tempBase + ins.operand];
+                operands[sp++] = temps + ins.operand * CHUNK_SIZE;
+                break;
+            case OpCode::STORE_OUTPUT: {
+                --sp;
+                std::copy(operands[sp], operands[sp] + count, outputs[ins.operand].data() + start);
+                // Chunks run in row order, so the first error kept is the lowest row
+                const Failure& failure = failures[sp];
+                if (failure.lane < count && !errors[ins.operand]) {
+                    errors[ins.operand].emplace(*failure.message, start + failure.lane);
+                }
+                break;
+            }
+
+            case OpCode::ADD:
+            case OpCode::SUBTRACT:
+            case OpCode::MULTIPLY:
+            case OpCode::DIVIDE:
+            case OpCode::POWER: {
+                --sp;
+                const double* a = operands[sp - 1];
+                const double* b = operands[sp];
+                double* out = buffers + (sp - 1) * CHUNK_SIZE;
+                Failure& failure = failures[sp - 1];
+                mergeFailure(failure, failures[sp]);
+                switch(ins.op) {
+                    case OpCode::ADD: SimdKernels::add(a, b, out, count); break;
+                    case OpCode::SUBTRACT: SimdKernels::subtract(a, b, out, count); break;
+                    case OpCode::MULTIPLY: SimdKernels::multiply(a, b, out, count); break;
+                    case OpCode::DIVIDE:
+                        mergeFailure(failure, {SimdKernels::divide(a, b, out, count), &divisionByZero});
+                        break;
+                    default: SimdKernels::power(a, b, out, count); break;
+                }
+                operands[sp - 1] = out;
+                break;
+            }
+
+            case OpCode::NEGATIVE:
+            case OpCode::SIN:
+            case OpCode::COS:
+            case OpCode::SQRT:
+            case OpCode::LOG:
+            case OpCode::EXP:
+            case OpCode::ABS: {
+                const double* a = operands[sp - 1];
+                double* out = buffers + (sp - 1) * CHUNK_SIZE;
+                Failure& failure = failures[sp - 1];
+                switch(ins.op) {
+                    case OpCode::NEGATIVE: SimdKernels::negative(a, out, count); break;
+                    case OpCode::SIN: SimdKernels::sin(a, out, count); break;
+                    case OpCode::COS: SimdKernels::cos(a, out, count); break;
+                    case OpCode::SQRT:
+                        mergeFailure(failure, {SimdKernels::sqrt(a, out, count), &negativeSqrt});
+                        break;
+                    case OpCode::LOG:
+                        mergeFailure(failure, {SimdKernels::log(a, out, count), &nonPositiveLog});
+                        break;
+                    case OpCode::EXP: SimdKernels::exp(a, out, count); break;
+                    default: SimdKernels::abs(a, out, count); break;
+                }
+                operands[sp - 1] = out;
+                break;
+            }
+
+            case OpCode::RAISE: {
+                // Every row fails, unless an operand already failed on row 0
+                Failure failure = none;
+                for (size_t i = sp - ins.pops; i < sp; ++i) mergeFailure(failure, failures[i]);
+                mergeFailure(failure, {0, &compiled.getErrorMessages()[ins.operand]});
+                sp = sp - ins.pops + 1;
+                failures[sp - 1] = failure;
+                operands[sp - 1] = buffers + (sp - 1) * CHUNK_SIZE;
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef MULTI_EXPRESSION_ENGINE_H
+#define MULTI_EXPRESSION_ENGINE_H
+
+#include "BatchEvaluator.h"
+#include "CompiledExpression.h"
+#include <optional>
+#include <span>
+#include <vector>
+
+// Evaluates a set of expressions over the same rows in one pass. The
+// expressions are hash-consed together and compiled into a single program, so
+// each variable column is read and each common subexpression computed once
+// per chunk of rows while that chunk is still in cache.
+class MultiExpressionEngine {
+public:
+    static constexpr size_t CHUNK_SIZE = BatchEvaluator::CHUNK_SIZE;
+
+    explicit MultiExpressionEngine(const std::vector<ASTNodePtr>& expressions);
+
+    // Union of all variables, in column order
+    const std::vector<std::string>& getVariables() const { return compiled.getVariables(); }
+    size_t getExpressionCount() const { return compiled.getOutputCount(); }
+    const CompiledExpression& getCompiled() const { return compiled; }
+
+    // Node counts of the expressions as given versus after merging
+    size_t getTotalNodes() const { return totalNodes; }
+    size_t getUniqueNodes() const { return uniqueNodes; }
+
+    // Evaluate all rows; outputs[i] receives expression i. Expressions fail
+    // independently: entry i is empty on success, otherwise the error a
+    // BatchEvaluator for expression i alone would throw (rows of that output
+    // after the failing one are unspecified).
+    std::vector<std::optional<BatchEvaluationError>> evaluate(const std::vector<std::span<const double>>& columns,
+                                                              const std::vector<std::span<double>>& outputs) const;
+
+    // One new column per expression; throws the error of the first failing
+    // expression in input order
+    std::vector<std::vector<double>> evaluate(const std::vector<std::span<const double>>& columns) const;
+
+private:
+    size_t totalNodes = 0;      // set while building `compiled`, so declared first
+    size_t uniqueNodes = 0;
+    CompiledExpression compiled;
+
+    static std::vector<ASTNodePtr> merge(const std::vector<ASTNodePtr>& expressions,
+                                         size_t& totalNodes, size_t& uniqueNodes);
+
+    // Lowest failing lane of a register's rows and its message (lane == count: none)
+    struct Failure {
+        size_t lane;
+        const std::string* message;
+    };
+
+    void evaluateChunk(const std::vector<std::span<const double>>& columns, size_t start, size_t count,
+                       const std::vector<std::span<double>>& outputs, double* buffers,
+                       const double** operands, Failure* failures,
+                       std::vector<std::optional<BatchEvaluationError>>& errors) const;
+};
+
+#endif // MULTI_EXPRESSION_ENGINE_H
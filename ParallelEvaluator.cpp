@@ -0,0 +1,54 @@
+#include "ParallelEvaluator.h"
+#include <algorithm>
+#include <atomic>
+#include <optional>
+
+ParallelEvaluator::ParallelEvaluator(const ASTNodePtr& ast, size_t workerCount, size_t taskRows)
+    : batch(ast), pool(workerCount),
+      taskRows(std::max<size_t>((taskRows + BatchEvaluator::CHUNK_SIZE - 1) / BatchEvaluator::CHUNK_SIZE, 1) *
+               BatchEvaluator::CHUNK_SIZE) {}
+
+void ParallelEvaluator::evaluate(const std::vector<std::span<const double>>& columns,
+                                 std::span<double> output) const {
+    batch.checkColumns(columns, output.size());
+    size_t rows = output.size();
+    size_t taskCount = (rows + taskRows - 1) / taskRows;
+
+    // Tasks past a known failure cannot hold the lowest failing row, so they
+    // are skipped; each failing task keeps its own error and the lowest wins
+    std::atomic<size_t> firstFailure{rows};
+    std::vector<std::optional<BatchEvaluationError>> errors(taskCount);
+
+    pool.run(taskCount, [&](size_t task) {
+        size_t start = task * taskRows;
+        if (start > firstFailure.load(std::memory_order_relaxed)) return;
+        size_t count = std::min(taskRows, rows - start);
+
+        std::vector<std::span<const double>> slice;
+        slice.reserve(columns.size());
+        for (const auto& column : columns) slice.push_back(column.subspan(start, count));
+
+        try {
+            batch.evaluate(slice, output.subspan(start, count));
+        } catch (const BatchEvaluationError& e) {
+            size_t row = start + e.getRow();
+            errors[task].emplace(e.what(), row);
+            size_t known = firstFailure.load(std::memory_order_relaxed);
+            while (row < known && !firstFailure.compare_exchange_weak(known, row, std::memory_order_relaxed)) {}
+        }
+    });
+
+    for (const auto& error : errors) {
+        if (error) throw *error;
+    }
+}
+
+std::vector<double> ParallelEvaluator::evaluate(const std::vector<std::span<const double>>& columns) const {
+    size_t rows = columns.empty() ? 0 : columns[0].size();
+    for (const auto& column : columns) {
+        rows = std::min(rows, column.size());
+    }
+    std::vector<double> output(rows);
+    evaluate(columns, output);
+    return output;
+}
@@ -0,0 +1,40 @@
+#ifndef PARALLEL_EVALUATOR_H
+#define PARALLEL_EVALUATOR_H
+
+#include "BatchEvaluator.h"
+#include "WorkStealingPool.h"
+#include <span>
+#include <vector>
+
+// Multi-core BatchEvaluator: rows are split into tasks of a fixed number of
+// rows, run on a WorkStealingPool, and each task writes its own slice of the
+// caller's output array. Task sizes are whole multiples of
+// BatchEvaluator::CHUNK_SIZE, so neighbouring tasks share at most the one
+// cache line their boundary falls in.
+class ParallelEvaluator {
+public:
+    static constexpr size_t DEFAULT_TASK_ROWS = 32 * BatchEvaluator::CHUNK_SIZE;
+
+    // workerCount == 0 uses every hardware thread; taskRows is rounded up to
+    // a multiple of BatchEvaluator::CHUNK_SIZE
+    explicit ParallelEvaluator(const ASTNodePtr& ast, size_t workerCount = 0,
+                               size_t taskRows = DEFAULT_TASK_ROWS);
+
+    const std::vector<std::string>& getVariables() const { return batch.getVariables(); }
+    size_t getWorkerCount() const { return pool.getWorkerCount(); }
+    size_t getTaskRows() const { return taskRows; }
+    const WorkStealingPool& getPool() const { return pool; }
+
+    // Same contract as BatchEvaluator::evaluate: throws BatchEvaluationError for
+    // the lowest failing row over the whole input, whatever order tasks finish
+    // in. Output rows after that one are unspecified.
+    void evaluate(const std::vector<std::span<const double>>& columns, std::span<double> output) const;
+    std::vector<double> evaluate(const std::vector<std::span<const double>>& columns) const;
+
+private:
+    BatchEvaluator batch;
+    mutable WorkStealingPool pool;
+    size_t taskRows;
+};
+
+#endif // PARALLEL_EVALUATOR_H
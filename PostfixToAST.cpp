@@ -1,35 +1,79 @@
 #include "PostfixToAST.h"
+#include "ExpressionProfiler.h"
 #include <sstream>
 #include <cctype>
 #include <stdexcept>
 #include <algorithm>
+#include <charconv>
 #include <unordered_set>
 
-// Initialize valid functions set
-const std::unordered_set<std::string> PostfixToAST::validFunctions = {
-    "sin", "cos", "tan", "sqrt", "log", "exp", "abs", "min", "max"
-};
+// A postfix expression must leave exactly one tree on the stack
+static ParseError stackSizeError(size_t size) {
+    return {ErrorCode::INVALID_EXPRESSION, "Invalid postfix expression: Stack has " +
+                                           std::to_string(size) + " elements instead of 1"};
+}
 
 // Convert postfix expression (vector of tokens) to AST
 ASTNodePtr PostfixToAST::convert(const std::vector<std::string>& postfixTokens) {
+    auto ast = tryConvert(postfixTokens);
+    if (!ast) throw std::runtime_error(ast.error().message);
+    return *ast;
+}
+
+// Convert postfix string to AST
+ASTNodePtr PostfixToAST::convert(const std::string& postfixExpression) {
+    auto ast = tryConvert(postfixExpression);
+    if (!ast) throw std::runtime_error(ast.error().message);
+    return *ast;
+}
+
+// Convert postfix string to an arena-backed AST
+const ArenaNode* PostfixToAST::convert(std::string_view postfixExpression, ExpressionArena& arena) {
+    auto ast = tryConvert(postfixExpression, arena);
+    if (!ast) throw std::runtime_error(ast.error().message);
+    return *ast;
+}
+
+Expected<ASTNodePtr, ParseError> PostfixToAST::tryConvert(const std::vector<std::string>& postfixTokens) {
     std::stack<ASTNodePtr> stack;
+    ParseError error;
     
     for (const auto& token : postfixTokens) {
-        processToken(token, stack);
+        if (!processToken({token, PostfixTokenizer::classify(token)}, stack, error)) return Unexpected(error);
     }
     
-    if (stack.size() != 1) {
-        throw std::runtime_error("Invalid postfix expression: Stack has " + 
-                                std::to_string(stack.size()) + " elements instead of 1");
+    if (stack.size() != 1) return Unexpected(stackSizeError(stack.size()));
+    return stack.top();
+}
+
+// Tokens are views, no token vector
+Expected<ASTNodePtr, ParseError> PostfixToAST::tryConvert(const std::string& postfixExpression) {
+    std::stack<ASTNodePtr> stack;
+    ParseError error;
+    PostfixTokenizer tokenizer(postfixExpression);
+    PostfixToken token;
+    
+    while (tokenizer.next(token)) {
+        if (!processToken(token, stack, error)) return Unexpected(error);
     }
     
+    if (stack.size() != 1) return Unexpected(stackSizeError(stack.size()));
     return stack.top();
 }
 
-// Convert postfix string to AST
-ASTNodePtr PostfixToAST::convert(const std::string& postfixExpression) {
-    std::vector<std::string> tokens = tokenize(postfixExpression);
-    return convert(tokens);
+Expected<const ArenaNode*, ParseError> PostfixToAST::tryConvert(std::string_view postfixExpression,
+                                                               ExpressionArena& arena) {
+    std::vector<const ArenaNode*> stack;
+    ParseError error;
+    PostfixTokenizer tokenizer(postfixExpression);
+    PostfixToken token;
+    
+    while (tokenizer.next(token)) {
+        if (!processToken(token, stack, arena, error)) return Unexpected(error);
+    }
+    
+    if (stack.size() != 1) return Unexpected(stackSizeError(stack.size()));
+    return stack.back();
 }
 
 // Tokenize a space-separated postfix expression
@@ -51,21 +95,21 @@ std::vector<std::string> PostfixToAST::tokenize(const std::string& expression) {
 }
 
 // Check if token is an operator
-bool PostfixToAST::isOperator(const std::string& token) {
+bool PostfixToAST::isOperator(std::string_view token) {
     return token == "+" || token == "-" || token == "*" || 
            token == "/" || token == "^" || token == "~"; // ~ for unary minus
 }
 
 // Check if token is a unary operator
-bool PostfixToAST::isUnaryOperator(const std::string& token) {
+bool PostfixToAST::isUnaryOperator(std::string_view token) {
     return token == "~";
 }
 
 // Check if token is a number (including negative numbers)
-bool PostfixToAST::isNumber(const std::string& token) {
+bool PostfixToAST::isNumber(std::string_view token) {
     if (token.empty()) return false;
     
-    std::string_view view(token);
+    std::string_view view = token;
     
     // Handle negative numbers
     bool hasSign = false;
@@ -93,7 +137,7 @@ bool PostfixToAST::isNumber(const std::string& token) {
 }
 
 // Check if token is a variable (starts with letter, contains letters/numbers/underscores)
-bool PostfixToAST::isVariable(const std::string& token) {
+bool PostfixToAST::isVariable(std::string_view token) {
     if (token.empty() || !std::isalpha(token[0]) && token[0] != '_') {
         return false;
     }
@@ -107,13 +151,29 @@ bool PostfixToAST::isVariable(const std::string& token) {
     return true;
 }
 
-// Check if token is a function name
-bool PostfixToAST::isFunction(const std::string& token) {
-    return validFunctions.find(token) != validFunctions.end();
+// Check if token is a function name (sin, cos, tan, sqrt, log, exp, abs, min, max)
+bool PostfixToAST::isFunction(std::string_view token) {
+    switch(token.size()) {
+        case 3:
+            switch(token[0]) {
+                case 's': return token == "sin";
+                case 'c': return token == "cos";
+                case 't': return token == "tan";
+                case 'l': return token == "log";
+                case 'e': return token == "exp";
+                case 'a': return token == "abs";
+                case 'm': return token == "min" || token == "max";
+                default: return false;
+            }
+        case 4:
+            return token == "sqrt";
+        default:
+            return false;
+    }
 }
 
 // Convert string operator to OperatorType
-OperatorType PostfixToAST::stringToOperator(const std::string& op) {
+OperatorType PostfixToAST::stringToOperator(std::string_view op) {
     if (op == "+") return OperatorType::ADD;
     if (op == "-") return OperatorType::SUBTRACT;
     if (op == "*") return OperatorType::MULTIPLY;
@@ -121,7 +181,7 @@ OperatorType PostfixToAST::stringToOperator(const std::string& op) {
     if (op == "^") return OperatorType::POWER;
     if (op == "~") return OperatorType::NEGATIVE;
     
-    throw std::runtime_error("Unknown operator: " + op);
+    throw std::runtime_error("Unknown operator: " + std::string(op));
 }
 
 // Extract variables from postfix expression
@@ -129,7 +189,7 @@ std::vector<std::string> PostfixToAST::extractVariables(const std::vector<std::s
     std::vector<std::string> variables;
     
     for (const auto& token : postfixTokens) {
-        if (isVariable(token)) {
+        if (PostfixTokenizer::classify(token) == TokenKind::VARIABLE) {
             variables.push_back(token);
         }
     }
@@ -177,32 +237,55 @@ bool PostfixToAST::validateVariables(const ASTNodePtr& ast,
     return true;
 }
 
-// Process a single token
-void PostfixToAST::processToken(const std::string& token, std::stack<ASTNodePtr>& stack) {
-    if (isNumber(token)) {
-        // Push number node
-        double value = std::stod(token);
-        stack.push(ASTNode::createNumber(value));
-    } 
-    else if (isVariable(token)) {
-        // Push variable node
-        stack.push(ASTNode::createVariable(token));
-    }
-    else if (isOperator(token)) {
-        if (isUnaryOperator(token)) {
+// Parse a token classified as NUMBER; false if it is not a valid double
+bool PostfixToAST::parseNumber(std::string_view token, double& value) {
+    auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), value);
+    return error == std::errc() && end == token.data() + token.size();
+}
+
+// Error for a token that could not be applied
+static bool tokenError(ParseError& error, ErrorCode code, const std::string& message) {
+    error = {code, message};
+    return false;
+}
+
+// Process a single token; returns false with `error` set if it cannot be applied
+bool PostfixToAST::processToken(const PostfixToken& token, std::stack<ASTNodePtr>& stack, ParseError& error) {
+    PROFILE_PARSE_TOKEN(token.kind);
+    auto fail = [&](ErrorCode code, const std::string& message) {
+        PROFILE_PARSE_FAIL();
+        return tokenError(error, code, message + std::string(token.text));
+    };
+    switch(token.kind) {
+        case TokenKind::NUMBER: {
+            // Push number node
+            double value = 0;
+            if (!parseNumber(token.text, value)) return fail(ErrorCode::INVALID_NUMBER, "Invalid number: ");
+            stack.push(ASTNode::createNumber(value));
+            break;
+        }
+            
+        case TokenKind::VARIABLE:
+            // Push variable node
+            stack.push(ASTNode::createVariable(std::string(token.text)));
+            break;
+            
+        case TokenKind::UNARY_OPERATOR: {
             // Unary operator (e.g., unary minus)
             if (stack.empty()) {
-                throw std::runtime_error("Not enough operands for unary operator: " + token);
+                return fail(ErrorCode::MISSING_OPERAND, "Not enough operands for unary operator: ");
             }
             
             ASTNodePtr operand = stack.top();
             stack.pop();
-            stack.push(ASTNode::createUnaryOp(stringToOperator(token), operand));
-        } 
-        else {
+            stack.push(ASTNode::createUnaryOp(stringToOperator(token.text), operand));
+            break;
+        }
+            
+        case TokenKind::OPERATOR: {
             // Binary operator
             if (stack.size() < 2) {
-                throw std::runtime_error("Not enough operands for binary operator: " + token);
+                return fail(ErrorCode::MISSING_OPERAND, "Not enough operands for binary operator: ");
             }
             
             ASTNodePtr right = stack.top();
@@ -210,22 +293,80 @@ void PostfixToAST::processToken(const std::string& token, std::stack<ASTNodePtr>
             ASTNodePtr left = stack.top();
             stack.pop();
             
-            stack.push(ASTNode::createBinaryOp(stringToOperator(token), left, right));
+            stack.push(ASTNode::createBinaryOp(stringToOperator(token.text), left, right));
+            break;
         }
-    }
-    else if (isFunction(token)) {
-        // Function call - for postfix, functions come after their arguments
-        // For simplicity, we'll assume functions take one argument in postfix
-        if (stack.empty()) {
-            throw std::runtime_error("Not enough arguments for function: " + token);
+            
+        case TokenKind::FUNCTION: {
+            // Function call - for postfix, functions come after their arguments
+            // For simplicity, we'll assume functions take one argument in postfix
+            if (stack.empty()) {
+                return fail(ErrorCode::MISSING_OPERAND, "Not enough arguments for function: ");
+            }
+            
+            ASTNodePtr arg = stack.top();
+            stack.pop();
+            std::vector<ASTNodePtr> args = {arg};
+            stack.push(ASTNode::createFunctionCall(std::string(token.text), args));
+            break;
         }
-        
-        ASTNodePtr arg = stack.top();
-        stack.pop();
-        std::vector<ASTNodePtr> args = {arg};
-        stack.push(ASTNode::createFunctionCall(token, args));
+            
+        default:
+            return fail(ErrorCode::INVALID_TOKEN, "Invalid token: ");
     }
-    else {
-        throw std::runtime_error("Invalid token: " + token);
+    return true;
+}
+
+// Process a single token into arena nodes (same rules as the shared_ptr overload)
+bool PostfixToAST::processToken(const PostfixToken& token, std::vector<const ArenaNode*>& stack,
+                                ExpressionArena& arena, ParseError& error) {
+    PROFILE_PARSE_TOKEN(token.kind);
+    auto fail = [&](ErrorCode code, const std::string& message) {
+        PROFILE_PARSE_FAIL();
+        return tokenError(error, code, message + std::string(token.text));
+    };
+    switch(token.kind) {
+        case TokenKind::NUMBER: {
+            double value = 0;
+            if (!parseNumber(token.text, value)) return fail(ErrorCode::INVALID_NUMBER, "Invalid number: ");
+            stack.push_back(arena.createNumber(value));
+            break;
+        }
+            
+        case TokenKind::VARIABLE:
+            stack.push_back(arena.createVariable(token.text));
+            break;
+            
+        case TokenKind::UNARY_OPERATOR:
+            if (stack.empty()) {
+                return fail(ErrorCode::MISSING_OPERAND, "Not enough operands for unary operator: ");
+            }
+            stack.back() = arena.createUnaryOp(stringToOperator(token.text), stack.back());
+            break;
+            
+        case TokenKind::OPERATOR: {
+            if (stack.size() < 2) {
+                return fail(ErrorCode::MISSING_OPERAND, "Not enough operands for binary operator: ");
+            }
+            
+            const ArenaNode* right = stack.back();
+            stack.pop_back();
+            stack.back() = arena.createBinaryOp(stringToOperator(token.text), stack.back(), right);
+            break;
+        }
+            
+        case TokenKind::FUNCTION: {
+            if (stack.empty()) {
+                return fail(ErrorCode::MISSING_OPERAND, "Not enough arguments for function: ");
+            }
+            
+            const ArenaNode* arg = stack.back();
+            stack.back() = arena.createFunctionCall(token.text, {&arg, 1});
+            break;
+        }
+            
+        default:
+            return fail(ErrorCode::INVALID_TOKEN, "Invalid token: ");
     }
-}
\ No newline at end of file
+    return true;
+}
@@ -1,12 +1,15 @@
 #ifndef POSTFIX_TO_AST_H
 #define POSTFIX_TO_AST_H
 
-#include "ast_node.h"
+#include "AST_NODE.h"
+#include "ExpressionArena.h"
+#include "Expected.h"
+#include "PostfixTokenizer.h"
 #include <vector>
 #include <string>
 #include <stack>
 #include <memory>
-#include <unordered_set>
+#include <string_view>
 
 class PostfixToAST {
 public:
@@ -16,14 +19,23 @@ public:
     // Convert postfix string (space-separated) to AST
     static ASTNodePtr convert(const std::string& postfixExpression);
     
+    // Convert postfix string to an AST whose nodes live in an arena
+    static const ArenaNode* convert(std::string_view postfixExpression, ExpressionArena& arena);
+    
+    // Same conversions, returning the error instead of throwing it
+    static Expected<ASTNodePtr, ParseError> tryConvert(const std::vector<std::string>& postfixTokens);
+    static Expected<ASTNodePtr, ParseError> tryConvert(const std::string& postfixExpression);
+    static Expected<const ArenaNode*, ParseError> tryConvert(std::string_view postfixExpression,
+                                                             ExpressionArena& arena);
+    
     // Helper functions
     static std::vector<std::string> tokenize(const std::string& expression);
-    static bool isOperator(const std::string& token);
-    static bool isUnaryOperator(const std::string& token);
-    static bool isNumber(const std::string& token);
-    static bool isVariable(const std::string& token);
-    static bool isFunction(const std::string& token);
-    static OperatorType stringToOperator(const std::string& op);
+    static bool isOperator(std::string_view token);
+    static bool isUnaryOperator(std::string_view token);
+    static bool isNumber(std::string_view token);
+    static bool isVariable(std::string_view token);
+    static bool isFunction(std::string_view token);
+    static OperatorType stringToOperator(std::string_view op);
     
     // Variable extraction
     static std::vector<std::string> extractVariables(const std::vector<std::string>& postfixTokens);
@@ -34,11 +46,13 @@ public:
                                  const std::vector<std::pair<std::string, double>>& variables);
     
 private:
-    // Process a token from postfix expression
-    static void processToken(const std::string& token, std::stack<ASTNodePtr>& stack);
+    // Process a token from postfix expression; false (with error set) if it cannot be applied
+    static bool processToken(const PostfixToken& token, std::stack<ASTNodePtr>& stack, ParseError& error);
+    static bool processToken(const PostfixToken& token, std::vector<const ArenaNode*>& stack,
+                             ExpressionArena& arena, ParseError& error);
     
-    // Valid function names
-    static const std::unordered_set<std::string> validFunctions;
+    // Parse a token classified as NUMBER; false if it is not a valid double
+    static bool parseNumber(std::string_view token, double& value);
 };
 
 #endif // POSTFIX_TO_AST_H
\ No newline at end of file
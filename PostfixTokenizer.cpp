@@ -0,0 +1,29 @@
+#include "PostfixTokenizer.h"
+#include "PostfixToAST.h"
+#include <cctype>
+
+// Read the next whitespace-separated token
+bool PostfixTokenizer::next(PostfixToken& token) {
+    auto isSpace = [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; };
+
+    while (pos < expression.size() && isSpace(expression[pos])) ++pos;
+    if (pos >= expression.size()) return false;
+
+    size_t start = pos;
+    while (pos < expression.size() && !isSpace(expression[pos])) ++pos;
+
+    token.text = expression.substr(start, pos - start);
+    token.kind = classify(token.text);
+    return true;
+}
+
+// Classify a token; any identifier is a variable, so a variable may share a
+// function's name ("max 2 *")
+TokenKind PostfixTokenizer::classify(std::string_view token) {
+    if (PostfixToAST::isNumber(token)) return TokenKind::NUMBER;
+    if (PostfixToAST::isVariable(token)) return TokenKind::VARIABLE;
+    if (PostfixToAST::isFunction(token)) return TokenKind::FUNCTION;
+    if (PostfixToAST::isUnaryOperator(token)) return TokenKind::UNARY_OPERATOR;
+    if (PostfixToAST::isOperator(token)) return TokenKind::OPERATOR;
+    return TokenKind::INVALID;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#ifndef POSTFIX_TOKENIZER_H
+#define POSTFIX_TOKENIZER_H
+
+#include <cstdint>
+#include <string_view>
+
+// Token classes, in the priority order used by PostfixToAST
+enum class TokenKind : std::uint8_t {
+    NUMBER,
+    VARIABLE,
+    FUNCTION,
+    OPERATOR,
+    UNARY_OPERATOR,
+    INVALID
+};
+
+// Token viewing the caller's buffer
+struct PostfixToken {
+    std::string_view text;
+    TokenKind kind;
+};
+
+// Zero-copy tokenizer for space-separated postfix expressions. Tokens are
+// views into the input, which must outlive them.
+class PostfixTokenizer {
+public:
+    explicit PostfixTokenizer(std::string_view expression) : expression(expression) {}
+
+    // Read the next token; returns false at the end of the input
+    bool next(PostfixToken& token);
+
+    // Classify a single token
+    static TokenKind classify(std::string_view token);
+
+private:
+    std::string_view expression;
+    size_t pos = 0;
+};
+
+#endif // POSTFIX_TOKENIZER_H
\ No newline at end of file
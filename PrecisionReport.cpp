@@ -0,0 +1,104 @@
+#include "PrecisionReport.h"
+#include "BatchEvaluator.h"
+#include "TypedExpression.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+
+static bool isMarked(const std::vector<std::uint64_t>& failed, size_t row) {
+    return (failed[row / 64] >> (row % 64)) & 1;
+}
+
+static double relativeError(double value, double reference) {
+    return std::abs(value - reference) / std::max(std::abs(reference), double(std::numeric_limits<float>::min()));
+}
+
+PrecisionReport PrecisionReport::measure(const ASTNodePtr& ast, const std::vector<std::span<const double>>& columns,
+                                         size_t sampleRows, double tolerance) {
+    BatchEvaluator reference(ast);
+    FloatBatchEvaluator single(ast);
+    TypedExpression<long double> extended(ast);
+
+    // A constant expression has no columns; one row covers it
+    size_t rows = columns.empty() ? 1 : columns[0].size();
+    for (const auto& column : columns) rows = std::min(rows, column.size());
+    reference.checkColumns(columns, rows);
+
+    PrecisionReport report;
+    report.tolerance = tolerance;
+    report.sampledRows = std::min(rows, sampleRows);
+    size_t sampled = report.sampledRows;
+
+    // Sample row i is input row i * rows / sampled
+    std::vector<size_t> inputRows(sampled);
+    for (size_t i = 0; i < sampled; ++i) inputRows[i] = i * rows / sampled;
+
+    std::vector<std::vector<double>> doubleData(columns.size(), std::vector<double>(sampled));
+    std::vector<std::vector<float>> floatData(columns.size(), std::vector<float>(sampled));
+    for (size_t c = 0; c < columns.size(); ++c) {
+        for (size_t i = 0; i < sampled; ++i) {
+            doubleData[c][i] = columns[c][inputRows[i]];
+            floatData[c][i] = static_cast<float>(columns[c][inputRows[i]]);
+        }
+    }
+    std::vector<std::span<const double>> doubleColumns(doubleData.begin(), doubleData.end());
+    std::vector<std::span<const float>> floatColumns(floatData.begin(), floatData.end());
+
+    std::vector<double> doubleResults(sampled);
+    std::vector<float> floatResults(sampled);
+    std::vector<std::uint64_t> doubleFailed, floatFailed;
+    reference.evaluateIEEE(doubleColumns, doubleResults, doubleFailed);
+    single.evaluateIEEE(floatColumns, floatResults, floatFailed);
+
+    double relativeSum = 0;
+    std::vector<long double> slots(columns.size());
+    for (size_t i = 0; i < sampled; ++i) {
+        bool doubleOk = !isMarked(doubleFailed, i) && std::isfinite(doubleResults[i]);
+        bool floatOk = !isMarked(floatFailed, i) && std::isfinite(floatResults[i]);
+        if (!doubleOk || !floatOk) {
+            // Both failing is agreement; so are equal infinities or two NaNs
+            bool bothFailed = isMarked(doubleFailed, i) && isMarked(floatFailed, i);
+            bool sameNonFinite = !doubleOk && !floatOk && !isMarked(doubleFailed, i) && !isMarked(floatFailed, i) &&
+                                 (doubleResults[i] == floatResults[i] ||
+                                  (std::isnan(doubleResults[i]) && std::isnan(floatResults[i])));
+            if (!bothFailed && !sameNonFinite) ++report.mismatchedRows;
+            continue;
+        }
+
+        double absolute = std::abs(double(floatResults[i]) - doubleResults[i]);
+        double relative = relativeError(floatResults[i], doubleResults[i]);
+        ++report.comparedRows;
+        relativeSum += relative;
+        report.maxAbsoluteError = std::max(report.maxAbsoluteError, absolute);
+        if (relative > tolerance) ++report.rowsOverTolerance;
+        if (relative > report.maxRelativeError || report.comparedRows == 1) {
+            report.maxRelativeError = relative;
+            report.worstRow = inputRows[i];
+        }
+
+        // The double reference against long double; a row can still fail
+        // there when a domain edge moves with the precision
+        for (size_t c = 0; c < columns.size(); ++c) slots[c] = doubleData[c][i];
+        try {
+            long double exact = extended.evaluate(slots.data());
+            report.referenceMaxRelativeError = std::max(report.referenceMaxRelativeError,
+                                                        relativeError(doubleResults[i], static_cast<double>(exact)));
+        } catch (const std::runtime_error&) {}
+    }
+    if (report.comparedRows) report.meanRelativeError = relativeSum / report.comparedRows;
+    return report;
+}
+
+void PrecisionReport::print(std::ostream& out) const {
+    out << "Sampled rows:           " << sampledRows << " (" << comparedRows << " compared)\n"
+        << std::scientific << std::setprecision(2)
+        << "Float vs double:        max abs " << maxAbsoluteError << ", max rel " << maxRelativeError
+        << " (row " << worstRow << "), mean rel " << meanRelativeError << "\n"
+        << "Over tolerance " << tolerance << ": " << rowsOverTolerance << " rows\n"
+        << "Mismatched rows:        " << mismatchedRows << "\n"
+        << "Double vs long double:  max rel " << referenceMaxRelativeError << "\n"
+        << std::defaultfloat << std::setprecision(6);
+}
@@ -0,0 +1,38 @@
+#ifndef PRECISION_REPORT_H
+#define PRECISION_REPORT_H
+
+#include "AST_NODE.h"
+#include <cstddef>
+#include <iosfwd>
+#include <span>
+#include <vector>
+
+// How far FloatBatchEvaluator results drift from the double reference over a
+// sample of rows. It also checks the reference itself against a long double
+// TypedExpression on the same rows. Relative errors divide by
+// max(|reference|, FLT_MIN), so values near zero are measured absolutely.
+struct PrecisionReport {
+    size_t sampledRows = 0;
+    size_t comparedRows = 0;             // finite in both precisions
+    size_t mismatchedRows = 0;           // failed or non-finite in only one precision, or different non-finite values
+    double maxAbsoluteError = 0;
+    double maxRelativeError = 0;
+    double meanRelativeError = 0;
+    size_t worstRow = 0;                 // input row with maxRelativeError
+    double tolerance = 0;
+    size_t rowsOverTolerance = 0;        // relative error above tolerance
+    double referenceMaxRelativeError = 0;   // double against long double
+
+    // Every compared row within tolerance and no mismatched rows
+    bool withinTolerance() const { return rowsOverTolerance == 0 && mismatchedRows == 0; }
+
+    void print(std::ostream& out) const;
+
+    // Evaluate up to sampleRows evenly spaced rows of the columns (one per
+    // variable in collectVariables() order, as for BatchEvaluator) in float
+    // and double and compare them. Throws BatchEvaluator::checkColumns errors.
+    static PrecisionReport measure(const ASTNodePtr& ast, const std::vector<std::span<const double>>& columns,
+                                   size_t sampleRows = 10000, double tolerance = 1e-5);
+};
+
+#endif // PRECISION_REPORT_H
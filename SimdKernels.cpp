@@ -0,0 +1,680 @@
+#include "SimdKernels.h"
+#include <cmath>
+#include <atomic>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+// Function table for one instruction set and element type
+template <typename T>
+struct KernelTable {
+    void (*add)(const T*, const T*, T*, size_t);
+    void (*subtract)(const T*, const T*, T*, size_t);
+    void (*multiply)(const T*, const T*, T*, size_t);
+    size_t (*divide)(const T*, const T*, T*, size_t);
+    void (*negative)(const T*, T*, size_t);
+    void (*abs)(const T*, T*, size_t);
+    size_t (*sqrt)(const T*, T*, size_t);
+    size_t (*firstNonPositive)(const T*, size_t);
+};
+
+// ---------------------------------------------------------------------------
+// Scalar kernels (also used for the tails of the vector loops)
+
+template <typename T>
+static void scalarAdd(const T* a, const T* b, T* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = a[i] + b[i];
+}
+
+template <typename T>
+static void scalarSubtract(const T* a, const T* b, T* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = a[i] - b[i];
+}
+
+template <typename T>
+static void scalarMultiply(const T* a, const T* b, T* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = a[i] * b[i];
+}
+
+template <typename T>
+static size_t scalarDivide(const T* a, const T* b, T* out, size_t n) {
+    size_t firstBad = n;
+    for (size_t i = 0; i < n; ++i) {
+        if (b[i] == 0 && firstBad == n) firstBad = i;
+        out[i] = a[i] / b[i];
+    }
+    return firstBad;
+}
+
+template <typename T>
+static void scalarNegative(const T* a, T* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = -a[i];
+}
+
+template <typename T>
+static void scalarAbs(const T* a, T* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = std::abs(a[i]);
+}
+
+template <typename T>
+static size_t scalarSqrt(const T* a, T* out, size_t n) {
+    size_t firstBad = n;
+    for (size_t i = 0; i < n; ++i) {
+        if (a[i] < 0 && firstBad == n) firstBad = i;
+        out[i] = std::sqrt(a[i]);
+    }
+    return firstBad;
+}
+
+template <typename T>
+static size_t scalarFirstNonPositive(const T* a, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        if (a[i] <= 0) return i;
+    }
+    return n;
+}
+
+template <typename T>
+static const KernelTable<T> scalarTable = {
+    scalarAdd<T>, scalarSubtract<T>, scalarMultiply<T>, scalarDivide<T>,
+    scalarNegative<T>, scalarAbs<T>, scalarSqrt<T>, scalarFirstNonPositive<T>
+};
+
+// Offset a tail failure index, keeping "no failure" as n
+static size_t mergeFailure(size_t firstBad, size_t offset, size_t tailBad, size_t n) {
+    if (firstBad != n) return firstBad;
+    return tailBad == n - offset ? n : offset + tailBad;
+}
+
+#ifdef SIMD_KERNELS_X86
+
+// ---------------------------------------------------------------------------
+// SSE2 kernels (2 double or 4 float lanes, baseline on x86-64)
+
+#define SIMD_BINARY_KERNEL(NAME, TARGET, TYPE, WIDTH, LOAD, STORE, OP, TAIL)    \
+    TARGET static void NAME(const TYPE* a, const TYPE* b, TYPE* out, size_t n) { \
+        size_t i = 0;                                                             \
+        for (; i + WIDTH <= n; i += WIDTH) {                                      \
+            STORE(out + i, OP(LOAD(a + i), LOAD(b + i)));                         \
+        }                                                                         \
+        TAIL(a + i, b + i, out + i, n - i);                                       \
+    }
+
+SIMD_BINARY_KERNEL(sse2Add, , double, 2, _mm_loadu_pd, _mm_storeu_pd, _mm_add_pd, scalarAdd)
+SIMD_BINARY_KERNEL(sse2Subtract, , double, 2, _mm_loadu_pd, _mm_storeu_pd, _mm_sub_pd, scalarSubtract)
+SIMD_BINARY_KERNEL(sse2Multiply, , double, 2, _mm_loadu_pd, _mm_storeu_pd, _mm_mul_pd, scalarMultiply)
+
+static size_t sse2Divide(const double* a, const double* b, double* out, size_t n) {
+    const __m128d zero = _mm_setzero_pd();
+    size_t firstBad = n;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d vb = _mm_loadu_pd(b + i);
+        int mask = _mm_movemask_pd(_mm_cmpeq_pd(vb, zero));
+        if (mask && firstBad == n) firstBad = i + __builtin_ctz(mask);
+        _mm_storeu_pd(out + i, _mm_div_pd(_mm_loadu_pd(a + i), vb));
+    }
+    return mergeFailure(firstBad, i, scalarDivide(a + i, b + i, out + i, n - i), n);
+}
+
+static void sse2Negative(const double* a, double* out, size_t n) {
+    const __m128d sign = _mm_set1_pd(-0.0);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(out + i, _mm_xor_pd(_mm_loadu_pd(a + i), sign));
+    }
+    scalarNegative(a + i, out + i, n - i);
+}
+
+static void sse2Abs(const double* a, double* out, size_t n) {
+    const __m128d sign = _mm_set1_pd(-0.0);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(out + i, _mm_andnot_pd(sign, _mm_loadu_pd(a + i)));
+    }
+    scalarAbs(a + i, out + i, n - i);
+}
+
+static size_t sse2Sqrt(const double* a, double* out, size_t n) {
+    const __m128d zero = _mm_setzero_pd();
+    size_t firstBad = n;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d va = _mm_loadu_pd(a + i);
+        int mask = _mm_movemask_pd(_mm_cmplt_pd(va, zero));
+        if (mask && firstBad == n) firstBad = i + __builtin_ctz(mask);
+        _mm_storeu_pd(out + i, _mm_sqrt_pd(va));
+    }
+    return mergeFailure(firstBad, i, scalarSqrt(a + i, out + i, n - i), n);
+}
+
+static size_t sse2FirstNonPositive(const double* a, size_t n) {
+    const __m128d zero = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        int mask = _mm_movemask_pd(_mm_cmple_pd(_mm_loadu_pd(a + i), zero));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + scalarFirstNonPositive(a + i, n - i);
+}
+
+static const KernelTable<double> sse2Table = {
+    sse2Add, sse2Subtract, sse2Multiply, sse2Divide,
+    sse2Negative, sse2Abs, sse2Sqrt, sse2FirstNonPositive
+};
+
+// Single precision: 4 lanes
+SIMD_BINARY_KERNEL(sse2AddFloat, , float, 4, _mm_loadu_ps, _mm_storeu_ps, _mm_add_ps, scalarAdd)
+SIMD_BINARY_KERNEL(sse2SubtractFloat, , float, 4, _mm_loadu_ps, _mm_storeu_ps, _mm_sub_ps, scalarSubtract)
+SIMD_BINARY_KERNEL(sse2MultiplyFloat, , float, 4, _mm_loadu_ps, _mm_storeu_ps, _mm_mul_ps, scalarMultiply)
+
+static size_t sse2DivideFloat(const float* a, const float* b, float* out, size_t n) {
+    const __m128 zero = _mm_setzero_ps();
+    size_t firstBad = n;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 vb = _mm_loadu_ps(b + i);
+        int mask = _mm_movemask_ps(_mm_cmpeq_ps(vb, zero));
+        if (mask && firstBad == n) firstBad = i + __builtin_ctz(mask);
+        _mm_storeu_ps(out + i, _mm_div_ps(_mm_loadu_ps(a + i), vb));
+    }
+    return mergeFailure(firstBad, i, scalarDivide(a + i, b + i, out + i, n - i), n);
+}
+
+static void sse2NegativeFloat(const float* a, float* out, size_t n) {
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(out + i, _mm_xor_ps(_mm_loadu_ps(a + i), sign));
+    }
+    scalarNegative(a + i, out + i, n - i);
+}
+
+static void sse2AbsFloat(const float* a, float* out, size_t n) {
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(out + i, _mm_andnot_ps(sign, _mm_loadu_ps(a + i)));
+    }
+    scalarAbs(a + i, out + i, n - i);
+}
+
+static size_t sse2SqrtFloat(const float* a, float* out, size_t n) {
+    const __m128 zero = _mm_setzero_ps();
+    size_t firstBad = n;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 va = _mm_loadu_ps(a + i);
+        int mask = _mm_movemask_ps(_mm_cmplt_ps(va, zero));
+        if (mask && firstBad == n) firstBad = i + __builtin_ctz(mask);
+        _mm_storeu_ps(out + i, _mm_sqrt_ps(va));
+    }
+    return mergeFailure(firstBad, i, scalarSqrt(a + i, out + i, n - i), n);
+}
+
+static size_t sse2FirstNonPositiveFloat(const float* a, size_t n) {
+    const __m128 zero = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int mask = _mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(a + i), zero));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + scalarFirstNonPositive(a + i, n - i);
+}
+
+static const KernelTable<float> sse2FloatTable = {
+    sse2AddFloat, sse2SubtractFloat, sse2MultiplyFloat, sse2DivideFloat,
+    sse2NegativeFloat, sse2AbsFloat, sse2SqrtFloat, sse2FirstNonPositiveFloat
+};
+
+// ---------------------------------------------------------------------------
+// AVX2 kernels (4 double or 8 float lanes)
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+SIMD_BINARY_KERNEL(avx2Add, AVX2_TARGET, double, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_add_pd, scalarAdd)
+SIMD_BINARY_KERNEL(avx2Subtract, AVX2_TARGET, double, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_sub_pd, scalarSubtract)
+SIMD_BINARY_KERNEL(avx2Multiply, AVX2_TARGET, double, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_mul_pd, scalarMultiply)
+
+AVX2_TARGET static size_t avx2Divide(const double* a, const double* b, double* out, size_t n) {
+    const __m256d zero = _mm256_setzero_pd();
+    size_t firstBad = n;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d vb = _mm256_loadu_pd(b + i);
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(vb, zero, _CMP_EQ_OQ));
+        if (mask && firstBad == n) firstBad = i + __builtin_ctz(mask);
+        _mm256_storeu_pd(out + i, _mm256_div_pd(_mm256_loadu_pd(a + i), vb));
+    }
+    return mergeFailure(firstBad, i, scalarDivide(a + i, b + i, out + i, n - i), n);
+}
+
+AVX2_TARGET static void avx2Negative(const double* a, double* out, size_t n) {
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_xor_pd(_mm256_loadu_pd(a + i), sign));
+    }
+    scalarNegative(a + i, out + i, n - i);
+}
+
+AVX2_TARGET static void avx2Abs(const double* a, double* out, size_t n) {
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_andnot_pd(sign, _mm256_loadu_pd(a + i)));
+    }
+    scalarAbs(a + i, out + i, n - i);
+}
+
+AVX2_TARGET static size_t avx2Sqrt(const double* a, double* out, size_t n) {
+    const __m256d zero = _mm256_setzero_pd();
+    size_t firstBad = n;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d va = _mm256_loadu_pd(a + i);
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(va, zero, _CMP_LT_OQ));
+        if (mask && firstBad == n) firstBad = i + __builtin_ctz(mask);
+        _mm256_storeu_pd(out + i, _mm256_sqrt_pd(va));
+    }
+    return mergeFailure(firstBad, i, scalarSqrt(a + i, out + i, n - i), n);
+}
+
+AVX2_TARGET static size_t avx2FirstNonPositive(const double* a, size_t n) {
+    const __m256d zero = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(a + i), zero, _CMP_LE_OQ));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + scalarFirstNonPositive(a + i, n - i);
+}
+
+static const KernelTable<double> avx2Table = {
+    avx2Add, avx2Subtract, avx2Multiply, avx2Divide,
+    avx2Negative, avx2Abs, avx2Sqrt, avx2FirstNonPositive
+};
+
+// Single precision: 8 lanes
+SIMD_BINARY_KERNEL(avx2AddFloat, AVX2_TARGET, float, 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_add_ps, scalarAdd)
+SIMD_BINARY_KERNEL(avx2SubtractFloat, AVX2_TARGET, float, 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_sub_ps, scalarSubtract)
+SIMD_BINARY_KERNEL(avx2MultiplyFloat, AVX2_TARGET, float, 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_mul_ps, scalarMultiply)
+
+AVX2_TARGET static size_t avx2DivideFloat(const float* a, const float* b, float* out, size_t n) {
+    const __m256 zero = _mm256_setzero_ps();
+    size_t firstBad = n;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 vb = _mm256_loadu_ps(b + i);
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(vb, zero, _CMP_EQ_OQ));
+        if (mask && firstBad == n) firstBad = i + __builtin_ctz(mask);
+        _mm256_storeu_ps(out + i, _mm256_div_ps(_mm256_loadu_ps(a + i), vb));
+    }
+    return mergeFailure(firstBad, i, scalarDivide(a + i, b + i, out + i, n - i), n);
+}
+
+AVX2_TARGET static void avx2NegativeFloat(const float* a, float* out, size_t n) {
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_xor_ps(_mm256_loadu_ps(a + i), sign));
+    }
+    scalarNegative(a + i, out + i, n - i);
+}
+
+AVX2_TARGET static void avx2AbsFloat(const float* a, float* out, size_t n) {
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_andnot_ps(sign, _mm256_loadu_ps(a + i)));
+    }
+    scalarAbs(a + i, out + i, n - i);
+}
+
+AVX2_TARGET static size_t avx2SqrtFloat(const float* a, float* out, size_t n) {
+    const __m256 zero = _mm256_setzero_ps();
+    size_t firstBad = n;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 va = _mm256_loadu_ps(a + i);
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(va, zero, _CMP_LT_OQ));
+        if (mask && firstBad == n) firstBad = i + __builtin_ctz(mask);
+        _mm256_storeu_ps(out + i, _mm256_sqrt_ps(va));
+    }
+    return mergeFailure(firstBad, i, scalarSqrt(a + i, out + i, n - i), n);
+}
+
+AVX2_TARGET static size_t avx2FirstNonPositiveFloat(const float* a, size_t n) {
+    const __m256 zero = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(a + i), zero, _CMP_LE_OQ));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + scalarFirstNonPositive(a + i, n - i);
+}
+
+static const KernelTable<float> avx2FloatTable = {
+    avx2AddFloat, avx2SubtractFloat, avx2MultiplyFloat, avx2DivideFloat,
+    avx2NegativeFloat, avx2AbsFloat, avx2SqrtFloat, avx2FirstNonPositiveFloat
+};
+
+// ---------------------------------------------------------------------------
+// AVX-512 kernels (8 double or 16 float lanes, comparisons produce mask registers)
+
+#define AVX512_TARGET __attribute__((target("avx512f")))
+
+SIMD_BINARY_KERNEL(avx512Add, AVX512_TARGET, double, 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_add_pd, scalarAdd)
+SIMD_BINARY_KERNEL(avx512Subtract, AVX512_TARGET, double, 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_sub_pd, scalarSubtract)
+SIMD_BINARY_KERNEL(avx512Multiply, AVX512_TARGET, double, 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_mul_pd, scalarMultiply)
+
+AVX512_TARGET static size_t avx512Divide(const double* a, const double* b, double* out, size_t n) {
+    const __m512d zero = _mm512_setzero_pd();
+    size_t firstBad = n;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d vb = _mm512_loadu_pd(b + i);
+        __mmask8 mask = _mm512_cmp_pd_mask(vb, zero, _CMP_EQ_OQ);
+        if (mask && firstBad == n) firstBad = i + __builtin_ctz(mask);
+        _mm512_storeu_pd(out + i, _mm512_div_pd(_mm512_loadu_pd(a + i), vb));
+    }
+    return mergeFailure(firstBad, i, scalarDivide(a + i, b + i, out + i, n - i), n);
+}
+
+AVX512_TARGET static void avx512Negative(const double* a, double* out, size_t n) {
+    const __m512i sign = _mm512_set1_epi64(static_cast<long long>(0x8000000000000000ULL));
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i va = _mm512_castpd_si512(_mm512_loadu_pd(a + i));
+        _mm512_storeu_pd(out + i, _mm512_castsi512_pd(_mm512_xor_epi64(va, sign)));
+    }
+    scalarNegative(a + i, out + i, n - i);
+}
+
+AVX512_TARGET static void avx512Abs(const double* a, double* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm512_storeu_pd(out + i, _mm512_abs_pd(_mm512_loadu_pd(a + i)));
+    }
+    scalarAbs(a + i, out + i, n - i);
+}
+
+AVX512_TARGET static size_t avx512Sqrt(const double* a, double* out, size_t n) {
+    const __m512d zero = _mm512_setzero_pd();
+    size_t firstBad = n;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d va = _mm512_loadu_pd(a + i);
+        __mmask8 mask = _mm512_cmp_pd_mask(va, zero, _CMP_LT_OQ);
+        if (mask && firstBad == n) firstBad = i + __builtin_ctz(mask);
+        // Zero-masking form with every lane set: same result, but no
+        // undefined passthrough register (GCC flags _mm512_sqrt_pd's)
+        _mm512_storeu_pd(out + i, _mm512_maskz_sqrt_pd(0xFF, va));
+    }
+    return mergeFailure(firstBad, i, scalarSqrt(a + i, out + i, n - i), n);
+}
+
+AVX512_TARGET static size_t avx512FirstNonPositive(const double* a, size_t n) {
+    const __m512d zero = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __mmask8 mask = _mm512_cmp_pd_mask(_mm512_loadu_pd(a + i), zero, _CMP_LE_OQ);
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + scalarFirstNonPositive(a + i, n - i);
+}
+
+static const KernelTable<double> avx512Table = {
+    avx512Add, avx512Subtract, avx512Multiply, avx512Divide,
+    avx512Negative, avx512Abs, avx512Sqrt, avx512FirstNonPositive
+};
+
+// Single precision: 16 lanes
+SIMD_BINARY_KERNEL(avx512AddFloat, AVX512_TARGET, float, 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_add_ps, scalarAdd)
+SIMD_BINARY_KERNEL(avx512SubtractFloat, AVX512_TARGET, float, 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_sub_ps, scalarSubtract)
+SIMD_BINARY_KERNEL(avx512MultiplyFloat, AVX512_TARGET, float, 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_mul_ps, scalarMultiply)
+
+AVX512_TARGET static size_t avx512DivideFloat(const float* a, const float* b, float* out, size_t n) {
+    const __m512 zero = _mm512_setzero_ps();
+    size_t firstBad = n;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 vb = _mm512_loadu_ps(b + i);
+        __mmask16 mask = _mm512_cmp_ps_mask(vb, zero, _CMP_EQ_OQ);
+        if (mask && firstBad == n) firstBad = i + __builtin_ctz(mask);
+        _mm512_storeu_ps(out + i, _mm512_div_ps(_mm512_loadu_ps(a + i), vb));
+    }
+    return mergeFailure(firstBad, i, scalarDivide(a + i, b + i, out + i, n - i), n);
+}
+
+AVX512_TARGET static void avx512NegativeFloat(const float* a, float* out, size_t n) {
+    const __m512i sign = _mm512_set1_epi32(static_cast<int>(0x80000000U));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i va = _mm512_castps_si512(_mm512_loadu_ps(a + i));
+        _mm512_storeu_ps(out + i, _mm512_castsi512_ps(_mm512_xor_epi32(va, sign)));
+    }
+    scalarNegative(a + i, out + i, n - i);
+}
+
+AVX512_TARGET static void avx512AbsFloat(const float* a, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_ps(out + i, _mm512_abs_ps(_mm512_loadu_ps(a + i)));
+    }
+    scalarAbs(a + i, out + i, n - i);
+}
+
+AVX512_TARGET static size_t avx512SqrtFloat(const float* a, float* out, size_t n) {
+    const __m512 zero = _mm512_setzero_ps();
+    size_t firstBad = n;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 va = _mm512_loadu_ps(a + i);
+        __mmask16 mask = _mm512_cmp_ps_mask(va, zero, _CMP_LT_OQ);
+        if (mask && firstBad == n) firstBad = i + __builtin_ctz(mask);
+        _mm512_storeu_ps(out + i, _mm512_maskz_sqrt_ps(0xFFFF, va));   // as in avx512Sqrt
+    }
+    return mergeFailure(firstBad, i, scalarSqrt(a + i, out + i, n - i), n);
+}
+
+AVX512_TARGET static size_t avx512FirstNonPositiveFloat(const float* a, size_t n) {
+    const __m512 zero = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __mmask16 mask = _mm512_cmp_ps_mask(_mm512_loadu_ps(a + i), zero, _CMP_LE_OQ);
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + scalarFirstNonPositive(a + i, n - i);
+}
+
+static const KernelTable<float> avx512FloatTable = {
+    avx512AddFloat, avx512SubtractFloat, avx512MultiplyFloat, avx512DivideFloat,
+    avx512NegativeFloat, avx512AbsFloat, avx512SqrtFloat, avx512FirstNonPositiveFloat
+};
+
+#endif // SIMD_KERNELS_X86
+
+// ---------------------------------------------------------------------------
+// Runtime dispatch
+
+// Widest level supported by this CPU
+static SimdKernels::Level detectLevel() {
+#ifdef SIMD_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SimdKernels::Level::AVX512;
+    if (__builtin_cpu_supports("avx2")) return SimdKernels::Level::AVX2;
+    return SimdKernels::Level::SSE2;
+#else
+    return SimdKernels::Level::SCALAR;
+#endif
+}
+
+static const KernelTable<double>* tableFor(SimdKernels::Level level) {
+    switch(level) {
+#ifdef SIMD_KERNELS_X86
+        case SimdKernels::Level::AVX512: return &avx512Table;
+        case SimdKernels::Level::AVX2: return &avx2Table;
+        case SimdKernels::Level::SSE2: return &sse2Table;
+#endif
+        default: return &scalarTable<double>;
+    }
+}
+
+static const KernelTable<float>* floatTableFor(SimdKernels::Level level) {
+    switch(level) {
+#ifdef SIMD_KERNELS_X86
+        case SimdKernels::Level::AVX512: return &avx512FloatTable;
+        case SimdKernels::Level::AVX2: return &avx2FloatTable;
+        case SimdKernels::Level::SSE2: return &sse2FloatTable;
+#endif
+        default: return &scalarTable<float>;
+    }
+}
+
+static const SimdKernels::Level supportedLevel = detectLevel();
+static std::atomic<SimdKernels::Level> currentLevel{supportedLevel};
+static std::atomic<const KernelTable<double>*> currentTable{tableFor(supportedLevel)};
+static std::atomic<const KernelTable<float>*> currentFloatTable{floatTableFor(supportedLevel)};
+
+// Instruction set selected for this process
+SimdKernels::Level SimdKernels::activeLevel() {
+    return currentLevel.load(std::memory_order_relaxed);
+}
+
+// Force a level (clamped to what the CPU supports)
+void SimdKernels::setLevel(Level level) {
+    if (static_cast<int>(level) > static_cast<int>(supportedLevel)) {
+        level = supportedLevel;
+    }
+    currentLevel.store(level, std::memory_order_relaxed);
+    currentTable.store(tableFor(level), std::memory_order_relaxed);
+    currentFloatTable.store(floatTableFor(level), std::memory_order_relaxed);
+}
+
+// Convert level to string
+std::string SimdKernels::levelToString(Level level) {
+    switch(level) {
+        case Level::SCALAR: return "scalar";
+        case Level::SSE2: return "SSE2";
+        case Level::AVX2: return "AVX2";
+        case Level::AVX512: return "AVX-512";
+        default: return "?";
+    }
+}
+
+static const KernelTable<double>& table() {
+    return *currentTable.load(std::memory_order_relaxed);
+}
+
+static const KernelTable<float>& floatTable() {
+    return *currentFloatTable.load(std::memory_order_relaxed);
+}
+
+void SimdKernels::add(const double* a, const double* b, double* out, size_t n) {
+    table().add(a, b, out, n);
+}
+
+void SimdKernels::subtract(const double* a, const double* b, double* out, size_t n) {
+    table().subtract(a, b, out, n);
+}
+
+void SimdKernels::multiply(const double* a, const double* b, double* out, size_t n) {
+    table().multiply(a, b, out, n);
+}
+
+size_t SimdKernels::divide(const double* a, const double* b, double* out, size_t n) {
+    return table().divide(a, b, out, n);
+}
+
+void SimdKernels::negative(const double* a, double* out, size_t n) {
+    table().negative(a, out, n);
+}
+
+void SimdKernels::abs(const double* a, double* out, size_t n) {
+    table().abs(a, out, n);
+}
+
+size_t SimdKernels::sqrt(const double* a, double* out, size_t n) {
+    return table().sqrt(a, out, n);
+}
+
+// Domain check is vectorized; the logarithm itself stays on libm so results
+// are bit-identical to ASTNode::evaluate
+size_t SimdKernels::log(const double* a, double* out, size_t n) {
+    size_t firstBad = table().firstNonPositive(a, n);
+    for (size_t i = 0; i < n; ++i) out[i] = std::log(a[i]);
+    return firstBad;
+}
+
+// pow, sin, cos and exp call libm per lane for bit-identical results
+void SimdKernels::power(const double* a, const double* b, double* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = std::pow(a[i], b[i]);
+}
+
+void SimdKernels::sin(const double* a, double* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = std::sin(a[i]);
+}
+
+void SimdKernels::cos(const double* a, double* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = std::cos(a[i]);
+}
+
+void SimdKernels::exp(const double* a, double* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = std::exp(a[i]);
+}
+
+// ---------------------------------------------------------------------------
+// Single precision (float libm routines for the per-lane functions)
+
+void SimdKernels::add(const float* a, const float* b, float* out, size_t n) {
+    floatTable().add(a, b, out, n);
+}
+
+void SimdKernels::subtract(const float* a, const float* b, float* out, size_t n) {
+    floatTable().subtract(a, b, out, n);
+}
+
+void SimdKernels::multiply(const float* a, const float* b, float* out, size_t n) {
+    floatTable().multiply(a, b, out, n);
+}
+
+size_t SimdKernels::divide(const float* a, const float* b, float* out, size_t n) {
+    return floatTable().divide(a, b, out, n);
+}
+
+void SimdKernels::negative(const float* a, float* out, size_t n) {
+    floatTable().negative(a, out, n);
+}
+
+void SimdKernels::abs(const float* a, float* out, size_t n) {
+    floatTable().abs(a, out, n);
+}
+
+size_t SimdKernels::sqrt(const float* a, float* out, size_t n) {
+    return floatTable().sqrt(a, out, n);
+}
+
+size_t SimdKernels::log(const float* a, float* out, size_t n) {
+    size_t firstBad = floatTable().firstNonPositive(a, n);
+    for (size_t i = 0; i < n; ++i) out[i] = std::log(a[i]);
+    return firstBad;
+}
+
+void SimdKernels::power(const float* a, const float* b, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = std::pow(a[i], b[i]);
+}
+
+void SimdKernels::sin(const float* a, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = std::sin(a[i]);
+}
+
+void SimdKernels::cos(const float* a, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = std::cos(a[i]);
+}
+
+void SimdKernels::exp(const float* a, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = std::exp(a[i]);
+}
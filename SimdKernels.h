@@ -0,0 +1,58 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include <cstddef>
+#include <string>
+
+// Element-wise kernels over contiguous doubles or floats, dispatched at run
+// time to the widest instruction set the CPU supports. Checked kernels return
+// the first failing index (same conditions as ASTNode::evaluate), or n when
+// none fails. The float overloads fit twice as many lanes in each register.
+class SimdKernels {
+public:
+    enum class Level {
+        SCALAR,
+        SSE2,
+        AVX2,
+        AVX512
+    };
+
+    // Instruction set selected for this process
+    static Level activeLevel();
+    static std::string levelToString(Level level);
+
+    // Force a level (clamped to what the CPU supports), mainly for benchmarks
+    static void setLevel(Level level);
+
+    // Arithmetic operators
+    static void add(const double* a, const double* b, double* out, size_t n);
+    static void subtract(const double* a, const double* b, double* out, size_t n);
+    static void multiply(const double* a, const double* b, double* out, size_t n);
+    static size_t divide(const double* a, const double* b, double* out, size_t n);   // fails on b == 0
+    static void power(const double* a, const double* b, double* out, size_t n);
+    static void negative(const double* a, double* out, size_t n);
+
+    // Built-in functions
+    static void sin(const double* a, double* out, size_t n);
+    static void cos(const double* a, double* out, size_t n);
+    static size_t sqrt(const double* a, double* out, size_t n);                      // fails on a < 0
+    static size_t log(const double* a, double* out, size_t n);                       // fails on a <= 0
+    static void exp(const double* a, double* out, size_t n);
+    static void abs(const double* a, double* out, size_t n);
+
+    // Single precision
+    static void add(const float* a, const float* b, float* out, size_t n);
+    static void subtract(const float* a, const float* b, float* out, size_t n);
+    static void multiply(const float* a, const float* b, float* out, size_t n);
+    static size_t divide(const float* a, const float* b, float* out, size_t n);
+    static void power(const float* a, const float* b, float* out, size_t n);
+    static void negative(const float* a, float* out, size_t n);
+    static void sin(const float* a, float* out, size_t n);
+    static void cos(const float* a, float* out, size_t n);
+    static size_t sqrt(const float* a, float* out, size_t n);
+    static size_t log(const float* a, float* out, size_t n);
+    static void exp(const float* a, float* out, size_t n);
+    static void abs(const float* a, float* out, size_t n);
+};
+
+#endif // SIMD_KERNELS_H
\ No newline at end of file
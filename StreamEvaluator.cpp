@@ -0,0 +1,401 @@
+#include "StreamEvaluator.h"
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+static constexpr char BINARY_MAGIC[8] = {'E', 'X', 'P', 'R', 'C', 'O', 'L', '1'};
+
+// Little-endian integers and doubles, whatever the host byte order
+template <typename T>
+static void writeLittleEndian(std::ostream& out, T value) {
+    unsigned char bytes[sizeof(T)];
+    for (size_t i = 0; i < sizeof(T); ++i) bytes[i] = static_cast<unsigned char>(value >> (8 * i));
+    out.write(reinterpret_cast<const char*>(bytes), sizeof(T));
+}
+
+template <typename T>
+static bool readLittleEndian(std::istream& in, T& value) {
+    unsigned char bytes[sizeof(T)];
+    if (!in.read(reinterpret_cast<char*>(bytes), sizeof(T))) return false;
+    value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) value |= static_cast<T>(bytes[i]) << (8 * i);
+    return true;
+}
+
+static void swapToHostOrder(double* values, size_t count) {
+    if constexpr (std::endian::native != std::endian::little) {
+        for (size_t i = 0; i < count; ++i) {
+            unsigned char bytes[sizeof(double)];
+            std::memcpy(bytes, &values[i], sizeof(double));
+            std::uint64_t bits = 0;
+            for (size_t b = 0; b < sizeof(double); ++b) bits |= static_cast<std::uint64_t>(bytes[b]) << (8 * b);
+            values[i] = std::bit_cast<double>(bits);
+        }
+    }
+}
+
+static std::string_view trimField(std::string_view field) {
+    while (!field.empty() && (field.front() == ' ' || field.front() == '\t')) field.remove_prefix(1);
+    while (!field.empty() && (field.back() == ' ' || field.back() == '\t' || field.back() == '\r')) {
+        field.remove_suffix(1);
+    }
+    return field;
+}
+
+ColumnReader::ColumnReader(std::istream& in, StreamFormat format) : in(in), format(format) {
+    if (format == StreamFormat::CSV) {
+        std::string header;
+        if (!std::getline(in, header)) {
+            throw std::runtime_error("CSV input has no header line");
+        }
+        std::string_view rest = header;
+        while (true) {
+            size_t comma = rest.find(',');
+            std::string_view name = trimField(rest.substr(0, comma));
+            if (name.size() >= 2 && name.front() == '"' && name.back() == '"') {
+                name = name.substr(1, name.size() - 2);
+            }
+            names.emplace_back(name);
+            if (comma == std::string_view::npos) break;
+            rest.remove_prefix(comma + 1);
+        }
+        return;
+    }
+
+    char magic[sizeof(BINARY_MAGIC)];
+    std::uint32_t columnCount = 0;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0 ||
+        !readLittleEndian(in, columnCount)) {
+        throw std::runtime_error("Binary input does not start with a column header");
+    }
+    for (std::uint32_t i = 0; i < columnCount; ++i) {
+        std::uint32_t length = 0;
+        std::string name;
+        if (readLittleEndian(in, length)) {
+            name.resize(length);
+            in.read(name.data(), length);
+        }
+        if (!in) throw std::runtime_error("Truncated binary column header");
+        names.push_back(std::move(name));
+    }
+    fileBlock.resize(columnCount);
+}
+
+size_t ColumnReader::readBlock(const std::vector<size_t>& wanted, std::vector<std::vector<double>>& columns,
+                               size_t maxRows) {
+    for (auto& column : columns) column.resize(maxRows);
+    return format == StreamFormat::CSV ? readCsv(wanted, columns, maxRows)
+                                       : readBinary(wanted, columns, maxRows);
+}
+
+size_t ColumnReader::readCsv(const std::vector<size_t>& wanted, std::vector<std::vector<double>>& columns,
+                             size_t maxRows) {
+    // File column -> destination, or -1
+    std::vector<int> destination(names.size(), -1);
+    for (size_t i = 0; i < wanted.size(); ++i) destination[wanted[i]] = static_cast<int>(i);
+
+    std::string text;
+    size_t rows = 0;
+    while (rows < maxRows && std::getline(in, text)) {
+        ++line;
+        if (trimField(text).empty()) continue;
+
+        std::string_view rest = text;
+        size_t field = 0;
+        while (true) {
+            size_t comma = rest.find(',');
+            if (field >= names.size()) {
+                throw std::runtime_error("CSV line " + std::to_string(line) + ": more fields than columns");
+            }
+            if (destination[field] >= 0) {
+                std::string_view token = trimField(rest.substr(0, comma));
+                double value = 0;
+                auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), value);
+                if (error != std::errc() || end != token.data() + token.size()) {
+                    throw std::runtime_error("CSV line " + std::to_string(line) + ": invalid number '" +
+                                             std::string(token) + "' in column " + names[field]);
+                }
+                columns[destination[field]][rows] = value;
+            }
+            ++field;
+            if (comma == std::string_view::npos) break;
+            rest.remove_prefix(comma + 1);
+        }
+        if (field != names.size()) {
+            throw std::runtime_error("CSV line " + std::to_string(line) + ": expected " +
+                                     std::to_string(names.size()) + " fields");
+        }
+        ++rows;
+    }
+    return rows;
+}
+
+// File blocks can be any size; they are buffered and handed out maxRows at a time
+size_t ColumnReader::readBinary(const std::vector<size_t>& wanted, std::vector<std::vector<double>>& columns,
+                                size_t maxRows) {
+    size_t rows = 0;
+    while (rows < maxRows) {
+        if (fileBlockOffset == fileBlockRows) {
+            std::uint64_t blockRows = 0;
+            if (!readLittleEndian(in, blockRows)) break;
+            fileBlockRows = static_cast<size_t>(blockRows);
+            fileBlockOffset = 0;
+
+            // Only the wanted columns are kept; the others are skipped
+            for (size_t c = 0; c < fileBlock.size(); ++c) {
+                bool keep = std::find(wanted.begin(), wanted.end(), c) != wanted.end();
+                if (keep) {
+                    fileBlock[c].resize(fileBlockRows);
+                    in.read(reinterpret_cast<char*>(fileBlock[c].data()),
+                            static_cast<std::streamsize>(fileBlockRows * sizeof(double)));
+                    swapToHostOrder(fileBlock[c].data(), fileBlockRows);
+                } else {
+                    in.ignore(static_cast<std::streamsize>(fileBlockRows * sizeof(double)));
+                    if (static_cast<size_t>(in.gcount()) != fileBlockRows * sizeof(double)) in.setstate(std::ios::failbit);
+                }
+                if (!in) throw std::runtime_error("Truncated binary column block");
+            }
+            continue;
+        }
+
+        size_t count = std::min(maxRows - rows, fileBlockRows - fileBlockOffset);
+        for (size_t i = 0; i < wanted.size(); ++i) {
+            const double* source = fileBlock[wanted[i]].data() + fileBlockOffset;
+            std::copy(source, source + count, columns[i].data() + rows);
+        }
+        fileBlockOffset += count;
+        rows += count;
+    }
+    return rows;
+}
+
+ColumnWriter::ColumnWriter(std::ostream& out, StreamFormat format, const std::vector<std::string>& names)
+    : out(out), format(format), columnCount(names.size()) {
+    if (format == StreamFormat::CSV) {
+        for (size_t i = 0; i < names.size(); ++i) out << (i ? "," : "") << names[i];
+        out << '\n';
+        return;
+    }
+    out.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    writeLittleEndian(out, static_cast<std::uint32_t>(names.size()));
+    for (const auto& name : names) {
+        writeLittleEndian(out, static_cast<std::uint32_t>(name.size()));
+        out.write(name.data(), static_cast<std::streamsize>(name.size()));
+    }
+}
+
+void ColumnWriter::writeBlock(const std::vector<std::span<const double>>& columns, size_t rows) {
+    if (columns.size() != columnCount) {
+        throw std::runtime_error("Expected " + std::to_string(columnCount) + " columns but got " +
+                                 std::to_string(columns.size()));
+    }
+
+    if (format == StreamFormat::CSV) {
+        // Shortest text that reads back to the same double
+        char number[32];
+        for (size_t r = 0; r < rows; ++r) {
+            text.clear();
+            for (size_t c = 0; c < columns.size(); ++c) {
+                if (c) text += ',';
+                auto [end, error] = std::to_chars(number, number + sizeof(number), columns[c][r]);
+                text.append(number, end);
+            }
+            text += '\n';
+            out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        }
+    } else {
+        writeLittleEndian(out, static_cast<std::uint64_t>(rows));
+        for (const auto& column : columns) {
+            if constexpr (std::endian::native == std::endian::little) {
+                out.write(reinterpret_cast<const char*>(column.data()),
+                          static_cast<std::streamsize>(rows * sizeof(double)));
+            } else {
+                for (size_t r = 0; r < rows; ++r) writeLittleEndian(out, std::bit_cast<std::uint64_t>(column[r]));
+            }
+        }
+    }
+    if (!out) throw std::runtime_error("Write failed");
+}
+
+// Bounded hand-off of block indices between two pipeline stages
+class BlockQueue {
+public:
+    void push(size_t block) {
+        {
+            std::lock_guard lock(mutex);
+            blocks.push_back(block);
+        }
+        ready.notify_one();
+    }
+
+    // Next block, or false once closed and empty (or aborted)
+    bool pop(size_t& block) {
+        std::unique_lock lock(mutex);
+        ready.wait(lock, [this] { return aborted || closed || !blocks.empty(); });
+        if (aborted || blocks.empty()) return false;
+        block = blocks.front();
+        blocks.erase(blocks.begin());
+        return true;
+    }
+
+    void close() {
+        {
+            std::lock_guard lock(mutex);
+            closed = true;
+        }
+        ready.notify_all();
+    }
+
+    void abort() {
+        {
+            std::lock_guard lock(mutex);
+            aborted = true;
+        }
+        ready.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::vector<size_t> blocks;    // at most BLOCK_COUNT entries
+    bool closed = false;
+    bool aborted = false;
+};
+
+struct StreamBlock {
+    std::vector<std::vector<double>> inputs;
+    std::vector<double> output;
+    size_t rows = 0;
+    size_t firstRow = 0;
+};
+
+StreamEvaluator::StreamEvaluator(const ASTNodePtr& ast, size_t blockRows)
+    : batch(ast), blockRows(std::max<size_t>(blockRows, 1)) {}
+
+StreamFormat StreamEvaluator::formatFor(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    std::string extension = dot == std::string::npos ? "" : path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == "csv" ? StreamFormat::CSV : StreamFormat::BINARY;
+}
+
+size_t StreamEvaluator::run(const std::string& inPath, const std::string& outPath) const {
+    StreamFormat inFormat = formatFor(inPath);
+    StreamFormat outFormat = formatFor(outPath);
+    std::ifstream in(inPath, inFormat == StreamFormat::BINARY ? std::ios::binary : std::ios::in);
+    if (!in) throw std::runtime_error("Cannot open " + inPath);
+    std::ofstream out(outPath, outFormat == StreamFormat::BINARY ? std::ios::binary : std::ios::out);
+    if (!out) throw std::runtime_error("Cannot create " + outPath);
+    return run(in, inFormat, out, outFormat);
+}
+
+size_t StreamEvaluator::run(std::istream& in, StreamFormat inFormat, std::ostream& out, StreamFormat outFormat,
+                            const std::string& outputName) const {
+    ColumnReader reader(in, inFormat);
+
+    // Input column for each variable, in collectVariables() order
+    const auto& variables = batch.getVariables();
+    std::vector<size_t> wanted;
+    for (const auto& variable : variables) {
+        auto it = std::find(reader.getNames().begin(), reader.getNames().end(), variable);
+        if (it == reader.getNames().end()) {
+            throw std::runtime_error("Undefined variable: " + variable + " (no such input column)");
+        }
+        wanted.push_back(static_cast<size_t>(it - reader.getNames().begin()));
+    }
+    ColumnWriter writer(out, outFormat, {outputName});
+
+    std::vector<StreamBlock> blocks(BLOCK_COUNT);
+    for (auto& block : blocks) {
+        block.inputs.resize(variables.size());
+        block.output.resize(blockRows);
+    }
+
+    // free -> reader -> toEvaluate -> evaluator -> toWrite -> writer -> free
+    BlockQueue freeBlocks, toEvaluate, toWrite;
+    for (size_t i = 0; i < BLOCK_COUNT; ++i) freeBlocks.push(i);
+
+    std::mutex failureMutex;
+    std::exception_ptr failure;
+    auto fail = [&](std::exception_ptr error) {
+        {
+            std::lock_guard lock(failureMutex);
+            if (!failure) failure = error;
+        }
+        freeBlocks.abort();
+        toEvaluate.abort();
+        toWrite.abort();
+    };
+
+    size_t totalRows = 0;
+    std::thread readerThread([&] {
+        try {
+            size_t index;
+            size_t nextRow = 0;
+            while (freeBlocks.pop(index)) {
+                StreamBlock& block = blocks[index];
+                block.rows = reader.readBlock(wanted, block.inputs, blockRows);
+                block.firstRow = nextRow;
+                if (block.rows == 0) break;
+                nextRow += block.rows;
+                toEvaluate.push(index);
+            }
+            toEvaluate.close();
+        } catch (...) {
+            fail(std::current_exception());
+        }
+    });
+    std::thread writerThread([&] {
+        try {
+            size_t index;
+            while (toWrite.pop(index)) {
+                const StreamBlock& block = blocks[index];
+                writer.writeBlock({std::span<const double>(block.output.data(), block.rows)}, block.rows);
+                freeBlocks.push(index);
+            }
+            out.flush();
+        } catch (...) {
+            fail(std::current_exception());
+        }
+    });
+
+    try {
+        size_t index;
+        std::vector<std::span<const double>> columns(variables.size());
+        while (toEvaluate.pop(index)) {
+            StreamBlock& block = blocks[index];
+            for (size_t i = 0; i < columns.size(); ++i) {
+                columns[i] = std::span<const double>(block.inputs[i].data(), block.rows);
+            }
+            try {
+                batch.evaluate(columns, std::span<double>(block.output.data(), block.rows));
+            } catch (const BatchEvaluationError& e) {
+                throw BatchEvaluationError(e.what(), block.firstRow + e.getRow());
+            }
+            totalRows += block.rows;
+            toWrite.push(index);
+        }
+    } catch (...) {
+        // Stop reading, but let the writer finish the blocks before this one
+        {
+            std::lock_guard lock(failureMutex);
+            if (!failure) failure = std::current_exception();
+        }
+        freeBlocks.abort();
+        toEvaluate.abort();
+    }
+    toWrite.close();
+
+    readerThread.join();
+    writerThread.join();
+    if (failure) std::rethrow_exception(failure);
+    return totalRows;
+}
@@ -0,0 +1,92 @@
+#ifndef STREAM_EVALUATOR_H
+#define STREAM_EVALUATOR_H
+
+#include "BatchEvaluator.h"
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+// On-disk layouts understood by the streaming reader and writer
+enum class StreamFormat {
+    // Header line of column names, then one row of comma-separated numbers per line
+    CSV,
+    // Little-endian blocked columns: "EXPRCOL1", uint32 column count, per
+    // column a uint32 name length and the name bytes; then blocks of uint64
+    // row count followed by that many doubles for each column in turn
+    BINARY
+};
+
+// Reads a column file block by block
+class ColumnReader {
+public:
+    ColumnReader(std::istream& in, StreamFormat format);
+
+    const std::vector<std::string>& getNames() const { return names; }
+
+    // Read up to maxRows rows of the columns listed in `wanted` (indices into
+    // getNames()) into columns[i]; returns the rows read, 0 at end of input
+    size_t readBlock(const std::vector<size_t>& wanted, std::vector<std::vector<double>>& columns,
+                     size_t maxRows);
+
+private:
+    std::istream& in;
+    StreamFormat format;
+    std::vector<std::string> names;
+    size_t line = 1;                                  // CSV: for error messages
+    std::vector<std::vector<double>> fileBlock;       // BINARY: current block
+    size_t fileBlockRows = 0;
+    size_t fileBlockOffset = 0;
+
+    size_t readCsv(const std::vector<size_t>& wanted, std::vector<std::vector<double>>& columns, size_t maxRows);
+    size_t readBinary(const std::vector<size_t>& wanted, std::vector<std::vector<double>>& columns,
+                      size_t maxRows);
+};
+
+// Writes a column file block by block
+class ColumnWriter {
+public:
+    ColumnWriter(std::ostream& out, StreamFormat format, const std::vector<std::string>& names);
+
+    void writeBlock(const std::vector<std::span<const double>>& columns, size_t rows);
+
+private:
+    std::ostream& out;
+    StreamFormat format;
+    size_t columnCount;
+    std::string text;       // CSV line buffer
+};
+
+// Streams a column file through one expression with bounded memory: a reader
+// thread, the evaluating (calling) thread and a writer thread pass a fixed
+// set of blocks around, so reading, evaluating and writing overlap. Input
+// columns are matched to collectVariables() by name; other columns are ignored.
+class StreamEvaluator {
+public:
+    static constexpr size_t DEFAULT_BLOCK_ROWS = 64 * BatchEvaluator::CHUNK_SIZE;
+    // Blocks in flight: one being read, one evaluated and one written, plus a spare
+    static constexpr size_t BLOCK_COUNT = 4;
+
+    explicit StreamEvaluator(const ASTNodePtr& ast, size_t blockRows = DEFAULT_BLOCK_ROWS);
+
+    // Evaluate every row of `in`, writing one column named outputName to
+    // `out`; returns the number of rows. Throws std::runtime_error for a
+    // missing variable column or malformed input, and BatchEvaluationError
+    // (with the row index in the file) if evaluation fails, after writing
+    // every block before the failing one.
+    size_t run(std::istream& in, StreamFormat inFormat, std::ostream& out, StreamFormat outFormat,
+               const std::string& outputName = "result") const;
+
+    // Same with files; each format follows the extension (".csv" or binary)
+    size_t run(const std::string& inPath, const std::string& outPath) const;
+
+    static StreamFormat formatFor(const std::string& path);
+
+private:
+    BatchEvaluator batch;
+    size_t blockRows;
+};
+
+#endif // STREAM_EVALUATOR_H
@@ -0,0 +1,26 @@
+#include "SymbolTable.h"
+
+// Id of an identifier, adding it on first use
+std::uint32_t SymbolTable::intern(std::string_view name) {
+    auto it = ids.find(name);
+    if (it != ids.end()) {
+        return it->second;
+    }
+
+    auto id = static_cast<std::uint32_t>(names.size());
+    names.emplace_back(name);
+    ids.emplace(std::string_view(names.back()), id);
+    return id;
+}
+
+// Id of an identifier, or NOT_FOUND
+std::uint32_t SymbolTable::find(std::string_view name) const {
+    auto it = ids.find(name);
+    return it != ids.end() ? it->second : NOT_FOUND;
+}
+
+// Remove every symbol
+void SymbolTable::clear() {
+    ids.clear();
+    names.clear();
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Interns identifiers so nodes can refer to them by a small integer id
+class SymbolTable {
+public:
+    static constexpr std::uint32_t NOT_FOUND = 0xFFFFFFFFu;
+
+    SymbolTable() = default;
+    SymbolTable(const SymbolTable&) = delete;   // keys are views into names
+    SymbolTable& operator=(const SymbolTable&) = delete;
+    SymbolTable(SymbolTable&&) = default;
+    SymbolTable& operator=(SymbolTable&&) = default;
+
+    // Id of an identifier, adding it on first use
+    std::uint32_t intern(std::string_view name);
+
+    // Id of an identifier, or NOT_FOUND
+    std::uint32_t find(std::string_view name) const;
+
+    // Name of an id (view stays valid for the lifetime of the table)
+    std::string_view name(std::uint32_t id) const { return names[id]; }
+
+    size_t size() const { return names.size(); }
+    void clear();
+
+private:
+    std::deque<std::string> names;                               // stable storage
+    std::unordered_map<std::string_view, std::uint32_t> ids;     // views into names
+};
+
+#endif // SYMBOL_TABLE_H
\ No newline at end of file
@@ -0,0 +1,27 @@
+#include "TypedExpression.h"
+#include <stdexcept>
+
+template <typename T>
+TypedExpression<T>::TypedExpression(const ASTNodePtr& ast)
+    : compiled(ast), constants(compiled.getConstants().begin(), compiled.getConstants().end()) {}
+
+// Evaluate from slot-ordered values
+template <typename T>
+T TypedExpression<T>::evaluate(std::span<const T> slots) const {
+    const auto& variables = compiled.getVariables();
+    if (slots.size() < variables.size()) {
+        throw std::runtime_error("Expected " + std::to_string(variables.size()) + " slots but got " +
+                                 std::to_string(slots.size()));
+    }
+    return evaluate(slots.data());
+}
+
+// CompiledExpression's own interpreter loop, in T
+template <typename T>
+T TypedExpression<T>::evaluate(const T* slots) const {
+    return compiled.execute<T>(constants.data(), slots, nullptr, nullptr);
+}
+
+template class TypedExpression<float>;
+template class TypedExpression<double>;
+template class TypedExpression<long double>;
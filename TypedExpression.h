@@ -0,0 +1,33 @@
+#ifndef TYPED_EXPRESSION_H
+#define TYPED_EXPRESSION_H
+
+#include "AST_NODE.h"
+#include "CompiledExpression.h"
+#include <span>
+#include <string>
+#include <vector>
+
+// CompiledExpression's bytecode run in T: float, double or long double. The
+// constants are rounded to T once, at construction, and every operation uses
+// T's own arithmetic and libm overload. For double, results and errors match
+// CompiledExpression::evaluate. long double is a higher-precision reference
+// for checking the other two (see PrecisionReport).
+template <typename T>
+class TypedExpression {
+public:
+    explicit TypedExpression(const ASTNodePtr& ast);
+
+    // Variable names in slot order (same as collectVariables())
+    const std::vector<std::string>& getVariables() const { return compiled.getVariables(); }
+
+    // Evaluate from values in slot order. Throws the message ASTNode::evaluate
+    // would, with the domain checks applied to the T values.
+    T evaluate(const T* slots) const;
+    T evaluate(std::span<const T> slots) const;
+
+private:
+    CompiledExpression compiled;
+    std::vector<T> constants;      // compiled.getConstants() as T
+};
+
+#endif // TYPED_EXPRESSION_H
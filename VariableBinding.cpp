@@ -0,0 +1,64 @@
+#include "VariableBinding.h"
+#include <stdexcept>
+#include <algorithm>
+
+// Bind the variables of an AST
+VariableBinding::VariableBinding(const ASTNodePtr& ast) : variables(ast->collectVariables()) {}
+
+// Bind an explicit variable list
+VariableBinding::VariableBinding(std::vector<std::string> names) : variables(std::move(names)) {
+    // Remove duplicates and sort
+    std::sort(variables.begin(), variables.end());
+    variables.erase(std::unique(variables.begin(), variables.end()), variables.end());
+}
+
+// Slot index of a variable
+size_t VariableBinding::slotOf(const std::string& name) const {
+    auto it = std::lower_bound(variables.begin(), variables.end(), name);
+    if (it == variables.end() || *it != name) {
+        throw std::runtime_error("Variable not bound: " + name);
+    }
+    return it - variables.begin();
+}
+
+// Build slot-ordered values from a VariableMap
+std::vector<double> VariableBinding::bind(const VariableMap& values) const {
+    std::vector<double> slots(variables.size());
+    bind(values, slots);
+    return slots;
+}
+
+// Fill caller-provided slots from a VariableMap
+void VariableBinding::bind(const VariableMap& values, std::span<double> slots) const {
+    if (slots.size() < variables.size()) {
+        throw std::runtime_error("Expected " + std::to_string(variables.size()) + " slots but got " +
+                                 std::to_string(slots.size()));
+    }
+    for (size_t i = 0; i < variables.size(); ++i) {
+        auto it = values.find(variables[i]);
+        if (it == values.end()) {
+            throw std::runtime_error("Undefined variable: " + variables[i]);
+        }
+        slots[i] = it->second;
+    }
+}
+
+// Build slot-ordered values from a vector of pairs (later entries win)
+std::vector<double> VariableBinding::bind(const std::vector<std::pair<std::string, double>>& values) const {
+    std::vector<double> slots(variables.size());
+    std::vector<bool> defined(variables.size(), false);
+    for (const auto& [name, value] : values) {
+        auto it = std::lower_bound(variables.begin(), variables.end(), name);
+        if (it != variables.end() && *it == name) {
+            size_t slot = it - variables.begin();
+            slots[slot] = value;
+            defined[slot] = true;
+        }
+    }
+    for (size_t i = 0; i < variables.size(); ++i) {
+        if (!defined[i]) {
+            throw std::runtime_error("Undefined variable: " + variables[i]);
+        }
+    }
+    return slots;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#ifndef VARIABLE_BINDING_H
+#define VARIABLE_BINDING_H
+
+#include "AST_NODE.h"
+#include <span>
+#include <string>
+#include <vector>
+
+// Maps each distinct variable of an expression to a dense slot index.
+// Binding resolves names once so evaluation can read values by index.
+class VariableBinding {
+public:
+    // Slots follow collectVariables() order (sorted, unique)
+    explicit VariableBinding(const ASTNodePtr& ast);
+    explicit VariableBinding(std::vector<std::string> variables);
+
+    // Number of slots
+    size_t size() const { return variables.size(); }
+
+    // Variable names in slot order
+    const std::vector<std::string>& getVariables() const { return variables; }
+
+    // Slot index of a variable (throws if the expression does not use it)
+    size_t slotOf(const std::string& name) const;
+
+    // Build slot-ordered values; throws "Undefined variable: <name>" for the
+    // first missing variable
+    std::vector<double> bind(const VariableMap& values) const;
+    std::vector<double> bind(const std::vector<std::pair<std::string, double>>& values) const;
+    void bind(const VariableMap& values, std::span<double> slots) const;
+
+private:
+    std::vector<std::string> variables;
+};
+
+#endif // VARIABLE_BINDING_H
\ No newline at end of file
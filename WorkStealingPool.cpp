@@ -0,0 +1,109 @@
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(size_t workerCount)
+    : queues(workerCount != 0 ? workerCount : std::max(std::thread::hardware_concurrency(), 1u)) {
+    threads.reserve(queues.size() - 1);
+    for (size_t worker = 1; worker < queues.size(); ++worker) {
+        threads.emplace_back(&WorkStealingPool::workerLoop, this, worker);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard lock(stateMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& thread : threads) thread.join();
+}
+
+void WorkStealingPool::run(size_t taskCount, const Task& task) {
+    if (taskCount == 0) return;
+    std::lock_guard runLock(runMutex);
+
+    // Contiguous blocks keep each worker on neighbouring rows until it steals
+    size_t workers = queues.size();
+    for (size_t worker = 0; worker < workers; ++worker) {
+        std::lock_guard lock(queues[worker].mutex);
+        for (size_t i = taskCount * worker / workers; i < taskCount * (worker + 1) / workers; ++i) {
+            queues[worker].tasks.push_back(i);
+        }
+    }
+
+    {
+        std::lock_guard lock(stateMutex);
+        current = &task;
+        failure = nullptr;
+        busyWorkers = threads.size();
+        ++generation;
+    }
+    wake.notify_all();
+
+    drain(0, task);
+
+    // Every worker must be done with `task` before it goes out of scope
+    std::unique_lock lock(stateMutex);
+    finished.wait(lock, [this] { return busyWorkers == 0; });
+    current = nullptr;
+    if (failure) std::rethrow_exception(failure);
+}
+
+void WorkStealingPool::workerLoop(size_t worker) {
+    std::uint64_t seen = 0;
+    while (true) {
+        const Task* task;
+        {
+            std::unique_lock lock(stateMutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            task = current;
+        }
+
+        drain(worker, *task);
+
+        {
+            std::lock_guard lock(stateMutex);
+            --busyWorkers;
+        }
+        finished.notify_one();
+    }
+}
+
+// Run tasks until no deque has any left (tasks are only added by run())
+void WorkStealingPool::drain(size_t worker, const Task& task) {
+    size_t index;
+    while (takeTask(worker, index)) {
+        try {
+            task(index);
+        } catch (...) {
+            std::lock_guard lock(stateMutex);
+            if (!failure) failure = std::current_exception();
+        }
+    }
+}
+
+// Own deque first (front), then the others in turn (back)
+bool WorkStealingPool::takeTask(size_t worker, size_t& task) {
+    {
+        Queue& own = queues[worker];
+        std::lock_guard lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        Queue& victim = queues[(worker + offset) % queues.size()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,66 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of workers running numbered tasks. Each run() deals the task
+// indices out as contiguous blocks, one deque per worker; a worker takes its
+// own tasks from the front and, once empty, steals from the back of another
+// worker's deque. The calling thread works as worker 0.
+class WorkStealingPool {
+public:
+    using Task = std::function<void(size_t task)>;
+
+    // workerCount == 0 uses std::thread::hardware_concurrency()
+    explicit WorkStealingPool(size_t workerCount = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    size_t getWorkerCount() const { return queues.size(); }
+
+    // Run task(0) .. task(taskCount - 1) and wait for all of them. Concurrent
+    // calls are serialized. If tasks throw, the remaining ones still run and
+    // the first exception caught is rethrown.
+    void run(size_t taskCount, const Task& task);
+
+    // Tasks taken from another worker's deque, over all runs
+    std::uint64_t getSteals() const { return steals.load(std::memory_order_relaxed); }
+
+private:
+    // One cache line per deque so workers do not contend on their neighbours' locks
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    std::vector<Queue> queues;
+    std::vector<std::thread> threads;
+
+    std::mutex runMutex;              // one run() at a time
+    std::mutex stateMutex;            // guards the fields below
+    std::condition_variable wake;
+    std::condition_variable finished;
+    const Task* current = nullptr;
+    std::uint64_t generation = 0;
+    size_t busyWorkers = 0;
+    bool stopping = false;
+    std::exception_ptr failure;
+
+    std::atomic<std::uint64_t> steals{0};
+
+    void workerLoop(size_t worker);
+    void drain(size_t worker, const Task& task);
+    bool takeTask(size_t worker, size_t& task);
+};
+
+#endif // WORK_STEALING_POOL_H
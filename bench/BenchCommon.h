@@ -0,0 +1,84 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include "../AST_NODE.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Keep the optimizer from discarding a computed value
+inline void doNotOptimize(double value) {
+    asm volatile("" : : "g"(value) : "memory");
+}
+
+// Run fn `iterations` times and return nanoseconds per iteration
+template <typename Fn>
+double timePerIteration(size_t iterations, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    double total = std::chrono::duration<double, std::nano>(end - start).count();
+    return total / static_cast<double>(iterations);
+}
+
+// Variable name for index i (x0, x1, ...)
+inline std::string varName(size_t i) {
+    return "x" + std::to_string(i);
+}
+
+// Left-deep chain: ((x0 + x1) * 1.0001 - x2) ... with `length` operators
+inline ASTNodePtr makeDeepChain(size_t length, size_t variableCount) {
+    static const OperatorType ops[] = {
+        OperatorType::ADD, OperatorType::MULTIPLY, OperatorType::SUBTRACT, OperatorType::DIVIDE
+    };
+    ASTNodePtr node = ASTNode::createVariable(varName(0));
+    for (size_t i = 1; i <= length; ++i) {
+        OperatorType op = ops[i % 4];
+        ASTNodePtr rhs = (op == OperatorType::MULTIPLY || op == OperatorType::DIVIDE)
+            ? ASTNode::createNumber(1.0 + 0.0001 * static_cast<double>(i % 7))
+            : ASTNode::createVariable(varName(i % variableCount));
+        node = ASTNode::createBinaryOp(op, node, rhs);
+    }
+    return node;
+}
+
+// Balanced binary tree of the given depth, with function calls on some levels
+inline ASTNodePtr makeWideTree(size_t depth, size_t variableCount, size_t& leafCounter) {
+    if (depth == 0) {
+        size_t leaf = leafCounter++;
+        if (leaf % 3 == 2) return ASTNode::createNumber(0.5 + static_cast<double>(leaf % 5));
+        return ASTNode::createVariable(varName(leaf % variableCount));
+    }
+
+    ASTNodePtr left = makeWideTree(depth - 1, variableCount, leafCounter);
+    ASTNodePtr right = makeWideTree(depth - 1, variableCount, leafCounter);
+    OperatorType op = (depth % 2 == 0) ? OperatorType::ADD : OperatorType::MULTIPLY;
+    ASTNodePtr node = ASTNode::createBinaryOp(op, left, right);
+
+    if (depth % 3 == 0) {
+        node = ASTNode::createFunctionCall(depth % 2 == 0 ? "sin" : "cos", {node});
+    }
+    return node;
+}
+
+inline ASTNodePtr makeWideTree(size_t depth, size_t variableCount) {
+    size_t leafCounter = 0;
+    return makeWideTree(depth, variableCount, leafCounter);
+}
+
+// Variable assignment x0..x{count-1} with values in (1, 2)
+inline VariableMap makeVariables(size_t count) {
+    VariableMap variables;
+    for (size_t i = 0; i < count; ++i) {
+        variables[varName(i)] = 1.0 + static_cast<double>(i + 1) / static_cast<double>(count + 1);
+    }
+    return variables;
+}
+
+} // namespace bench
+
+#endif // BENCH_COMMON_H
\ No newline at end of file
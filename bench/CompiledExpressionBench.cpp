@@ -0,0 +1,55 @@
+// Tree walker (ASTNode::evaluate) versus bytecode (CompiledExpression::evaluate),
+// with a VariableMap and with pre-bound slots
+#include "BenchCommon.h"
+#include "../CompiledExpression.h"
+#include <iostream>
+#include <iomanip>
+
+static void runCase(const std::string& name, const ASTNodePtr& ast,
+                    const VariableMap& variables, size_t iterations) {
+    CompiledExpression compiled(ast);
+
+    double expected = ast->evaluate(variables);
+    double actual = compiled.evaluate(variables);
+    if (expected != actual) {
+        std::cout << name << ": MISMATCH tree=" << expected << " compiled=" << actual << "\n";
+        return;
+    }
+
+    double treeNs = bench::timePerIteration(iterations, [&] {
+        bench::doNotOptimize(ast->evaluate(variables));
+    });
+    double compiledNs = bench::timePerIteration(iterations, [&] {
+        bench::doNotOptimize(compiled.evaluate(variables));
+    });
+    std::vector<double> slots = compiled.getBinding().bind(variables);
+    double slotsNs = bench::timePerIteration(iterations, [&] {
+        bench::doNotOptimize(compiled.evaluate(slots.data()));
+    });
+
+    std::cout << std::left << std::setw(24) << name
+              << std::right << std::setw(8) << compiled.getInstructions().size() << " instr"
+              << std::fixed << std::setprecision(1)
+              << std::setw(12) << treeNs << " ns"
+              << std::setw(12) << compiledNs << " ns"
+              << std::setw(12) << slotsNs << " ns"
+              << std::setprecision(2) << std::setw(9) << treeNs / compiledNs << "x"
+              << std::setw(9) << treeNs / slotsNs << "x\n";
+}
+
+int main() {
+    std::cout << std::left << std::setw(24) << "case"
+              << std::right << std::setw(14) << "size"
+              << std::setw(15) << "tree walk"
+              << std::setw(15) << "compiled"
+              << std::setw(15) << "slots"
+              << std::setw(10) << "speedup"
+              << std::setw(10) << "(slots)" << "\n";
+
+    VariableMap variables = bench::makeVariables(16);
+    runCase("deep chain (100)", bench::makeDeepChain(100, 16), variables, 200000);
+    runCase("deep chain (2000)", bench::makeDeepChain(2000, 16), variables, 10000);
+    runCase("wide tree (depth 6)", bench::makeWideTree(6, 16), variables, 200000);
+    runCase("wide tree (depth 12)", bench::makeWideTree(12, 16), variables, 2000);
+    return 0;
+}
\ No newline at end of file
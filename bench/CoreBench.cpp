@@ -0,0 +1,247 @@
+// Parse, build, evaluate and print paths of the core classes on synthetic
+// expressions, reported as JSON on stdout for tracking over time:
+//   ./bench/CoreBench > core.json
+// Each operation is timed for several repetitions; the JSON holds the fastest
+// and the median nanoseconds per call.
+#include "BenchCommon.h"
+#include "../InfixToPostfix.h"
+#include "../PostfixToAST.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+constexpr size_t REPETITIONS = 5;
+constexpr double TARGET_NS = 20e6;     // per repetition
+
+struct Case {
+    std::string name;
+    ASTNodePtr ast;
+    size_t variableCount;
+};
+
+struct Result {
+    std::string caseName;
+    std::string operation;
+    size_t iterations;
+    double bestNs;
+    double medianNs;
+};
+
+// Constants are small integers and there are no function calls or unary
+// operators, so toString() is also valid input for InfixToPostfix
+ASTNodePtr makeChain(size_t length, size_t variableCount) {
+    static const OperatorType ops[] = {
+        OperatorType::ADD, OperatorType::MULTIPLY, OperatorType::SUBTRACT, OperatorType::DIVIDE
+    };
+    ASTNodePtr node = ASTNode::createVariable(bench::varName(0));
+    for (size_t i = 1; i <= length; ++i) {
+        OperatorType op = ops[i % 4];
+        ASTNodePtr rhs = (op == OperatorType::MULTIPLY || op == OperatorType::DIVIDE)
+            ? ASTNode::createNumber(static_cast<double>(i % 3 + 1))
+            : ASTNode::createVariable(bench::varName(i % variableCount));
+        node = ASTNode::createBinaryOp(op, node, rhs);
+    }
+    return node;
+}
+
+ASTNodePtr makeBalanced(size_t depth, size_t variableCount, size_t& leafCounter) {
+    if (depth == 0) {
+        size_t leaf = leafCounter++;
+        if (leaf % 4 == 3) return ASTNode::createNumber(static_cast<double>(leaf % 5 + 1));
+        return ASTNode::createVariable(bench::varName(leaf % variableCount));
+    }
+    ASTNodePtr left = makeBalanced(depth - 1, variableCount, leafCounter);
+    ASTNodePtr right = makeBalanced(depth - 1, variableCount, leafCounter);
+    return ASTNode::createBinaryOp(depth % 2 ? OperatorType::MULTIPLY : OperatorType::ADD, left, right);
+}
+
+// One-argument calls around every operand and every other sum; arguments stay
+// in each function's domain for x in (1, 2)
+ASTNodePtr makeFunctionHeavy(size_t terms, size_t variableCount) {
+    static const char* functions[] = {"sin", "cos", "sqrt", "exp", "log", "abs"};
+    ASTNodePtr node;
+    for (size_t i = 0; i < terms; ++i) {
+        ASTNodePtr term = ASTNode::createFunctionCall(functions[i % 6],
+                                                      {ASTNode::createVariable(bench::varName(i % variableCount))});
+        term = ASTNode::createFunctionCall(functions[(i + 1) % 2], {term});
+        node = node ? ASTNode::createBinaryOp(OperatorType::ADD, node, term) : term;
+        if (i % 2 == 1) node = ASTNode::createFunctionCall("sin", {node});
+    }
+    return node;
+}
+
+// x0 * x1 + x2 * x3 + ... with every variable distinct
+ASTNodePtr makeManyVariables(size_t variableCount) {
+    ASTNodePtr node;
+    for (size_t i = 0; i + 1 < variableCount; i += 2) {
+        ASTNodePtr term = ASTNode::createBinaryOp(OperatorType::MULTIPLY,
+                                                  ASTNode::createVariable(bench::varName(i)),
+                                                  ASTNode::createVariable(bench::varName(i + 1)));
+        node = node ? ASTNode::createBinaryOp(OperatorType::ADD, node, term) : term;
+    }
+    return node;
+}
+
+bool hasFunctions(const ASTNode* node) {
+    switch(node->type) {
+        case NodeType::BINARY_OP: return hasFunctions(node->op.left.get()) || hasFunctions(node->op.right.get());
+        case NodeType::UNARY_OP: return true;
+        case NodeType::FUNCTION_CALL: return true;
+        default: return false;
+    }
+}
+
+size_t countNodes(const ASTNode* node) {
+    switch(node->type) {
+        case NodeType::BINARY_OP: return 1 + countNodes(node->op.left.get()) + countNodes(node->op.right.get());
+        case NodeType::FUNCTION_CALL: {
+            size_t count = 1;
+            for (const auto& arg : node->function.arguments) count += countNodes(arg.get());
+            return count;
+        }
+        default: return 1;
+    }
+}
+
+// Space-separated postfix for PostfixToAST (binary operators and one-argument calls)
+void appendPostfix(const ASTNode* node, std::string& out) {
+    switch(node->type) {
+        case NodeType::NUMBER: out += ASTNode::numberToString(node->number.value); break;
+        case NodeType::VARIABLE: out += node->variable.name; break;
+        case NodeType::BINARY_OP:
+            appendPostfix(node->op.left.get(), out);
+            appendPostfix(node->op.right.get(), out);
+            out += ASTNode::opToString(node->op.op);
+            break;
+        default:
+            appendPostfix(node->function.arguments[0].get(), out);
+            out += node->function.functionName;
+            break;
+    }
+    out += ' ';
+}
+
+// Repeat fn in batches sized to take about TARGET_NS each
+template <typename Fn>
+Result measure(const std::string& caseName, const std::string& operation, Fn&& fn) {
+    size_t iterations = 1;
+    while (true) {
+        double ns = bench::timePerIteration(iterations, fn) * static_cast<double>(iterations);
+        if (ns >= TARGET_NS / 10 || iterations >= (size_t(1) << 30)) {
+            iterations = std::max<size_t>(1, static_cast<size_t>(TARGET_NS * static_cast<double>(iterations) / ns));
+            break;
+        }
+        iterations *= 10;
+    }
+
+    std::vector<double> samples;
+    for (size_t r = 0; r < REPETITIONS; ++r) samples.push_back(bench::timePerIteration(iterations, fn));
+    std::sort(samples.begin(), samples.end());
+    return {caseName, operation, iterations, samples.front(), samples[samples.size() / 2]};
+}
+
+std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+} // namespace
+
+int main() {
+    size_t leafCounter = 0;
+    std::vector<Case> cases;
+    cases.push_back({"deep_chain_1000", makeChain(1000, 8), 8});
+    cases.push_back({"balanced_depth_12", makeBalanced(12, 16, leafCounter), 16});
+    cases.push_back({"function_heavy_200", makeFunctionHeavy(200, 8), 8});
+    cases.push_back({"many_variables_1000", makeManyVariables(1000), 1000});
+
+    // InfixToPostfix echoes every expression; keep stdout for the JSON
+    std::stringstream sink;
+    std::streambuf* original = std::cout.rdbuf(sink.rdbuf());
+
+    InfixToPostfix converter;
+    std::vector<Result> results;
+    std::vector<std::string> errors;
+    for (const Case& c : cases) {
+        const ASTNode* ast = c.ast.get();
+        std::string text = ast->toString();
+        std::string postfix;
+        appendPostfix(ast, postfix);
+        std::vector<std::string> tokens = PostfixToAST::tokenize(postfix);
+        VariableMap map = bench::makeVariables(c.variableCount);
+        std::vector<std::pair<std::string, double>> pairs(map.begin(), map.end());
+
+        // Every path must agree before it is timed. Postfix identifiers are
+        // variables, so formulas with calls skip the text paths.
+        bool textual = !hasFunctions(ast);
+        if (ast->evaluate(pairs) != ast->evaluate(map) ||
+            (textual && (PostfixToAST::convert(postfix)->toString() != text ||
+                         PostfixToAST::convert(tokens)->toString() != text))) {
+            errors.push_back(c.name + ": paths disagree");
+            continue;
+        }
+        if (textual && PostfixToAST::convert(converter.convertInfixToPostfix(text))->toString() != text) {
+            errors.push_back(c.name + ": InfixToPostfix round trip differs");
+            continue;
+        }
+
+        if (textual) {
+            results.push_back(measure(c.name, "InfixToPostfix::convertInfixToPostfix", [&] {
+                bench::doNotOptimize(static_cast<double>(converter.convertInfixToPostfix(text).size()));
+            }));
+            results.push_back(measure(c.name, "PostfixToAST::tokenize", [&] {
+                bench::doNotOptimize(static_cast<double>(PostfixToAST::tokenize(postfix).size()));
+            }));
+            results.push_back(measure(c.name, "PostfixToAST::convert(string)", [&] {
+                bench::doNotOptimize(static_cast<double>(PostfixToAST::convert(postfix)->type == NodeType::BINARY_OP));
+            }));
+            results.push_back(measure(c.name, "PostfixToAST::convert(tokens)", [&] {
+                bench::doNotOptimize(static_cast<double>(PostfixToAST::convert(tokens)->type == NodeType::BINARY_OP));
+            }));
+        }
+        results.push_back(measure(c.name, "ASTNode::evaluate(VariableMap)", [&] {
+            bench::doNotOptimize(ast->evaluate(map));
+        }));
+        results.push_back(measure(c.name, "ASTNode::evaluate(pairs)", [&] {
+            bench::doNotOptimize(ast->evaluate(pairs));
+        }));
+        results.push_back(measure(c.name, "ASTNode::toString", [&] {
+            bench::doNotOptimize(static_cast<double>(ast->toString().size()));
+        }));
+        results.push_back(measure(c.name, "ASTNode::collectVariables", [&] {
+            bench::doNotOptimize(static_cast<double>(ast->collectVariables().size()));
+        }));
+    }
+
+    std::cout.rdbuf(original);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "{\n  \"benchmark\": \"CoreBench\",\n  \"repetitions\": " << REPETITIONS << ",\n  \"cases\": [";
+    for (size_t i = 0; i < cases.size(); ++i) {
+        const Case& c = cases[i];
+        std::cout << (i ? "," : "") << "\n    {\"name\": " << jsonString(c.name)
+                  << ", \"nodes\": " << countNodes(c.ast.get())
+                  << ", \"variables\": " << c.variableCount << "}";
+    }
+    std::cout << "\n  ],\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::cout << (i ? "," : "") << "\n    {\"case\": " << jsonString(r.caseName)
+                  << ", \"operation\": " << jsonString(r.operation)
+                  << ", \"iterations\": " << r.iterations
+                  << ", \"best_ns\": " << r.bestNs << ", \"median_ns\": " << r.medianNs << "}";
+    }
+    std::cout << "\n  ],\n  \"errors\": [";
+    for (size_t i = 0; i < errors.size(); ++i) {
+        std::cout << (i ? ", " : "") << jsonString(errors[i]);
+    }
+    std::cout << "]\n}\n";
+    return errors.empty() ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+// Stress test for very deep trees: million-node chains built, evaluated,
+// printed and destroyed. ASTNode walks trees on an explicit stack and frees
+// them without recursion, so none of this depends on the thread's stack size.
+#include "BenchCommon.h"
+#include "../PostfixToAST.h"
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Build the tree, run every whole-tree operation once, then drop it
+static bool runCase(const std::string& name, const std::function<ASTNodePtr()>& build, const VariableMap& variables,
+                    double expected, size_t expectedLength) {
+    auto start = std::chrono::steady_clock::now();
+    ASTNodePtr ast = build();
+    double buildMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    double value = ast->evaluate(variables);
+    double evaluateMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    size_t length = ast->toString().size();
+    double toStringMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    size_t variableCount = ast->collectVariables().size();
+    bool hasVariables = ast->hasVariables();
+    double variablesMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    ast.reset();
+    double teardownMs = elapsedMs(start);
+
+    bool ok = std::abs(value - expected) <= 1e-9 * std::abs(expected) && length == expectedLength &&
+              hasVariables == (variableCount > 0);
+    std::cout << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << buildMs << std::setw(10) << evaluateMs << std::setw(10) << toStringMs
+              << std::setw(10) << variablesMs << std::setw(10) << teardownMs
+              << (ok ? "" : "   MISMATCH") << "\n";
+    return ok;
+}
+
+int main() {
+    const size_t terms = 1000000;
+    VariableMap variables = bench::makeVariables(8);
+    double sum = 0;
+    for (size_t i = 0; i < terms; ++i) sum += variables[bench::varName(i % 8)];
+
+    // "x0 + x1 + ... " with terms - 1 separators of 3 characters
+    size_t chainLength = 3 * (terms - 1);
+    for (size_t i = 0; i < terms; ++i) chainLength += bench::varName(i % 8).size();
+
+    std::cout << std::left << std::setw(26) << "case (ms)" << std::right << std::setw(10) << "build"
+              << std::setw(10) << "evaluate" << std::setw(10) << "toString" << std::setw(10) << "variables"
+              << std::setw(10) << "teardown" << "\n";
+
+    bool ok = true;
+    ok &= runCase("left chain, postfix", [&] {
+        std::string postfix = bench::varName(0);
+        for (size_t i = 1; i < terms; ++i) postfix += " " + bench::varName(i % 8) + " +";
+        return PostfixToAST::convert(postfix);
+    }, variables, sum, chainLength);
+
+    // a + (b + (c + ...)): every right child needs parentheses
+    ok &= runCase("right chain", [&] {
+        ASTNodePtr node = ASTNode::createVariable(bench::varName((terms - 1) % 8));
+        for (size_t i = terms - 1; i-- > 0;) {
+            node = ASTNode::createBinaryOp(OperatorType::ADD, ASTNode::createVariable(bench::varName(i % 8)), node);
+        }
+        return node;
+    }, variables, sum, chainLength + 2 * (terms - 2));
+
+    // -(-(...-(x0))) and abs(abs(...abs(x0))): one child per level
+    ok &= runCase("negation chain", [&] {
+        ASTNodePtr node = ASTNode::createVariable("x0");
+        for (size_t i = 0; i < terms; ++i) node = ASTNode::createUnaryOp(OperatorType::NEGATIVE, node);
+        return node;
+    }, variables, variables["x0"], 2 + terms);
+    ok &= runCase("nested calls", [&] {
+        ASTNodePtr node = ASTNode::createVariable("x0");
+        for (size_t i = 0; i < terms; ++i) node = ASTNode::createFunctionCall("abs", {node});
+        return node;
+    }, variables, variables["x0"], 2 + 5 * terms);
+
+    return ok ? 0 : 1;
+}
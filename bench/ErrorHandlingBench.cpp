@@ -0,0 +1,76 @@
+// Rows where evaluation fails: ASTNode::evaluate with try/catch versus
+// tryEvaluate per row, and BatchEvaluator::evaluate (stops at the first bad
+// row) versus evaluateIEEE, which marks bad rows in a bitmap and carries on.
+#include "BenchCommon.h"
+#include "../BatchEvaluator.h"
+#include "../InfixParser.h"
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+int main() {
+    const size_t rows = 200000;
+    ASTNodePtr ast = InfixParser::parse("sqrt(x0 * x1 + 1) / (x2 - 1) + log(x3)");
+    BatchEvaluator batch(ast);
+
+    std::cout << std::left << std::setw(10) << "bad rows" << std::right << std::setw(16) << "throw/catch"
+              << std::setw(16) << "tryEvaluate" << std::setw(10) << "speedup" << std::setw(16) << "batch"
+              << std::setw(16) << "IEEE batch" << "\n";
+
+    for (double badFraction : {0.0, 0.01, 0.1, 0.5}) {
+        // Bad rows divide by zero (x2 = 1); the others are in every domain
+        std::mt19937 rng(24);
+        std::uniform_real_distribution<double> uniform(1.5, 3.0);
+        std::bernoulli_distribution bad(badFraction);
+        std::vector<std::vector<double>> data(4, std::vector<double>(rows));
+        for (size_t r = 0; r < rows; ++r) {
+            for (size_t c = 0; c < 4; ++c) data[c][r] = uniform(rng);
+            if (bad(rng)) data[2][r] = 1;
+        }
+        std::vector<std::span<const double>> columns(data.begin(), data.end());
+        std::vector<VariableMap> maps(rows);
+        for (size_t r = 0; r < rows; ++r) {
+            for (size_t c = 0; c < 4; ++c) maps[r][bench::varName(c)] = data[c][r];
+        }
+
+        // Per row: failures become NaN either way
+        size_t thrown = 0, returned = 0;
+        double throwNs = bench::timePerIteration(1, [&] {
+            for (const auto& map : maps) {
+                try {
+                    bench::doNotOptimize(ast->evaluate(map));
+                } catch (const std::exception&) {
+                    ++thrown;
+                }
+            }
+        }) / rows;
+        double tryNs = bench::timePerIteration(1, [&] {
+            for (const auto& map : maps) {
+                auto value = ast->tryEvaluate(map);
+                if (!value) ++returned;
+                bench::doNotOptimize(value.valueOr(0.0));
+            }
+        }) / rows;
+
+        // Whole batch: the throwing path only gets as far as the first bad row
+        std::vector<double> output(rows);
+        std::vector<std::uint64_t> failed;
+        double batchNs = bench::timePerIteration(1, [&] {
+            try {
+                batch.evaluate(columns, output);
+            } catch (const BatchEvaluationError&) {}
+        }) / rows;
+        size_t marked = 0;
+        double ieeeNs = bench::timePerIteration(1, [&] { marked = batch.evaluateIEEE(columns, output, failed); }) / rows;
+
+        if (thrown != returned || marked != returned) {
+            std::cout << badFraction << ": MISMATCH\n";
+            continue;
+        }
+        std::cout << std::left << std::setw(10) << returned << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(13) << throwNs << " ns" << std::setw(13) << tryNs << " ns"
+                  << std::setprecision(2) << std::setw(9) << throwNs / tryNs << "x" << std::setprecision(1)
+                  << std::setw(13) << batchNs << " ns" << std::setw(13) << ieeeNs << " ns\n";
+    }
+    return 0;
+}
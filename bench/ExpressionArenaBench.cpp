@@ -0,0 +1,62 @@
+// Parsing many formulas into shared_ptr trees versus an ExpressionArena
+#include "BenchCommon.h"
+#include "../PostfixToAST.h"
+#include "../ExpressionArena.h"
+#include <iostream>
+#include <iomanip>
+
+// Postfix formula with `terms` variables joined by rotating operators
+static std::string makePostfixFormula(size_t seed, size_t terms) {
+    static const char* ops[] = {"+", "*", "-", "/"};
+    std::string postfix = bench::varName(seed % 7);
+    for (size_t i = 1; i < terms; ++i) {
+        postfix += " " + (i % 3 == 0 ? std::to_string((seed + i) % 9 + 1) : bench::varName((seed + i) % 7));
+        postfix += std::string(" ") + ops[(seed + i) % 4];
+    }
+    return postfix;
+}
+
+int main() {
+    const size_t formulaCount = 100000;
+    std::vector<std::string> formulas;
+    for (size_t i = 0; i < formulaCount; ++i) {
+        formulas.push_back(makePostfixFormula(i, 16));
+    }
+
+    // Same result from both representations
+    ExpressionArena check;
+    VariableMap variables = bench::makeVariables(7);
+    if (PostfixToAST::convert(formulas[1])->evaluate(variables) !=
+        PostfixToAST::convert(formulas[1], check)->evaluate(check.getSymbols(), variables)) {
+        std::cout << "MISMATCH between shared_ptr and arena trees\n";
+        return 1;
+    }
+
+    double sharedNs = bench::timePerIteration(1, [&] {
+        for (const auto& formula : formulas) {
+            ASTNodePtr ast = PostfixToAST::convert(formula);
+            bench::doNotOptimize(static_cast<double>(ast->type == NodeType::BINARY_OP));
+        }
+    }) / static_cast<double>(formulaCount);
+
+    size_t nodes = 0;
+    size_t bytes = 0;
+    double arenaNs = bench::timePerIteration(1, [&] {
+        ExpressionArena arena;
+        for (const auto& formula : formulas) {
+            const ArenaNode* ast = PostfixToAST::convert(formula, arena);
+            bench::doNotOptimize(static_cast<double>(ast->type == NodeType::BINARY_OP));
+            nodes = arena.getNodeCount();
+            bytes = arena.getBytesUsed();
+            arena.reset();
+        }
+    }) / static_cast<double>(formulaCount);
+
+    std::cout << "formulas: " << formulaCount << " (" << nodes << " nodes, "
+              << bytes << " arena bytes each)\n";
+    std::cout << std::fixed << std::setprecision(1)
+              << "shared_ptr parse: " << sharedNs << " ns/formula\n"
+              << "arena parse:      " << arenaNs << " ns/formula\n"
+              << std::setprecision(2) << "speedup:          " << sharedNs / arenaNs << "x\n";
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+// Parsing repeated formula strings: parsing and compiling on every request
+// versus ExpressionCache lookups, single-threaded and from several threads
+#include "BenchCommon.h"
+#include "../ExpressionCache.h"
+#include "../InfixParser.h"
+#include "../InfixToPostfix.h"
+#include "../PostfixToAST.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+// Distinct formulas of moderate size (no function calls: InfixToPostfix
+// does not handle them)
+static std::string makeFormula(size_t seed) {
+    static const char* ops[] = {" + ", " * ", " - ", " / "};
+    std::string infix = bench::varName(seed % 5);
+    for (size_t i = 1; i < 12; ++i) {
+        infix += ops[(seed + i) % 4];
+        infix += i % 4 == 0 ? "(" + bench::varName((seed + i) % 7) + " - " + std::to_string(seed % 97 + i) + ")"
+                            : bench::varName((seed * 3 + i) % 7);
+    }
+    return infix;
+}
+
+int main() {
+    const size_t distinct = 2000;
+    const size_t requests = 200000;
+    std::vector<std::string> formulas;
+    for (size_t i = 0; i < distinct; ++i) formulas.push_back(makeFormula(i));
+
+    // Request stream: skewed towards a hot subset
+    std::vector<size_t> stream(requests);
+    for (size_t i = 0; i < requests; ++i) {
+        stream[i] = (i % 10 < 8) ? (i * 7919) % (distinct / 10) : (i * 104729) % distinct;
+    }
+
+    // InfixToPostfix echoes every expression; keep the benchmark output clean
+    std::stringstream sink;
+    std::streambuf* original = std::cout.rdbuf(sink.rdbuf());
+    InfixToPostfix converter;
+    double uncachedNs = bench::timePerIteration(requests / 10, [&, i = size_t(0)]() mutable {
+        CompiledExpression compiled(PostfixToAST::convert(converter.convertInfixToPostfix(formulas[stream[i++]])));
+        bench::doNotOptimize(compiled.getMaxStackDepth());
+        sink.str("");
+    });
+    std::cout.rdbuf(original);
+    double directNs = bench::timePerIteration(requests / 10, [&, i = size_t(0)]() mutable {
+        CompiledExpression compiled(InfixParser::parse(formulas[stream[i++]]));
+        bench::doNotOptimize(compiled.getMaxStackDepth());
+    });
+
+    std::stringstream report;
+    report << std::left << std::setw(28) << "case" << std::right << std::setw(12) << "ns/request"
+           << std::setw(10) << "hits" << std::setw(10) << "misses" << std::setw(11) << "evictions" << "\n";
+    report << std::left << std::setw(28) << "uncached two-step" << std::right << std::fixed << std::setprecision(1)
+           << std::setw(12) << uncachedNs << "\n";
+    report << std::left << std::setw(28) << "uncached InfixParser" << std::right << std::setw(12) << directNs << "\n";
+
+    for (size_t capacity : {4096, 512}) {
+        ExpressionCache cache(capacity);
+        double cachedNs = bench::timePerIteration(requests, [&, i = size_t(0)]() mutable {
+            bench::doNotOptimize(cache.get(formulas[stream[i++]])->compiled.getMaxStackDepth());
+        });
+        ExpressionCache::Stats stats = cache.getStats();
+        report << std::left << std::setw(28) << ("cache, capacity " + std::to_string(capacity)) << std::right
+               << std::setw(12) << cachedNs << std::setw(10) << stats.hits << std::setw(10) << stats.misses
+               << std::setw(11) << stats.evictions << "\n";
+    }
+
+    // Concurrent lookups against a warm cache
+    ExpressionCache shared(4096);
+    for (const auto& formula : formulas) shared.get(formula);
+    for (size_t threadCount : {1, 4}) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < threadCount; ++t) {
+            threads.emplace_back([&, t] {
+                for (size_t i = t; i < requests; i += threadCount) {
+                    bench::doNotOptimize(shared.get(formulas[stream[i]])->compiled.getMaxStackDepth());
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        report << std::left << std::setw(28) << ("warm cache, " + std::to_string(threadCount) + " threads")
+               << std::right << std::setw(12) << ns / static_cast<double>(requests) << "\n";
+    }
+
+    std::cout << report.str();
+    return 0;
+}
@@ -0,0 +1,159 @@
+// Cold start for a catalog of formulas: reading and parsing the infix text
+// versus mapping a saved ExpressionImage and evaluating from the mapped pages.
+// Also checks the round trip: every mapped expression must give the same
+// toString() and evaluate() result (or error) as the tree it was saved from.
+#include "BenchCommon.h"
+#include "../ExpressionImage.h"
+#include "../InfixParser.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+#if defined(__unix__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Ask the kernel to drop the file's cached pages so the next read goes to disk
+static void dropFromPageCache(const std::string& path) {
+#if defined(__unix__)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    ::fdatasync(fd);
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+#else
+    (void)path;
+#endif
+}
+
+// Random formula over x0..x8; x8 is left undefined, so some evaluations fail
+static ASTNodePtr randomFormula(std::mt19937& rng, size_t depth) {
+    std::uniform_int_distribution<int> pick(0, 9);
+    int choice = depth == 0 ? pick(rng) % 2 : pick(rng);
+    switch (choice) {
+        case 0: return ASTNode::createNumber(static_cast<double>(rng() % 1000) / 8.0);
+        case 1: return ASTNode::createVariable(bench::varName(rng() % 9));
+        case 2: return ASTNode::createUnaryOp(OperatorType::NEGATIVE, randomFormula(rng, depth - 1));
+        case 3: {
+            static const char* functions[] = {"sin", "cos", "sqrt", "log", "exp", "abs"};
+            return ASTNode::createFunctionCall(functions[rng() % 6], {randomFormula(rng, depth - 1)});
+        }
+        default: {
+            static const OperatorType ops[] = {OperatorType::ADD, OperatorType::SUBTRACT, OperatorType::MULTIPLY,
+                                               OperatorType::DIVIDE, OperatorType::POWER};
+            return ASTNode::createBinaryOp(ops[rng() % 5], randomFormula(rng, depth - 1),
+                                           randomFormula(rng, depth - 1));
+        }
+    }
+}
+
+// Value, or the error message prefixed with '!'. NaNs compare equal whatever
+// their sign bit, which depends on the operand order the compiler picked.
+template <typename Fn>
+static std::string outcome(Fn&& evaluate) {
+    try {
+        double value = evaluate();
+        return std::isnan(value) ? "nan" : std::to_string(value);
+    } catch (const std::exception& e) {
+        return std::string("!") + e.what();
+    }
+}
+
+int main() {
+    const size_t count = 20000;
+    std::mt19937 rng(18);
+    VariableMap variables = bench::makeVariables(8);
+
+    auto directory = std::filesystem::temp_directory_path();
+    std::string textPath = (directory / "image_bench.txt").string();
+    std::string imagePath = (directory / "image_bench.img").string();
+
+    std::vector<ASTNodePtr> formulas;
+    {
+        std::ofstream text(textPath);
+        ExpressionImageWriter writer;
+        for (size_t i = 0; i < count; ++i) {
+            // Round through the parser so the trees are exactly what the text gives back
+            std::string infix = randomFormula(rng, 2 + rng() % 5)->toString();
+            formulas.push_back(InfixParser::parse(infix));
+            text << infix << "\n";
+            writer.add(formulas.back(), "f" + std::to_string(i));
+        }
+        writer.save(imagePath);
+    }
+
+    // Round trip
+    size_t mismatches = 0;
+    {
+        ExpressionImage image = ExpressionImage::open(imagePath);
+        image.verify();
+        for (size_t i = 0; i < count; ++i) {
+            MappedExpression mapped = image[i];
+            if (mapped.toString() != formulas[i]->toString() ||
+                outcome([&] { return mapped.evaluate(variables); }) !=
+                    outcome([&] { return formulas[i]->evaluate(variables); }) ||
+                image.find("f" + std::to_string(i)) != i) {
+                if (++mismatches <= 5) std::cout << "MISMATCH f" << i << ": " << formulas[i]->toString() << "\n";
+            }
+        }
+        if (image.find("missing") != ExpressionImage::NOT_FOUND) ++mismatches;
+    }
+    std::cout << "round trip: " << count << " formulas, " << mismatches << " mismatches\n";
+
+    std::cout << "text " << std::filesystem::file_size(textPath) << " bytes, image "
+              << std::filesystem::file_size(imagePath) << " bytes\n\n";
+    std::cout << std::left << std::setw(36) << "case" << std::right << std::setw(12) << "ms" << "\n";
+    auto report = [](const std::string& name, double ms) {
+        std::cout << std::left << std::setw(36) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << ms << "\n";
+    };
+
+    // Load every formula and evaluate each once, starting from cold files
+    double sum = 0;
+    dropFromPageCache(textPath);
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::ifstream text(textPath);
+        std::string line;
+        while (std::getline(text, line)) {
+            ASTNodePtr ast = InfixParser::parse(line);
+            try { sum += ast->evaluate(variables); } catch (const std::exception&) {}
+        }
+    }
+    report("parse text, evaluate all", elapsedMs(start));
+
+    dropFromPageCache(imagePath);
+    start = std::chrono::steady_clock::now();
+    {
+        ExpressionImage image = ExpressionImage::open(imagePath);
+        for (size_t i = 0; i < image.size(); ++i) {
+            try { sum -= image[i].evaluate(variables); } catch (const std::exception&) {}
+        }
+    }
+    report("map image, evaluate all", elapsedMs(start));
+
+    // Time to the first answer for one named formula
+    dropFromPageCache(imagePath);
+    start = std::chrono::steady_clock::now();
+    {
+        ExpressionImage image = ExpressionImage::open(imagePath);
+        try { bench::doNotOptimize(image[image.find("f12345")].evaluate(variables)); } catch (const std::exception&) {}
+    }
+    report("map image, evaluate one by name", elapsedMs(start));
+    bench::doNotOptimize(sum);
+
+    std::remove(textPath.c_str());
+    std::remove(imagePath.c_str());
+    return mismatches == 0 ? 0 : 1;
+}
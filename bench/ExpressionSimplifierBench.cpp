@@ -0,0 +1,77 @@
+// Evaluating generated formulas before and after ExpressionSimplifier
+#include "BenchCommon.h"
+#include "../ExpressionSimplifier.h"
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+
+// Sum of `terms` generated terms, each padded with constant subtrees and identities:
+// (x * (2 * 3.5) + (y + 0) * 1) / (sqrt(16) - 1) ^ 1
+static ASTNodePtr makeVerboseFormula(size_t terms, size_t variableCount) {
+    auto num = [](double value) { return ASTNode::createNumber(value); };
+    ASTNodePtr sum;
+    for (size_t i = 0; i < terms; ++i) {
+        ASTNodePtr x = ASTNode::createVariable(bench::varName(i % variableCount));
+        ASTNodePtr y = ASTNode::createVariable(bench::varName((i + 3) % variableCount));
+        ASTNodePtr scaled = ASTNode::createBinaryOp(OperatorType::MULTIPLY, x,
+            ASTNode::createBinaryOp(OperatorType::MULTIPLY, num(2.0 + static_cast<double>(i % 5)), num(3.5)));
+        ASTNodePtr padded = ASTNode::createBinaryOp(OperatorType::MULTIPLY,
+            ASTNode::createBinaryOp(OperatorType::ADD, y, num(0.0)), num(1.0));
+        ASTNodePtr divisor = ASTNode::createBinaryOp(OperatorType::POWER,
+            ASTNode::createBinaryOp(OperatorType::SUBTRACT,
+                ASTNode::createFunctionCall("sqrt", {num(16.0)}), num(1.0)),
+            num(1.0));
+        ASTNodePtr term = ASTNode::createBinaryOp(OperatorType::DIVIDE,
+            ASTNode::createBinaryOp(OperatorType::ADD, scaled, padded), divisor);
+        sum = sum ? ASTNode::createBinaryOp(OperatorType::ADD, sum, term) : term;
+    }
+    return sum;
+}
+
+static void runCase(const std::string& name, const ASTNodePtr& ast, bool ieeeExact,
+                    const VariableMap& variables, size_t iterations) {
+    ExpressionSimplifier simplifier(ieeeExact);
+    double simplifyNs = bench::timePerIteration(iterations / 100 + 1, [&] {
+        bench::doNotOptimize(static_cast<double>(simplifier.simplify(ast)->type == NodeType::NUMBER));
+    });
+    ASTNodePtr simple = simplifier.simplify(ast);
+
+    double expected = ast->evaluate(variables);
+    double actual = simple->evaluate(variables);
+    if (ieeeExact ? expected != actual : std::abs(expected - actual) > 1e-9 * std::abs(expected)) {
+        std::cout << name << ": MISMATCH original=" << expected << " simplified=" << actual << "\n";
+        return;
+    }
+
+    double originalNs = bench::timePerIteration(iterations, [&] {
+        bench::doNotOptimize(ast->evaluate(variables));
+    });
+    double simpleNs = bench::timePerIteration(iterations, [&] {
+        bench::doNotOptimize(simple->evaluate(variables));
+    });
+
+    size_t nodes = ExpressionSimplifier::countNodes(ast);
+    std::cout << std::left << std::setw(24) << name
+              << std::right << std::setw(8) << nodes << " -> " << std::setw(6) << nodes - simplifier.getRemovedNodes()
+              << std::fixed << std::setprecision(1)
+              << std::setw(12) << simplifyNs << " ns"
+              << std::setw(12) << originalNs << " ns"
+              << std::setw(12) << simpleNs << " ns"
+              << std::setprecision(2) << std::setw(9) << originalNs / simpleNs << "x\n";
+}
+
+int main() {
+    std::cout << std::left << std::setw(24) << "case"
+              << std::right << std::setw(18) << "nodes"
+              << std::setw(15) << "simplify"
+              << std::setw(15) << "original"
+              << std::setw(15) << "simplified"
+              << std::setw(10) << "speedup" << "\n";
+
+    VariableMap variables = bench::makeVariables(16);
+    runCase("8 terms", makeVerboseFormula(8, 16), false, variables, 200000);
+    runCase("8 terms (ieee exact)", makeVerboseFormula(8, 16), true, variables, 200000);
+    runCase("256 terms", makeVerboseFormula(256, 16), false, variables, 5000);
+    runCase("256 terms (ieee exact)", makeVerboseFormula(256, 16), true, variables, 5000);
+    return 0;
+}
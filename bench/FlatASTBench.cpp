@@ -0,0 +1,73 @@
+// Memory footprint and traversal speed: shared_ptr ASTNode tree versus FlatAST
+#include "BenchCommon.h"
+#include "../FlatAST.h"
+#include <iostream>
+#include <iomanip>
+
+// Approximate heap bytes of a shared_ptr tree: each make_shared block holds the
+// node plus two reference counts and a vtable pointer, plus malloc overhead
+static size_t estimateTreeBytes(const ASTNodePtr& node, size_t& nodes) {
+    ++nodes;
+    size_t bytes = sizeof(ASTNode) + 16 + 16;
+    switch(node->type) {
+        case NodeType::VARIABLE:
+            if (node->variable.name.capacity() > 15) bytes += node->variable.name.capacity() + 1 + 16;
+            break;
+        case NodeType::BINARY_OP:
+            bytes += estimateTreeBytes(node->op.left, nodes) + estimateTreeBytes(node->op.right, nodes);
+            break;
+        case NodeType::UNARY_OP:
+            bytes += estimateTreeBytes(node->op.left, nodes);
+            break;
+        case NodeType::FUNCTION_CALL:
+            bytes += node->function.arguments.capacity() * sizeof(ASTNodePtr) + 16;
+            for (const auto& arg : node->function.arguments) bytes += estimateTreeBytes(arg, nodes);
+            break;
+        default:
+            break;
+    }
+    return bytes;
+}
+
+static void runCase(const std::string& name, const ASTNodePtr& ast, size_t iterations) {
+    FlatAST flat = FlatAST::fromAST(ast);
+    VariableMap variables = bench::makeVariables(16);
+
+    if (flat.toString() != ast->toString() || flat.evaluate(variables) != ast->evaluate(variables) ||
+        flat.collectVariables() != ast->collectVariables()) {
+        std::cout << name << ": MISMATCH\n";
+        return;
+    }
+
+    size_t nodes = 0;
+    size_t treeBytes = estimateTreeBytes(ast, nodes);
+
+    double treeEval = bench::timePerIteration(iterations, [&] { bench::doNotOptimize(ast->evaluate(variables)); });
+    double flatEval = bench::timePerIteration(iterations, [&] { bench::doNotOptimize(flat.evaluate(variables)); });
+    double treeText = bench::timePerIteration(iterations / 10 + 1, [&] {
+        bench::doNotOptimize(static_cast<double>(ast->toString().size()));
+    });
+    double flatText = bench::timePerIteration(iterations / 10 + 1, [&] {
+        bench::doNotOptimize(static_cast<double>(flat.toString().size()));
+    });
+    double treeVars = bench::timePerIteration(iterations, [&] {
+        bench::doNotOptimize(static_cast<double>(ast->collectVariables().size()));
+    });
+    double flatVars = bench::timePerIteration(iterations, [&] {
+        bench::doNotOptimize(static_cast<double>(flat.collectVariables().size()));
+    });
+
+    std::cout << name << " (" << nodes << " nodes)\n" << std::fixed << std::setprecision(1)
+              << "  memory:           " << std::setw(10) << treeBytes << " B tree  "
+              << std::setw(10) << flat.memoryBytes() << " B flat  ("
+              << static_cast<double>(treeBytes) / static_cast<double>(flat.memoryBytes()) << "x smaller)\n"
+              << "  evaluate:         " << std::setw(10) << treeEval << " ns     " << std::setw(10) << flatEval << " ns\n"
+              << "  toString:         " << std::setw(10) << treeText << " ns     " << std::setw(10) << flatText << " ns\n"
+              << "  collectVariables: " << std::setw(10) << treeVars << " ns     " << std::setw(10) << flatVars << " ns\n";
+}
+
+int main() {
+    runCase("deep chain (1000)", bench::makeDeepChain(1000, 16), 5000);
+    runCase("wide tree (depth 10)", bench::makeWideTree(10, 16), 2000);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+// Full gradient of a 40-input expression: central finite differences (2N
+// evaluations) versus one forward and reverse sweep of GradientEvaluator,
+// for a single point and for a batch of rows
+#include "BenchCommon.h"
+#include "../GradientEvaluator.h"
+#include "../BatchEvaluator.h"
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+static void report(const std::string& name, double finiteNs, double sweepNs, double maxError) {
+    std::cout << std::left << std::setw(34) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(14) << finiteNs << " ns" << std::setw(14) << sweepNs << " ns" << std::setw(8)
+              << finiteNs / sweepNs << "x" << std::scientific << std::setprecision(1) << std::setw(12)
+              << maxError << "\n";
+}
+
+static void pointCase(const std::string& name, const ASTNodePtr& ast) {
+    GradientEvaluator gradient(ast);
+    const auto& variables = gradient.getVariables();
+    VariableMap values = bench::makeVariables(40);
+    std::vector<double> slots;
+    for (const auto& variable : variables) slots.push_back(values[variable]);
+
+    std::vector<double> finite(variables.size());
+    double finiteNs = bench::timePerIteration(200, [&] {
+        for (size_t i = 0; i < variables.size(); ++i) {
+            double& x = values[variables[i]];
+            double h = 1e-6 * std::max(1.0, std::abs(x));
+            double saved = x;
+            x = saved + h;
+            double up = ast->evaluate(values);
+            x = saved - h;
+            double down = ast->evaluate(values);
+            x = saved;
+            finite[i] = (up - down) / (2 * h);
+        }
+    });
+
+    std::vector<double> exact(variables.size());
+    double sweepNs = bench::timePerIteration(200, [&] {
+        bench::doNotOptimize(gradient.evaluate(slots, exact));
+    });
+
+    double maxError = 0;
+    for (size_t i = 0; i < exact.size(); ++i) {
+        maxError = std::max(maxError, std::abs(exact[i] - finite[i]) / std::max(1.0, std::abs(exact[i])));
+    }
+    report(name + ", one point", finiteNs, sweepNs, maxError);
+}
+
+static void batchCase(const std::string& name, const ASTNodePtr& ast) {
+    const size_t rows = 16384;
+    GradientEvaluator gradient(ast);
+    BatchEvaluator batch(ast);
+    const auto& variables = gradient.getVariables();
+
+    std::vector<std::vector<double>> columns(variables.size(), std::vector<double>(rows));
+    for (size_t c = 0; c < columns.size(); ++c) {
+        for (size_t r = 0; r < rows; ++r) columns[c][r] = 1.0 + static_cast<double>((r * 31 + c * 17) % 97) / 97.0;
+    }
+    std::vector<std::span<const double>> inputs(columns.begin(), columns.end());
+    std::vector<double> output(rows), up(rows), down(rows);
+
+    // Finite differences: shift one column at a time and evaluate twice
+    std::vector<std::vector<double>> finite(variables.size(), std::vector<double>(rows));
+    double finiteNs = bench::timePerIteration(1, [&] {
+        for (size_t i = 0; i < variables.size(); ++i) {
+            std::vector<double> saved = columns[i];
+            for (size_t r = 0; r < rows; ++r) columns[i][r] = saved[r] * (1 + 1e-6);
+            batch.evaluate(inputs, up);
+            for (size_t r = 0; r < rows; ++r) columns[i][r] = saved[r] * (1 - 1e-6);
+            batch.evaluate(inputs, down);
+            columns[i] = saved;
+            for (size_t r = 0; r < rows; ++r) finite[i][r] = (up[r] - down[r]) / (2e-6 * saved[r]);
+        }
+    }) / rows;
+
+    std::vector<std::vector<double>> exact(variables.size(), std::vector<double>(rows));
+    std::vector<std::span<double>> gradients(exact.begin(), exact.end());
+    double sweepNs = bench::timePerIteration(3, [&] {
+        gradient.evaluate(inputs, output, gradients);
+    }) / rows;
+
+    double maxError = 0;
+    for (size_t i = 0; i < exact.size(); ++i) {
+        for (size_t r = 0; r < rows; ++r) {
+            maxError = std::max(maxError,
+                                std::abs(exact[i][r] - finite[i][r]) / std::max(1.0, std::abs(exact[i][r])));
+        }
+    }
+    report(name + ", per row", finiteNs, sweepNs, maxError);
+}
+
+int main() {
+    std::cout << std::left << std::setw(34) << "case" << std::right << std::setw(17) << "finite diff"
+              << std::setw(17) << "reverse sweep" << std::setw(9) << "speedup" << std::setw(12) << "max error"
+              << "\n";
+    ASTNodePtr wide = bench::makeWideTree(9, 40);
+    ASTNodePtr deep = bench::makeDeepChain(200, 40);
+    pointCase("wide tree (depth 9)", wide);
+    pointCase("deep chain (200)", deep);
+    batchCase("wide tree (depth 9)", wide);
+    batchCase("deep chain (200)", deep);
+    return 0;
+}
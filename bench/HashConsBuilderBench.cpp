@@ -0,0 +1,89 @@
+// Repeated subterms: tree versus hash-consed DAG, for the tree walk, bytecode and batch paths
+#include "BenchCommon.h"
+#include "../HashConsBuilder.h"
+#include "../CompiledExpression.h"
+#include "../BatchEvaluator.h"
+#include <iostream>
+#include <iomanip>
+
+// Sum of `terms` products, each using one of `distinct` copies of
+// sqrt(xj * xj + xk * xk) / (1 + exp(-xj)), rebuilt from scratch every time
+static ASTNodePtr makeRepeatedFormula(size_t terms, size_t distinct, size_t variableCount) {
+    auto var = [&](size_t i) { return ASTNode::createVariable(bench::varName(i % variableCount)); };
+    ASTNodePtr sum;
+    for (size_t i = 0; i < terms; ++i) {
+        size_t j = i % distinct;
+        ASTNodePtr norm = ASTNode::createFunctionCall("sqrt", {ASTNode::createBinaryOp(OperatorType::ADD,
+            ASTNode::createBinaryOp(OperatorType::MULTIPLY, var(j), var(j)),
+            ASTNode::createBinaryOp(OperatorType::MULTIPLY, var(j + 1), var(j + 1)))});
+        ASTNodePtr sigmoid = ASTNode::createBinaryOp(OperatorType::ADD, ASTNode::createNumber(1.0),
+            ASTNode::createFunctionCall("exp", {ASTNode::createUnaryOp(OperatorType::NEGATIVE, var(j))}));
+        ASTNodePtr term = ASTNode::createBinaryOp(OperatorType::MULTIPLY, var(i + 2),
+            ASTNode::createBinaryOp(OperatorType::DIVIDE, norm, sigmoid));
+        sum = sum ? ASTNode::createBinaryOp(OperatorType::ADD, sum, term) : term;
+    }
+    return sum;
+}
+
+static void runCase(const std::string& name, const ASTNodePtr& tree, size_t iterations) {
+    HashConsBuilder builder;
+    ASTNodePtr dag = builder.build(tree);
+    VariableMap variables = bench::makeVariables(16);
+
+    CompiledExpression compiledTree(tree);
+    CompiledExpression compiledDag(dag);
+    DagEvaluator dagEvaluator(dag);
+    double expected = tree->evaluate(variables);
+    if (HashConsBuilder::evaluate(dag, variables) != expected || dagEvaluator.evaluate(variables) != expected ||
+        compiledDag.evaluate(variables) != expected ||
+        dag->toString() != tree->toString()) {
+        std::cout << name << ": MISMATCH\n";
+        return;
+    }
+
+    double treeNs = bench::timePerIteration(iterations, [&] { bench::doNotOptimize(tree->evaluate(variables)); });
+    double dagNs = bench::timePerIteration(iterations, [&] {
+        bench::doNotOptimize(dagEvaluator.evaluate(variables));
+    });
+    std::vector<double> slots = compiledTree.getBinding().bind(variables);
+    double compiledTreeNs = bench::timePerIteration(iterations, [&] {
+        bench::doNotOptimize(compiledTree.evaluate(slots.data()));
+    });
+    double compiledDagNs = bench::timePerIteration(iterations, [&] {
+        bench::doNotOptimize(compiledDag.evaluate(slots.data()));
+    });
+
+    // Batch over 64K rows
+    const size_t rows = 65536;
+    std::vector<std::vector<double>> data(compiledTree.getVariables().size(), std::vector<double>(rows));
+    for (size_t c = 0; c < data.size(); ++c) {
+        for (size_t r = 0; r < rows; ++r) data[c][r] = 0.5 + static_cast<double>((r * 7 + c) % 97) / 97.0;
+    }
+    std::vector<std::span<const double>> columns(data.begin(), data.end());
+    std::vector<double> output(rows);
+    BatchEvaluator batchTree(tree);
+    BatchEvaluator batchDag(dag);
+    double batchTreeNs = bench::timePerIteration(5, [&] { batchTree.evaluate(columns, output); }) / rows;
+    double batchDagNs = bench::timePerIteration(5, [&] { batchDag.evaluate(columns, output); }) / rows;
+
+    std::cout << std::left << std::setw(22) << name
+              << std::right << std::setw(7) << builder.getTotalNodes() << " -> " << std::setw(5) << builder.getUniqueNodes()
+              << std::fixed << std::setprecision(1)
+              << std::setw(11) << treeNs << std::setw(11) << dagNs
+              << std::setw(11) << compiledTreeNs << std::setw(11) << compiledDagNs
+              << std::setprecision(2)
+              << std::setw(11) << batchTreeNs << std::setw(11) << batchDagNs << "\n";
+}
+
+int main() {
+    std::cout << std::left << std::setw(22) << "case"
+              << std::right << std::setw(15) << "nodes"
+              << std::setw(11) << "tree ns" << std::setw(11) << "dag ns"
+              << std::setw(11) << "bc tree" << std::setw(11) << "bc dag"
+              << std::setw(11) << "batch tree" << std::setw(11) << "batch dag" << "  (batch: ns/row)\n";
+
+    runCase("16 terms, 2 shared", makeRepeatedFormula(16, 2, 16), 100000);
+    runCase("64 terms, 4 shared", makeRepeatedFormula(64, 4, 16), 20000);
+    runCase("64 terms, 16 shared", makeRepeatedFormula(64, 16, 16), 20000);
+    return 0;
+}
@@ -0,0 +1,66 @@
+// Simulation-style loop: a 40-input expression where one or two inputs change
+// per step. Full ASTNode::evaluate per step versus IncrementalEvaluator.
+#include "BenchCommon.h"
+#include "../IncrementalEvaluator.h"
+#include <iostream>
+#include <iomanip>
+
+static void runCase(const std::string& name, const ASTNodePtr& ast, size_t changesPerStep) {
+    const size_t steps = 20000;
+    std::vector<std::string> variables = ast->collectVariables();
+    VariableMap values;
+    for (size_t i = 0; i < variables.size(); ++i) values[variables[i]] = 1.0 + static_cast<double>(i) / 64.0;
+    IncrementalEvaluator incremental(ast, values);
+    incremental.result();
+    std::uint64_t startTotal = incremental.getTotalRecomputed();
+
+    // Pre-drawn updates so both loops see the same sequence
+    std::vector<std::pair<size_t, double>> updates;
+    for (size_t step = 0; step < steps; ++step) {
+        for (size_t c = 0; c < changesPerStep; ++c) {
+            size_t slot = (step * 13 + c * 7) % variables.size();
+            updates.push_back({slot, 1.0 + static_cast<double>((step * 31 + c) % 97) / 97.0});
+        }
+    }
+
+    double treeNs = bench::timePerIteration(steps, [&, step = size_t(0)]() mutable {
+        for (size_t c = 0; c < changesPerStep; ++c) {
+            const auto& [slot, value] = updates[step * changesPerStep + c];
+            values[variables[slot]] = value;
+        }
+        ++step;
+        bench::doNotOptimize(ast->evaluate(values));
+    });
+
+    double check = 0;
+    double incrementalNs = bench::timePerIteration(steps, [&, step = size_t(0)]() mutable {
+        for (size_t c = 0; c < changesPerStep; ++c) {
+            const auto& [slot, value] = updates[step * changesPerStep + c];
+            incremental.set(slot, value);
+        }
+        ++step;
+        check = incremental.result();
+        bench::doNotOptimize(check);
+    });
+
+    if (check != ast->evaluate(values)) {
+        std::cout << name << ": MISMATCH\n";
+        return;
+    }
+    double recomputed = static_cast<double>(incremental.getTotalRecomputed() - startTotal) / steps;
+    std::cout << std::left << std::setw(26) << name << std::right << std::setw(8) << changesPerStep
+              << std::setw(8) << incremental.getNodeCount() << std::fixed << std::setprecision(1)
+              << std::setw(12) << recomputed << std::setw(12) << treeNs << " ns" << std::setw(12)
+              << incrementalNs << " ns" << std::setw(8) << treeNs / incrementalNs << "x\n";
+}
+
+int main() {
+    std::cout << std::left << std::setw(26) << "case" << std::right << std::setw(8) << "changed"
+              << std::setw(8) << "nodes" << std::setw(12) << "recomputed" << std::setw(15) << "full"
+              << std::setw(15) << "incremental" << std::setw(9) << "speedup\n";
+    for (size_t changes : {1, 2, 8}) {
+        runCase("wide tree (depth 9)", bench::makeWideTree(9, 40), changes);
+        runCase("deep chain (200)", bench::makeDeepChain(200, 40), changes);
+    }
+    return 0;
+}
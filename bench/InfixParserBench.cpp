@@ -0,0 +1,70 @@
+// Two-step InfixToPostfix + PostfixToAST versus the direct InfixParser
+#include "BenchCommon.h"
+#include "../InfixToPostfix.h"
+#include "../PostfixToAST.h"
+#include "../InfixParser.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+// Infix formula with `terms` operands, parentheses every few terms
+static std::string makeInfixFormula(size_t terms) {
+    static const char* ops[] = {" + ", " * ", " - ", " / "};
+    std::string infix = "x0";
+    for (size_t i = 1; i < terms; ++i) {
+        infix += ops[i % 4];
+        if (i % 5 == 0) {
+            infix += "(" + bench::varName(i % 9) + " + " + std::to_string(i % 7 + 1) + ")";
+        } else {
+            infix += bench::varName(i % 9);
+        }
+    }
+    return infix;
+}
+
+int main() {
+    // InfixToPostfix echoes every expression; keep the benchmark output clean
+    std::stringstream sink;
+    std::streambuf* original = std::cout.rdbuf(sink.rdbuf());
+
+    std::stringstream report;
+    report << std::left << std::setw(14) << "terms" << std::right
+           << std::setw(16) << "two-step" << std::setw(16) << "direct"
+           << std::setw(16) << "direct+arena" << std::setw(10) << "speedup" << "\n";
+
+    InfixToPostfix converter;
+    for (size_t terms : {8, 64, 512}) {
+        std::string infix = makeInfixFormula(terms);
+        size_t iterations = 200000 / terms;
+
+        if (InfixParser::parse(infix)->toString() !=
+            PostfixToAST::convert(converter.convertInfixToPostfix(infix))->toString()) {
+            report << terms << ": MISMATCH\n";
+            continue;
+        }
+
+        double twoStep = bench::timePerIteration(iterations, [&] {
+            ASTNodePtr ast = PostfixToAST::convert(converter.convertInfixToPostfix(infix));
+            bench::doNotOptimize(static_cast<double>(ast->type == NodeType::BINARY_OP));
+        });
+        double direct = bench::timePerIteration(iterations, [&] {
+            ASTNodePtr ast = InfixParser::parse(infix);
+            bench::doNotOptimize(static_cast<double>(ast->type == NodeType::BINARY_OP));
+        });
+        ExpressionArena arena;
+        double arenaNs = bench::timePerIteration(iterations, [&] {
+            const ArenaNode* ast = InfixParser::parse(infix, arena);
+            bench::doNotOptimize(static_cast<double>(ast->type == NodeType::BINARY_OP));
+            arena.reset();
+        });
+
+        report << std::left << std::setw(14) << terms << std::right << std::fixed << std::setprecision(1)
+               << std::setw(13) << twoStep << " ns" << std::setw(13) << direct << " ns"
+               << std::setw(13) << arenaNs << " ns"
+               << std::setprecision(2) << std::setw(9) << twoStep / arenaNs << "x\n";
+    }
+
+    std::cout.rdbuf(original);
+    std::cout << report.str();
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+// Tree walk versus bytecode versus native code, all reading pre-bound slots
+#include "BenchCommon.h"
+#include "../JitExpression.h"
+#include <iostream>
+#include <iomanip>
+
+static void runCase(const std::string& name, const ASTNodePtr& ast, size_t iterations) {
+    VariableMap variables = bench::makeVariables(16);
+    JitExpression jit(ast);
+    const CompiledExpression& compiled = jit.getCompiled();
+    std::vector<double> slots = jit.getBinding().bind(variables);
+
+    double expected = ast->evaluate(variables);
+    if (jit.evaluate(slots.data()) != expected) {
+        std::cout << name << ": MISMATCH\n";
+        return;
+    }
+
+    double treeNs = bench::timePerIteration(iterations, [&] { bench::doNotOptimize(ast->evaluate(variables)); });
+    double compiledNs = bench::timePerIteration(iterations, [&] {
+        bench::doNotOptimize(compiled.evaluate(slots.data()));
+    });
+    double jitNs = bench::timePerIteration(iterations, [&] { bench::doNotOptimize(jit.evaluate(slots.data())); });
+
+    std::cout << std::left << std::setw(24) << name
+              << std::right << std::setw(8) << jit.getCodeSize() << " B"
+              << std::fixed << std::setprecision(1)
+              << std::setw(12) << treeNs << " ns"
+              << std::setw(12) << compiledNs << " ns"
+              << std::setw(12) << jitNs << " ns"
+              << std::setprecision(2) << std::setw(9) << compiledNs / jitNs << "x\n";
+}
+
+int main() {
+    std::cout << "native code: " << (JitExpression::isSupported() ? "x86-64" : "unavailable (interpreter)") << "\n";
+    std::cout << std::left << std::setw(24) << "case"
+              << std::right << std::setw(10) << "code"
+              << std::setw(15) << "tree walk"
+              << std::setw(15) << "bytecode"
+              << std::setw(15) << "jit"
+              << std::setw(10) << "vs bc" << "\n";
+
+    runCase("deep chain (100)", bench::makeDeepChain(100, 16), 200000);
+    runCase("deep chain (2000)", bench::makeDeepChain(2000, 16), 10000);
+    runCase("wide tree (depth 6)", bench::makeWideTree(6, 16), 200000);
+    runCase("wide tree (depth 12)", bench::makeWideTree(12, 16), 2000);
+    return 0;
+}
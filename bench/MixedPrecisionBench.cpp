@@ -0,0 +1,85 @@
+// BatchEvaluator (double) versus FloatBatchEvaluator for each SIMD dispatch
+// level, TypedExpression per row in float, double and long double, and the
+// PrecisionReport of float against double for each formula
+#include "BenchCommon.h"
+#include "../BatchEvaluator.h"
+#include "../InfixParser.h"
+#include "../PrecisionReport.h"
+#include "../SimdKernels.h"
+#include "../TypedExpression.h"
+#include <iomanip>
+#include <iostream>
+
+template <typename T>
+static double scalarNs(const ASTNodePtr& ast, const std::vector<std::vector<double>>& data, size_t rows) {
+    TypedExpression<T> typed(ast);
+    std::vector<T> slots(data.size());
+    return bench::timePerIteration(1, [&] {
+        for (size_t r = 0; r < rows; ++r) {
+            for (size_t v = 0; v < data.size(); ++v) slots[v] = static_cast<T>(data[v][r]);
+            bench::doNotOptimize(static_cast<double>(typed.evaluate(slots.data())));
+        }
+    }) / static_cast<double>(rows);
+}
+
+static void runCase(const std::string& name, const std::string& infix, size_t rows) {
+    ASTNodePtr ast = InfixParser::parse(infix);
+    BatchEvaluator batch(ast);
+    FloatBatchEvaluator floatBatch(ast);
+
+    // Scoring-style inputs in [0.5, 2.5]
+    std::vector<std::vector<double>> data(batch.getVariables().size(), std::vector<double>(rows));
+    std::vector<std::vector<float>> floatData(data.size(), std::vector<float>(rows));
+    for (size_t v = 0; v < data.size(); ++v) {
+        for (size_t r = 0; r < rows; ++r) {
+            data[v][r] = 0.5 + static_cast<double>((r * 13 + v * 7) % 1009) / 504.5;
+            floatData[v][r] = static_cast<float>(data[v][r]);
+        }
+    }
+    std::vector<std::span<const double>> columns(data.begin(), data.end());
+    std::vector<std::span<const float>> floatColumns(floatData.begin(), floatData.end());
+    std::vector<double> output(rows);
+    std::vector<float> floatOutput(rows);
+
+    std::cout << name << ": " << infix << "\n";
+    const SimdKernels::Level levels[] = {
+        SimdKernels::Level::SCALAR, SimdKernels::Level::SSE2,
+        SimdKernels::Level::AVX2, SimdKernels::Level::AVX512
+    };
+    for (SimdKernels::Level level : levels) {
+        SimdKernels::setLevel(level);
+        if (SimdKernels::activeLevel() != level) continue;
+        double doubleNs = bench::timePerIteration(10, [&] {
+            batch.evaluate(columns, output);
+            bench::doNotOptimize(output[0]);
+        }) / static_cast<double>(rows);
+        double floatNs = bench::timePerIteration(10, [&] {
+            floatBatch.evaluate(floatColumns, floatOutput);
+            bench::doNotOptimize(floatOutput[0]);
+        }) / static_cast<double>(rows);
+        std::cout << "  batch " << std::left << std::setw(10) << SimdKernels::levelToString(level) << std::right
+                  << std::fixed << std::setprecision(3) << "double " << std::setw(7) << doubleNs
+                  << " ns/row   float " << std::setw(7) << floatNs << " ns/row   "
+                  << std::setprecision(2) << doubleNs / floatNs << "x\n";
+    }
+
+    size_t scalarRows = rows / 16;
+    std::cout << "  per row (TypedExpression)   float " << std::setprecision(1)
+              << scalarNs<float>(ast, data, scalarRows) << " ns   double " << scalarNs<double>(ast, data, scalarRows)
+              << " ns   long double " << scalarNs<long double>(ast, data, scalarRows) << " ns\n";
+
+    PrecisionReport report = PrecisionReport::measure(ast, columns);
+    std::cout << std::defaultfloat;
+    report.print(std::cout);
+    std::cout << "  " << (report.withinTolerance() ? "within" : "NOT within") << " tolerance\n\n";
+}
+
+int main() {
+    const size_t rows = 1 << 20;
+    runCase("linear score", "0.3 * x0 + 0.2 * x1 - 0.15 * x2 + 0.35 * x3 * x4 + 1.5", rows);
+    runCase("ratios", "(x0 + x1) / (x2 + 1) - abs(x3 - x4) / x5", rows);
+    runCase("sqrt / log", "sqrt(x0 * x0 + x1 * x1) + log(x2 * x3) - sqrt(x4)", rows);
+    // Terms near 1e6 cancel down to x1, so float keeps only a digit or two
+    runCase("cancellation", "(x0 + 1000) * (x0 - 1000) - x0 * x0 + 1000000 + x1", rows);
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Hundreds of formulas over the same rows: one BatchEvaluator per formula
+// versus a single MultiExpressionEngine pass
+#include "BenchCommon.h"
+#include "../MultiExpressionEngine.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+// Formulas drawn from a small pool of subterms, as generated feature sets are
+static std::vector<ASTNodePtr> makeFormulas(size_t count, size_t variableCount) {
+    auto var = [&](size_t i) { return ASTNode::createVariable(bench::varName(i % variableCount)); };
+    auto num = [](double value) { return ASTNode::createNumber(value); };
+
+    std::vector<ASTNodePtr> pool;
+    for (size_t i = 0; i < 24; ++i) {
+        ASTNodePtr product = ASTNode::createBinaryOp(OperatorType::MULTIPLY, var(i), var(i + 3));
+        pool.push_back(i % 3 == 0 ? ASTNode::createFunctionCall("sin", {product})
+                                  : ASTNode::createBinaryOp(OperatorType::DIVIDE, product,
+                                        ASTNode::createBinaryOp(OperatorType::ADD, var(i + 1), num(1.0))));
+    }
+
+    std::vector<ASTNodePtr> formulas;
+    for (size_t i = 0; i < count; ++i) {
+        ASTNodePtr left = ASTNode::createBinaryOp(OperatorType::ADD, pool[i % pool.size()],
+                                                  pool[(i * 7 + 5) % pool.size()]);
+        ASTNodePtr scaled = ASTNode::createBinaryOp(OperatorType::MULTIPLY, left,
+                                                    num(0.5 + static_cast<double>(i % 11)));
+        formulas.push_back(ASTNode::createBinaryOp(OperatorType::SUBTRACT, scaled, var(i * 5)));
+    }
+    return formulas;
+}
+
+static void runCase(size_t formulaCount, size_t variableCount, size_t rows) {
+    std::vector<ASTNodePtr> formulas = makeFormulas(formulaCount, variableCount);
+    MultiExpressionEngine engine(formulas);
+
+    std::vector<std::vector<double>> data(engine.getVariables().size(), std::vector<double>(rows));
+    for (size_t v = 0; v < data.size(); ++v) {
+        for (size_t r = 0; r < rows; ++r) data[v][r] = 1.0 + static_cast<double>((r * 31 + v * 17) % 97) / 97.0;
+    }
+
+    // Independent evaluators each take their own subset of the columns
+    std::vector<BatchEvaluator> separate;
+    std::vector<std::vector<std::span<const double>>> separateColumns;
+    for (const auto& formula : formulas) {
+        separate.emplace_back(formula);
+        std::vector<std::span<const double>> columns;
+        for (const auto& name : separate.back().getVariables()) {
+            auto it = std::lower_bound(engine.getVariables().begin(), engine.getVariables().end(), name);
+            columns.push_back(data[it - engine.getVariables().begin()]);
+        }
+        separateColumns.push_back(std::move(columns));
+    }
+
+    std::vector<std::vector<double>> expected(formulaCount, std::vector<double>(rows));
+    std::vector<std::vector<double>> results(formulaCount, std::vector<double>(rows));
+    std::vector<std::span<const double>> columns(data.begin(), data.end());
+    std::vector<std::span<double>> outputs(results.begin(), results.end());
+
+    double separateNs = bench::timePerIteration(3, [&] {
+        for (size_t i = 0; i < formulaCount; ++i) separate[i].evaluate(separateColumns[i], expected[i]);
+        bench::doNotOptimize(expected[0][rows - 1]);
+    }) / static_cast<double>(rows);
+    double engineNs = bench::timePerIteration(3, [&] {
+        engine.evaluate(columns, outputs);
+        bench::doNotOptimize(results[0][rows - 1]);
+    }) / static_cast<double>(rows);
+
+    if (results != expected) {
+        std::cout << formulaCount << " formulas: MISMATCH\n";
+        return;
+    }
+    std::cout << std::setw(9) << formulaCount << std::setw(8) << variableCount
+              << std::setw(16) << (std::to_string(engine.getTotalNodes()) + " -> " +
+                                   std::to_string(engine.getUniqueNodes()))
+              << std::fixed << std::setprecision(1)
+              << std::setw(14) << separateNs << " ns" << std::setw(14) << engineNs << " ns"
+              << std::setprecision(2) << std::setw(9) << separateNs / engineNs << "x\n";
+}
+
+int main() {
+    std::cout << std::setw(9) << "formulas" << std::setw(8) << "vars" << std::setw(16) << "nodes"
+              << std::setw(17) << "separate/row" << std::setw(17) << "engine/row" << std::setw(10) << "speedup\n";
+    runCase(50, 16, 1 << 16);
+    runCase(500, 32, 1 << 15);
+    return 0;
+}
@@ -0,0 +1,90 @@
+// ParallelEvaluator throughput from one worker up to every hardware thread,
+// against the single-threaded BatchEvaluator, plus a check that the reported
+// failing row does not depend on the worker count
+#include "BenchCommon.h"
+#include "../ParallelEvaluator.h"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+
+static std::vector<std::vector<double>> makeColumns(size_t columns, size_t rows) {
+    std::vector<std::vector<double>> data(columns, std::vector<double>(rows));
+    for (size_t v = 0; v < columns; ++v) {
+        for (size_t r = 0; r < rows; ++r) {
+            data[v][r] = 1.0 + static_cast<double>((r * 31 + v * 17) % 97) / 97.0;
+        }
+    }
+    return data;
+}
+
+static void runCase(const std::string& name, const ASTNodePtr& ast, size_t rows,
+                    const std::vector<size_t>& workerCounts) {
+    BatchEvaluator batch(ast);
+    auto data = makeColumns(batch.getVariables().size(), rows);
+    std::vector<std::span<const double>> columns(data.begin(), data.end());
+    std::vector<double> expected(rows), output(rows);
+
+    double batchNs = bench::timePerIteration(3, [&] {
+        batch.evaluate(columns, expected);
+        bench::doNotOptimize(expected[rows - 1]);
+    }) / static_cast<double>(rows);
+    std::cout << std::left << std::setw(24) << name << std::right << std::setw(8) << "batch"
+              << std::fixed << std::setprecision(2) << std::setw(12) << batchNs << " ns/row\n";
+
+    for (size_t workers : workerCounts) {
+        ParallelEvaluator parallel(ast, workers);
+        double parallelNs = bench::timePerIteration(3, [&] {
+            parallel.evaluate(columns, output);
+            bench::doNotOptimize(output[rows - 1]);
+        }) / static_cast<double>(rows);
+
+        if (output != expected) {
+            std::cout << name << ": MISMATCH with " << workers << " workers\n";
+            continue;
+        }
+        std::cout << std::left << std::setw(24) << "" << std::right << std::setw(8) << workers
+                  << std::setw(12) << parallelNs << " ns/row" << std::setprecision(2)
+                  << std::setw(9) << batchNs / parallelNs << "x"
+                  << std::setw(8) << parallel.getPool().getSteals() << " steals\n";
+    }
+}
+
+// Divisor column with zeros at a few rows: every worker count must report the lowest
+static void checkErrorRow(size_t rows, const std::vector<size_t>& workerCounts) {
+    ASTNodePtr ast = ASTNode::createBinaryOp(OperatorType::DIVIDE, ASTNode::createVariable("x0"),
+                                             ASTNode::createVariable("x1"));
+    auto data = makeColumns(2, rows);
+    for (size_t row : {rows - 5, rows / 2 + 3, rows / 3 + 1}) data[1][row] = 0.0;
+    std::vector<std::span<const double>> columns(data.begin(), data.end());
+
+    for (size_t workers : workerCounts) {
+        ParallelEvaluator parallel(ast, workers, 1024);
+        try {
+            parallel.evaluate(columns);
+            std::cout << "error row: no error with " << workers << " workers\n";
+        } catch (const BatchEvaluationError& e) {
+            if (e.getRow() != rows / 3 + 1 || std::string(e.what()) != "Division by zero") {
+                std::cout << "error row: got " << e.getRow() << " with " << workers << " workers\n";
+                return;
+            }
+        }
+    }
+    std::cout << "error row: lowest failing row reported for every worker count\n";
+}
+
+int main() {
+    size_t hardware = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<size_t> workerCounts;
+    for (size_t workers = 1; workers < hardware; workers *= 2) workerCounts.push_back(workers);
+    workerCounts.push_back(hardware);
+
+    std::cout << std::left << std::setw(24) << "case" << std::right << std::setw(8) << "workers"
+              << std::setw(19) << "time" << std::setw(10) << "speedup" << "\n";
+    runCase("deep chain (100)", bench::makeDeepChain(100, 8), 1 << 20, workerCounts);
+    runCase("wide tree (depth 6)", bench::makeWideTree(6, 8), 1 << 20, workerCounts);
+
+    std::vector<size_t> errorCounts = workerCounts;
+    errorCounts.push_back(hardware * 2);
+    checkErrorRow(1 << 18, errorCounts);
+    return 0;
+}
@@ -0,0 +1,81 @@
+// BatchEvaluator throughput for each SIMD dispatch level
+#include "BenchCommon.h"
+#include "../BatchEvaluator.h"
+#include "../SimdKernels.h"
+#include <iostream>
+#include <iomanip>
+
+static void runCase(const std::string& name, const ASTNodePtr& ast, size_t rows) {
+    BatchEvaluator batch(ast);
+
+    std::vector<std::vector<double>> data(batch.getVariables().size(), std::vector<double>(rows));
+    for (size_t v = 0; v < data.size(); ++v) {
+        for (size_t r = 0; r < rows; ++r) {
+            data[v][r] = 0.5 + static_cast<double>((r * 13 + v * 7) % 101) / 50.0;
+        }
+    }
+    std::vector<std::span<const double>> columns(data.begin(), data.end());
+    std::vector<double> output(rows);
+    std::vector<double> reference;
+
+    std::cout << std::left << std::setw(30) << name;
+    const SimdKernels::Level levels[] = {
+        SimdKernels::Level::SCALAR, SimdKernels::Level::SSE2,
+        SimdKernels::Level::AVX2, SimdKernels::Level::AVX512
+    };
+    for (SimdKernels::Level level : levels) {
+        SimdKernels::setLevel(level);
+        if (SimdKernels::activeLevel() != level) {
+            std::cout << std::right << std::setw(12) << "n/a";
+            continue;
+        }
+        double ns = bench::timePerIteration(20, [&] {
+            batch.evaluate(columns, output);
+            bench::doNotOptimize(output[0]);
+        }) / static_cast<double>(rows);
+
+        if (reference.empty()) {
+            reference = output;
+        } else if (reference != output) {
+            std::cout << std::right << std::setw(12) << "MISMATCH";
+            continue;
+        }
+        std::cout << std::right << std::fixed << std::setprecision(3) << std::setw(12) << ns;
+    }
+    std::cout << "  ns/row\n";
+}
+
+int main() {
+    std::cout << std::left << std::setw(30) << "case"
+              << std::right << std::setw(12) << "scalar" << std::setw(12) << "SSE2"
+              << std::setw(12) << "AVX2" << std::setw(12) << "AVX-512" << "\n";
+
+    ASTNodePtr a = ASTNode::createVariable("a");
+    ASTNodePtr b = ASTNode::createVariable("b");
+    ASTNodePtr c = ASTNode::createVariable("c");
+    ASTNodePtr d = ASTNode::createVariable("d");
+    auto bin = ASTNode::createBinaryOp;
+    auto call = [](const std::string& name, ASTNodePtr arg) {
+        return ASTNode::createFunctionCall(name, {arg});
+    };
+
+    // (a + b) * c / d + -(a - b)
+    runCase("arithmetic",
+            bin(OperatorType::ADD,
+                bin(OperatorType::DIVIDE, bin(OperatorType::MULTIPLY, bin(OperatorType::ADD, a, b), c), d),
+                ASTNode::createUnaryOp(OperatorType::NEGATIVE, bin(OperatorType::SUBTRACT, a, b))),
+            1 << 20);
+    // sqrt((sqrt(a * b) + abs(-c)) / d)
+    runCase("sqrt / abs",
+            call("sqrt", bin(OperatorType::DIVIDE,
+                             bin(OperatorType::ADD, call("sqrt", bin(OperatorType::MULTIPLY, a, b)),
+                                 call("abs", ASTNode::createUnaryOp(OperatorType::NEGATIVE, c))),
+                             d)),
+            1 << 20);
+    // (log(a) + log(b)) * log(c * d)
+    runCase("log (checked)",
+            bin(OperatorType::MULTIPLY, bin(OperatorType::ADD, call("log", a), call("log", b)),
+                call("log", bin(OperatorType::MULTIPLY, c, d))),
+            1 << 20);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,134 @@
+// Evaluating a data file: the hand-written loop (getline, VariableMap per row,
+// ASTNode::evaluate), the same blocks read/evaluated/written one after the
+// other, and the overlapped StreamEvaluator pipeline, for CSV and binary files
+#include "BenchCommon.h"
+#include "../StreamEvaluator.h"
+#include "../InfixParser.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <tuple>
+#include <algorithm>
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void writeInput(const std::string& path, StreamFormat format, const std::vector<std::string>& names,
+                       size_t rows) {
+    std::ofstream out(path, std::ios::binary);
+    ColumnWriter writer(out, format, names);
+    std::vector<std::vector<double>> data(names.size(), std::vector<double>(StreamEvaluator::DEFAULT_BLOCK_ROWS));
+    for (size_t start = 0; start < rows; start += StreamEvaluator::DEFAULT_BLOCK_ROWS) {
+        size_t count = std::min(StreamEvaluator::DEFAULT_BLOCK_ROWS, rows - start);
+        for (size_t c = 0; c < names.size(); ++c) {
+            for (size_t r = 0; r < count; ++r) {
+                data[c][r] = 1.0 + static_cast<double>(((start + r) * 31 + c * 17) % 997) / 97.0;
+            }
+        }
+        writer.writeBlock(std::vector<std::span<const double>>(data.begin(), data.end()), count);
+    }
+}
+
+// What callers wrote before: one VariableMap and one tree walk per row
+static size_t naiveCsv(const ASTNodePtr& ast, const std::string& inPath, const std::string& outPath) {
+    std::ifstream in(inPath);
+    std::ofstream out(outPath);
+    std::string line, field;
+    std::getline(in, line);
+    std::vector<std::string> names;
+    std::stringstream header(line);
+    while (std::getline(header, field, ',')) names.push_back(field);
+
+    out << "result\n" << std::setprecision(17);
+    size_t rows = 0;
+    VariableMap variables;
+    while (std::getline(in, line)) {
+        std::stringstream row(line);
+        for (size_t c = 0; std::getline(row, field, ','); ++c) variables[names[c]] = std::stod(field);
+        out << ast->evaluate(variables) << "\n";
+        ++rows;
+    }
+    return rows;
+}
+
+// Same blocks as the pipeline, but read, evaluate and write take turns
+static size_t sequential(const ASTNodePtr& ast, const std::string& inPath, const std::string& outPath) {
+    StreamFormat inFormat = StreamEvaluator::formatFor(inPath);
+    StreamFormat outFormat = StreamEvaluator::formatFor(outPath);
+    std::ifstream in(inPath, std::ios::binary);
+    std::ofstream out(outPath, std::ios::binary);
+    ColumnReader reader(in, inFormat);
+    ColumnWriter writer(out, outFormat, {"result"});
+    BatchEvaluator batch(ast);
+
+    std::vector<size_t> wanted;
+    for (const auto& variable : batch.getVariables()) {
+        wanted.push_back(std::find(reader.getNames().begin(), reader.getNames().end(), variable) -
+                         reader.getNames().begin());
+    }
+    std::vector<std::vector<double>> inputs(wanted.size());
+    std::vector<double> output(StreamEvaluator::DEFAULT_BLOCK_ROWS);
+    size_t total = 0;
+    while (size_t rows = reader.readBlock(wanted, inputs, StreamEvaluator::DEFAULT_BLOCK_ROWS)) {
+        std::vector<std::span<const double>> columns;
+        for (const auto& input : inputs) columns.emplace_back(input.data(), rows);
+        batch.evaluate(columns, std::span<double>(output.data(), rows));
+        writer.writeBlock({std::span<const double>(output.data(), rows)}, rows);
+        total += rows;
+    }
+    return total;
+}
+
+static bool sameFile(const std::string& a, const std::string& b) {
+    std::ifstream x(a, std::ios::binary), y(b, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(x), {}) == std::string(std::istreambuf_iterator<char>(y), {});
+}
+
+int main() {
+    const size_t rows = 1000000;
+    std::vector<std::string> names = {"a", "b", "c", "d", "unused"};
+    ASTNodePtr ast = InfixParser::parse("sqrt(a * a + b * b) / (c + 1) - log(d) * 0.5 + sin(a - c)");
+
+    auto directory = std::filesystem::temp_directory_path();
+    std::string csvIn = (directory / "stream_bench_in.csv").string();
+    std::string binIn = (directory / "stream_bench_in.bin").string();
+    std::string outA = (directory / "stream_bench_a").string();
+    std::string outB = (directory / "stream_bench_b").string();
+    writeInput(csvIn, StreamFormat::CSV, names, rows);
+    writeInput(binIn, StreamFormat::BINARY, names, rows);
+
+    std::cout << std::left << std::setw(28) << "case" << std::right << std::setw(12) << "ms"
+              << std::setw(14) << "ns/row" << "\n";
+    auto report = [&](const std::string& name, double ms) {
+        std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << ms << std::setw(14) << ms * 1e6 / static_cast<double>(rows) << "\n";
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    naiveCsv(ast, csvIn, outA + ".csv");
+    report("csv: per-row loop", elapsedMs(start));
+
+    StreamEvaluator stream(ast);
+    for (const auto& [name, inPath, extension] :
+         {std::tuple{"csv", csvIn, ".csv"}, std::tuple{"binary", binIn, ".bin"}}) {
+        start = std::chrono::steady_clock::now();
+        sequential(ast, inPath, outA + extension);
+        report(std::string(name) + ": blocks, sequential", elapsedMs(start));
+
+        start = std::chrono::steady_clock::now();
+        stream.run(inPath, outB + extension);
+        report(std::string(name) + ": StreamEvaluator", elapsedMs(start));
+
+        if (!sameFile(outA + extension, outB + extension)) std::cout << name << ": MISMATCH\n";
+    }
+
+    for (const auto& path : {csvIn, binIn, outA + ".csv", outA + ".bin", outB + ".csv", outB + ".bin"}) {
+        std::remove(path.c_str());
+    }
+    return 0;
+}
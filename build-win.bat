@@ -2,7 +2,7 @@
 echo Compiling C++ project...
 echo.
 
-g++ -g main.cpp InfixToPostfix.cpp PostfixToAST.cpp AST_NODE.cpp -o project.exe
+g++ -g -std=c++20 -pthread *.cpp -o project.exe
 
 if %errorlevel% equ 0 (
     echo.
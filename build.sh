@@ -2,7 +2,7 @@ echo "Compiling C++ project..."
 echo
 
 # Compile the project
-g++ -g main.cpp InfixToPostfix.cpp PostfixToAST.cpp AST_NODE.cpp -o project
+g++ -g -std=c++20 -pthread *.cpp -o project
 
 # Check if compilation was successful
 if [ $? -eq 0 ]; then
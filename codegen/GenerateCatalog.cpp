@@ -0,0 +1,120 @@
+// Reads `name: expression` lines and writes <output>.h / <output>.cpp with a
+// scalar and a batch function per expression plus a table describing them.
+// Usage: GenerateCatalog catalog.txt build/Catalog
+#include "../CodeGenerator.h"
+#include "../ExpressionSimplifier.h"
+#include "../HashConsBuilder.h"
+#include "../InfixParser.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+struct CatalogLine {
+    std::string name;
+    std::string expression;
+};
+
+static std::string trim(const std::string& text) {
+    size_t start = text.find_first_not_of(" \t\r");
+    size_t end = text.find_last_not_of(" \t\r");
+    return start == std::string::npos ? std::string() : text.substr(start, end - start + 1);
+}
+
+static std::vector<CatalogLine> readCatalog(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("Cannot open " + path);
+
+    std::vector<CatalogLine> lines;
+    std::string line;
+    for (size_t number = 1; std::getline(in, line); ++number) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            throw std::runtime_error(path + ":" + std::to_string(number) + ": expected `name: expression`");
+        }
+        lines.push_back({trim(line.substr(0, colon)), trim(line.substr(colon + 1))});
+    }
+    return lines;
+}
+
+static std::string quote(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "usage: " << argv[0] << " <catalog.txt> <output path without extension>\n";
+        return 2;
+    }
+
+    try {
+        std::vector<CatalogLine> catalog = readCatalog(argv[1]);
+        std::string output = argv[2];
+        std::string headerName = output.substr(output.find_last_of('/') + 1) + ".h";
+
+        std::ofstream header(output + ".h");
+        header << "// Generated by GenerateCatalog from " << argv[1] << "; do not edit\n"
+               << "#ifndef GENERATED_CATALOG_H\n#define GENERATED_CATALOG_H\n\n#include <cstddef>\n\n"
+               << "struct CatalogEntry {\n"
+               << "    const char* name;\n"
+               << "    const char* expression;\n"
+               << "    size_t variableCount;\n"
+               << "    const char* const* variables;   // slot order\n"
+               << "    double (*scalar)(const double* slots);\n"
+               << "    size_t (*batch)(const double* const* columns, double* out, size_t rows);\n"
+               << "};\n\n"
+               << "extern const CatalogEntry catalogEntries[];\n"
+               << "extern const size_t catalogSize;\n\n";
+
+        std::ofstream source(output + ".cpp");
+        source << "// Generated by GenerateCatalog from " << argv[1] << "; do not edit\n"
+               << "#include \"" << headerName << "\"\n" << CodeGenerator::generatePrelude() << "\n";
+
+        std::stringstream table;
+        table << "const CatalogEntry catalogEntries[] = {\n";
+
+        ExpressionSimplifier simplifier(true);   // keep results bit-identical
+        for (const auto& entry : catalog) {
+            if (!CodeGenerator::isValidIdentifier(entry.name)) {
+                throw std::runtime_error("Invalid catalog name: " + entry.name);
+            }
+
+            // Fold constants and share repeated subterms before generating
+            HashConsBuilder builder;
+            ASTNodePtr ast = builder.build(simplifier.simplify(InfixParser::parse(entry.expression)));
+            std::vector<std::string> variables = CodeGenerator::slotOrder(ast);
+
+            header << "double " << entry.name << "(const double* slots);\n"
+                   << "size_t " << entry.name << "_batch(const double* const* columns, double* out, size_t rows);\n";
+
+            source << CodeGenerator::generateScalar(ast, entry.name) << "\n"
+                   << CodeGenerator::generateBatch(ast, entry.name + "_batch") << "\n";
+
+            source << "static const char* const " << entry.name << "_variables[] = {";
+            for (const auto& variable : variables) source << quote(variable) << ", ";
+            source << "nullptr};\n\n";
+
+            table << "    {" << quote(entry.name) << ", " << quote(entry.expression) << ", "
+                  << variables.size() << ", " << entry.name << "_variables, "
+                  << entry.name << ", " << entry.name << "_batch},\n";
+
+            std::cout << entry.name << ": " << builder.getTotalNodes() << " nodes -> "
+                      << builder.getUniqueNodes() << " unique after simplification ("
+                      << simplifier.getRemovedNodes() << " folded)\n";
+        }
+
+        table << "};\n\nconst size_t catalogSize = " << catalog.size() << ";\n";
+        source << table.str();
+        header << "\n#endif // GENERATED_CATALOG_H\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -4,8 +4,16 @@
 #include <string>
 #include <unordered_map>
 #include <cctype>
+#include <charconv>
 #include "InfixToPostfix.h"
 #include "PostfixToAST.h"
+#include "CompiledExpression.h"
+#include "InfixParser.h"
+#include "ExpressionSimplifier.h"
+#include "IncrementalEvaluator.h"
+#include "GradientEvaluator.h"
+#include "StreamEvaluator.h"
+#include "ExpressionProfiler.h"
 #include <iomanip>
 
 using namespace std;
@@ -63,8 +71,59 @@ void evaluateWithVariables(const ASTNodePtr& ast,
 }
 
 
+// project --expr "a+b*c" --in data.csv --out result.bin [--block-rows N]
+// Streams a CSV or binary column file through one expression
+int runStreamCommand(int argc, char* argv[]) {
+    std::string expression, inPath, outPath;
+    size_t blockRows = StreamEvaluator::DEFAULT_BLOCK_ROWS;
+    auto usage = [&] {
+        std::cerr << "usage: " << argv[0] << " --expr <infix> --in <file.csv|file.bin> --out <file.csv|file.bin>"
+                  << " [--block-rows N]\n";
+        return 2;
+    };
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << option << "\n";
+            return 2;
+        }
+        std::string value = argv[++i];
+        if (option == "--expr") expression = value;
+        else if (option == "--in") inPath = value;
+        else if (option == "--out") outPath = value;
+        else if (option == "--block-rows") {
+            auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), blockRows);
+            if (error != std::errc() || end != value.data() + value.size()) {
+                std::cerr << "Invalid value for --block-rows: " << value << "\n";
+                return usage();
+            }
+        } else {
+            std::cerr << "Unknown option " << option << "\n";
+            return 2;
+        }
+    }
+    if (expression.empty() || inPath.empty() || outPath.empty()) return usage();
+
+    try {
+        StreamEvaluator stream(InfixParser::parse(expression), blockRows);
+        size_t rows = stream.run(inPath, outPath);
+        std::cerr << rows << " rows written to " << outPath << "\n";
+    } catch (const BatchEvaluationError& e) {
+        std::cerr << "Error at row " << e.getRow() << ": " << e.what() << "\n";
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
 // Main function - usage example
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        return runStreamCommand(argc, argv);
+    }
+
     // Simple usage
     InfixToPostfix converter;
     
@@ -91,6 +150,74 @@ int main() {
             {"a", 2}, {"b", 3}, {"c", 1}, {"d", 4}, {"e", 5}
         };
         evaluateWithVariables(astPost, postVars);
+
+        // Bytecode
+        printHeader("BYTECODE");
+        CompiledExpression compiled(astPost);
+        std::cout << compiled.disassemble();
+        std::cout << "Compiled result: " << compiled.evaluate(postVars) << "\n";
+
+        // Infix straight to AST
+        printHeader("DIRECT INFIX TO AST");
+        ASTNodePtr astDirect = InfixParser::parse("-a + sqrt(b * b + 16) / (c - d) ^ 2");
+        std::cout << "Infix expression: " << astDirect->toString() << "\n";
+        astDirect->print(0, true);
+        evaluateWithVariables(astDirect, postVars);
+
+        // Constant folding and identities
+        printHeader("SIMPLIFICATION");
+        ASTNodePtr astVerbose = InfixParser::parse("a * 1 + 2 * 3.5 - (0 + b) ^ 1 + sqrt(16) / c");
+        ExpressionSimplifier simplifier;
+        ASTNodePtr astSimple = simplifier.simplify(astVerbose);
+        std::cout << "Original:   " << astVerbose->toString() << "\n";
+        std::cout << "Simplified: " << astSimple->toString() << "\n";
+        std::cout << "Removed nodes: " << simplifier.getRemovedNodes() << "\n";
+        evaluateWithVariables(astSimple, postVars);
+
+        // Only the path from a changed variable to the root is recomputed
+        printHeader("INCREMENTAL EVALUATION");
+        IncrementalEvaluator incremental(astDirect, {{"a", 2}, {"b", 3}, {"c", 1}, {"d", 4}});
+        std::cout << "Result: " << incremental.result() << " (" << incremental.getLastRecomputed()
+                  << " of " << incremental.getNodeCount() << " nodes computed)\n";
+        incremental.set("a", 5);
+        std::cout << "After a=5: " << incremental.result() << " (" << incremental.getLastRecomputed()
+                  << " nodes recomputed)\n";
+        incremental.set("c", 2);
+        std::cout << "After c=2: " << incremental.result() << " (" << incremental.getLastRecomputed()
+                  << " nodes recomputed)\n";
+
+        // Value and every partial derivative in one forward and reverse sweep
+        printHeader("GRADIENT");
+        GradientEvaluator gradient(astDirect);
+        std::vector<double> partials;
+        double value = gradient.evaluate({{"a", 2}, {"b", 3}, {"c", 1}, {"d", 4}}, partials);
+        std::cout << "Value: " << value << "\n";
+        for (size_t i = 0; i < partials.size(); ++i) {
+            std::cout << "d/d" << gradient.getVariables()[i] << " = " << partials[i] << "\n";
+        }
+        ASTNodePtr derivative = simplifier.simplify(GradientEvaluator::derivative(astDirect, "b"));
+        std::cout << "Symbolic d/db: " << derivative->toString() << "\n";
+
+        // Per-node counts and times (only with make PROFILE=1)
+        printHeader("PROFILE");
+        if (ExpressionProfiler::COMPILED_IN) {
+            ExpressionProfiler profiler;
+            {
+                ExpressionProfiler::Scope scope(profiler);
+                PostfixToAST::convert(postfixExpression);
+                for (int i = 0; i < 1000; ++i) astDirect->evaluate(VariableMap{{"a", 2}, {"b", 3}, {"c", 1}, {"d", 4}});
+                try {
+                    astDirect->evaluate(VariableMap{{"a", 2}, {"b", 3}, {"c", 4}, {"d", 4}});
+                } catch (const std::exception&) {}
+            }
+            profiler.printTree(*astDirect, std::cout);
+            std::cout << "Folded stacks (self ns):\n";
+            profiler.writeFoldedStacks(*astDirect, std::cout);
+            std::cout << "PostfixToAST tokens:\n";
+            profiler.printParseStats(std::cout);
+        } else {
+            std::cout << "Profiling hooks are compiled out; build with make PROFILE=1\n";
+        }
         
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
@@ -0,0 +1,124 @@
+// Million-deep trees built, evaluated, printed and destroyed. Any recursion
+// per level would overflow the thread's stack long before this depth.
+#include "TestCommon.h"
+#include "../ASTTraversal.h"
+#include "../PostfixToAST.h"
+#include <streambuf>
+
+constexpr size_t DEPTH = 1000000;
+
+static std::string varName(size_t i) {
+    return "x" + std::to_string(i % 8);
+}
+
+// Stream buffer that only counts lines, for print()
+struct LineCounter : std::streambuf {
+    size_t lines = 0;
+    int_type overflow(int_type c) override {
+        if (c == '\n') ++lines;
+        return c;
+    }
+};
+
+// Lines written by print(0, tree)
+static size_t printedLines(const ASTNode& ast, bool tree) {
+    LineCounter counter;
+    std::streambuf* original = std::cout.rdbuf(&counter);
+    ast.print(0, tree);
+    std::cout.rdbuf(original);
+    return counter.lines;
+}
+
+// Every whole-tree operation on one tree, then its teardown
+static void checkTree(ASTNodePtr ast, const VariableMap& variables, double expected, const std::string& text,
+                      size_t variableCount) {
+    CHECK(ast->evaluate(variables) == expected);
+    std::vector<std::pair<std::string, double>> pairs(variables.begin(), variables.end());
+    CHECK(ast->evaluate(pairs) == expected);
+    auto result = ast->tryEvaluate(variables);
+    CHECK(result && *result == expected);
+
+    CHECK(ast->toString() == text);
+    CHECK(ast->collectVariables().size() == variableCount);
+    CHECK(ast->hasVariables() == (variableCount > 0));
+
+    // Unbind the leftmost leaf, the first one evaluated: the error names it
+    // and points at it
+    const ASTNode* leaf = ast.get();
+    while (ASTTraversal::childCount(*leaf) > 0) leaf = ASTTraversal::child(*leaf, 0);
+    if (leaf->type == NodeType::VARIABLE) {
+        VariableMap unbound = variables;
+        unbound.erase(leaf->variable.name);
+        auto error = ast->tryEvaluate(unbound);
+        CHECK(!error && error.error().node == leaf);
+        CHECK(test::errorMessage([&] { ast->evaluate(unbound); }) == "Undefined variable: " + leaf->variable.name);
+    }
+
+    ast.reset();
+}
+
+int main() {
+    VariableMap variables;
+    for (size_t i = 0; i < 8; ++i) variables[varName(i)] = 0.25 * static_cast<double>(i + 1);
+
+    // x0 + x1 + ... , left-deep, summed left to right like evaluate()
+    double leftSum = 0;
+    std::string leftText;
+    std::string postfix;
+    for (size_t i = 0; i < DEPTH; ++i) {
+        leftSum += variables[varName(i)];
+        leftText += (i ? " + " : "") + varName(i);
+        postfix += i ? " " + varName(i) + " +" : varName(i);
+    }
+    ASTNodePtr left = ASTNode::createVariable(varName(0));
+    for (size_t i = 1; i < DEPTH; ++i) {
+        left = ASTNode::createBinaryOp(OperatorType::ADD, left, ASTNode::createVariable(varName(i)));
+    }
+    checkTree(std::move(left), variables, leftSum, leftText, 8);
+    checkTree(PostfixToAST::convert(postfix), variables, leftSum, leftText, 8);
+
+    // x0 + (x1 + (... + x7)), right-deep, summed from the innermost term out
+    ASTNodePtr right = ASTNode::createVariable(varName(DEPTH - 1));
+    double rightSum = variables[varName(DEPTH - 1)];
+    for (size_t i = DEPTH - 1; i-- > 0;) {
+        right = ASTNode::createBinaryOp(OperatorType::ADD, ASTNode::createVariable(varName(i)), right);
+        rightSum = variables[varName(i)] + rightSum;
+    }
+    std::string rightText;
+    for (size_t i = 0; i < DEPTH; ++i) rightText += (i == 0 ? "" : i + 1 < DEPTH ? " + (" : " + ") + varName(i);
+    rightText += std::string(DEPTH - 2, ')');
+    checkTree(std::move(right), variables, rightSum, rightText, 8);
+
+    // -(-(...-(x0))) and abs(abs(...abs(-x1)))
+    ASTNodePtr negation = ASTNode::createVariable("x0");
+    for (size_t i = 0; i < DEPTH; ++i) negation = ASTNode::createUnaryOp(OperatorType::NEGATIVE, negation);
+    checkTree(std::move(negation), variables, DEPTH % 2 ? -variables["x0"] : variables["x0"],
+              std::string(DEPTH, '-') + "x0", 1);
+
+    ASTNodePtr calls = ASTNode::createUnaryOp(OperatorType::NEGATIVE, ASTNode::createVariable("x1"));
+    for (size_t i = 0; i < DEPTH; ++i) calls = ASTNode::createFunctionCall("abs", {calls});
+    std::string callText;
+    for (size_t i = 0; i < DEPTH; ++i) callText += "abs(";
+    callText += "-x1" + std::string(DEPTH, ')');
+    checkTree(std::move(calls), variables, variables["x1"], callText, 1);
+
+    // A subtree still owned elsewhere survives the teardown of its parent
+    ASTNodePtr shared = ASTNode::createVariable("x0");
+    for (size_t i = 0; i < DEPTH / 2; ++i) shared = ASTNode::createUnaryOp(OperatorType::NEGATIVE, shared);
+    ASTNodePtr outer = shared;
+    for (size_t i = 0; i < DEPTH / 2; ++i) outer = ASTNode::createUnaryOp(OperatorType::NEGATIVE, outer);
+    outer.reset();
+    CHECK(shared->evaluate(variables) == variables["x0"]);
+    shared.reset();
+
+    // print() writes a line per node in both layouts; its indentation grows
+    // with depth, so it runs on a shallower chain
+    ASTNodePtr chain = ASTNode::createVariable("x0");
+    for (size_t i = 0; i < 2000; ++i) {
+        chain = ASTNode::createBinaryOp(OperatorType::MULTIPLY, chain, ASTNode::createNumber(2));
+    }
+    CHECK(printedLines(*chain, false) == 4001);
+    CHECK(printedLines(*chain, true) == 4001);
+
+    return test::finish("DeepExpressionTest");
+}
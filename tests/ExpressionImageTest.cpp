@@ -0,0 +1,200 @@
+// ExpressionImage round trip against the trees it was written from, and
+// verify() on truncated and corrupted images
+#include "TestCommon.h"
+#include "../ExpressionImage.h"
+#include "../InfixParser.h"
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+// Result bits, or the error message, of one evaluation
+template <typename Fn>
+static std::string outcome(Fn&& fn) {
+    double value = 0;
+    std::string message = test::errorMessage([&] { value = fn(); });
+    return message.empty() ? "bits " + std::to_string(std::bit_cast<std::uint64_t>(value)) : message;
+}
+
+// 8-byte aligned copy of a serialized image that a test can corrupt
+struct ImageBytes {
+    std::vector<std::uint64_t> words;
+    size_t size;
+
+    explicit ImageBytes(const std::vector<std::byte>& bytes) : words((bytes.size() + 7) / 8), size(bytes.size()) {
+        std::memcpy(words.data(), bytes.data(), bytes.size());
+    }
+
+    ImageHeader& header() { return *reinterpret_cast<ImageHeader*>(words.data()); }
+
+    template <typename T>
+    T* section(std::uint64_t offset) {
+        return reinterpret_cast<T*>(reinterpret_cast<std::byte*>(words.data()) + offset);
+    }
+
+    ImageExpression& expression(size_t index) { return section<ImageExpression>(header().expressions)[index]; }
+
+    ImageNode& node(size_t expressionIndex, size_t index) {
+        return section<ImageNode>(header().nodes)[expression(expressionIndex).firstNode + index];
+    }
+
+    // First node of an expression with the given kind and op
+    size_t find(size_t expressionIndex, NodeType kind, std::uint8_t op) {
+        for (size_t i = 0;; ++i) {
+            const ImageNode& packed = node(expressionIndex, i);
+            if (packed.kind == static_cast<std::uint8_t>(kind) && packed.op == op) return i;
+        }
+    }
+
+    // Message from view() and verify(), or "" if both accept the bytes
+    std::string verifyMessage(size_t length) const {
+        std::span<const std::byte> bytes(reinterpret_cast<const std::byte*>(words.data()), length);
+        return test::errorMessage([&] { ExpressionImage::view(bytes).verify(); });
+    }
+    std::string verifyMessage() const { return verifyMessage(size); }
+};
+
+int main() {
+    const std::pair<const char*, ASTNodePtr> formulas[] = {
+        {"poly", InfixParser::parse("x * x - 3 * y + 0.1")},
+        {"trig", InfixParser::parse("sin(x) + cos(y) * sqrt(abs(x))")},
+        {"logs", InfixParser::parse("log(x) - exp(-y)")},
+        {"div", InfixParser::parse("x / (y - 2)")},
+        {"pow", InfixParser::parse("(x - 1) ^ y")},
+        {"call", ASTNode::createFunctionCall("min", {ASTNode::createVariable("x"), ASTNode::createVariable("y")})},
+        {"", InfixParser::parse("2 ^ 0.5")},
+        {"neg", InfixParser::parse("-(-x) * sqrt(y)")},
+    };
+    const VariableMap inputs[] = {
+        {{"x", 2.5}, {"y", 2}},
+        {{"x", -1}, {"y", 0.5}},
+        {{"x", 0}, {"y", -3}},
+        {{"x", 1e300}, {"y", 1e-300}},
+        {{"x", 1.5}},
+        {},
+    };
+
+    ExpressionImageWriter writer;
+    for (const auto& [name, ast] : formulas) writer.add(ast, name);
+    std::vector<std::byte> serialized = writer.serialize();
+    ImageBytes bytes(serialized);
+    ExpressionImage image = ExpressionImage::view(std::span<const std::byte>(
+        reinterpret_cast<const std::byte*>(bytes.words.data()), bytes.size));
+    image.verify();
+
+    // Same text, bits and error messages as the tree, by name and by slot
+    CHECK(image.size() == std::size(formulas));
+    for (size_t e = 0; e < image.size(); ++e) {
+        const ASTNodePtr& ast = formulas[e].second;
+        MappedExpression mapped = image[e];
+        CHECK(mapped.getName() == formulas[e].first);
+        CHECK(image.find(formulas[e].first) == e);
+        CHECK(mapped.toString() == ast->toString());
+        CHECK(mapped.getVariableCount() == ast->collectVariables().size());
+
+        for (const VariableMap& variables : inputs) {
+            std::string expected = outcome([&] { return ast->evaluate(variables); });
+            CHECK(outcome([&] { return mapped.evaluate(variables); }) == expected);
+
+            std::vector<double> slots;
+            for (size_t slot = 0; slot < mapped.getVariableCount(); ++slot) {
+                auto it = variables.find(mapped.getVariable(slot));
+                if (it != variables.end()) slots.push_back(it->second);
+            }
+            if (slots.size() == mapped.getVariableCount()) {
+                CHECK(outcome([&] { return mapped.evaluate(slots); }) == expected);
+            }
+        }
+    }
+    CHECK(image.find("missing") == ExpressionImage::NOT_FOUND);
+    CHECK(test::errorMessage([&] { image[0].evaluate(std::vector<double>{1.0}); }) ==
+          "Expected 2 variable values but got 1");
+
+    // Through a file: open() maps it, a truncated file is refused
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "ExpressionImageTest.img";
+    writer.save(path.string());
+    {
+        ExpressionImage opened = ExpressionImage::open(path.string());
+        opened.verify();
+        for (size_t e = 0; e < opened.size(); ++e) CHECK(opened[e].toString() == formulas[e].second->toString());
+    }
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(serialized.data()), static_cast<std::streamsize>(serialized.size() - 8));
+    }
+    CHECK(test::errorMessage([&] { ExpressionImage::open(path.string()); }) == "Truncated expression image");
+    std::filesystem::remove(path);
+
+    // Header and section bounds, checked when the image is attached
+    CHECK(bytes.verifyMessage() == "");
+    CHECK(bytes.verifyMessage(bytes.size - 8) == "Truncated expression image");
+    CHECK(bytes.verifyMessage(sizeof(ImageHeader) - 1) == "Not an expression image");
+    {
+        ImageBytes corrupt(serialized);
+        corrupt.header().magic[0] = 'X';
+        CHECK(corrupt.verifyMessage() == "Not an expression image");
+    }
+    {
+        ImageBytes corrupt(serialized);
+        corrupt.header().version = 2;
+        CHECK(corrupt.verifyMessage() == "Unsupported expression image version 2");
+    }
+    {
+        ImageBytes corrupt(serialized);
+        corrupt.header().nodes = corrupt.header().fileSize;
+        CHECK(corrupt.verifyMessage() == "Corrupt expression image: section out of bounds");
+    }
+
+    // Contents, checked by verify()
+    const auto sin = static_cast<std::uint8_t>(ImageFunction::SIN);
+    for (std::uint16_t childCount : {0, 2}) {
+        ImageBytes corrupt(serialized);
+        size_t at = corrupt.find(1, NodeType::FUNCTION_CALL, sin);
+        corrupt.node(1, at).childCount = childCount;
+        CHECK(corrupt.verifyMessage() == "Corrupt expression image: expression 1, node " + std::to_string(at));
+    }
+    {
+        ImageBytes corrupt(serialized);
+        ImageNode& first = corrupt.node(0, 0);
+        first.kind = static_cast<std::uint8_t>(NodeType::BINARY_OP);
+        first.op = static_cast<std::uint8_t>(OperatorType::ADD);
+        first.childCount = 2;
+        CHECK(corrupt.verifyMessage() == "Corrupt expression image: expression 0, node 0: missing operands");
+    }
+    {
+        ImageBytes corrupt(serialized);
+        size_t at = corrupt.find(0, NodeType::NUMBER, static_cast<std::uint8_t>(OperatorType::NONE));
+        corrupt.node(0, at).operand = corrupt.header().constantCount;
+        CHECK(corrupt.verifyMessage() == "Corrupt expression image: expression 0, node " + std::to_string(at));
+    }
+    {
+        ImageBytes corrupt(serialized);
+        corrupt.expression(0).maxStackDepth = 1;
+        CHECK(corrupt.verifyMessage() == "Corrupt expression image: expression 0: stack depth");
+    }
+    {
+        ImageBytes corrupt(serialized);
+        corrupt.section<std::uint32_t>(corrupt.header().slots)[0] = corrupt.header().symbolCount;
+        CHECK(corrupt.verifyMessage() == "Corrupt expression image: slot 0");
+    }
+    {
+        ImageBytes corrupt(serialized);
+        std::uint32_t* offsets = corrupt.section<std::uint32_t>(corrupt.header().symbolOffsets);
+        offsets[0] = offsets[1] + 1;
+        CHECK(corrupt.verifyMessage() == "Corrupt expression image: symbol 0");
+    }
+    {
+        ImageBytes corrupt(serialized);
+        std::uint32_t* nameIndex = corrupt.section<std::uint32_t>(corrupt.header().nameIndex);
+        std::swap(nameIndex[0], nameIndex[1]);
+        CHECK(corrupt.verifyMessage() == "Corrupt expression image: name index 1 out of order");
+    }
+    {
+        ImageBytes corrupt(serialized);
+        std::uint32_t* nameIndex = corrupt.section<std::uint32_t>(corrupt.header().nameIndex);
+        nameIndex[1] = nameIndex[0];
+        CHECK(corrupt.verifyMessage() == "Corrupt expression image: name index 1");
+    }
+
+    return test::finish("ExpressionImageTest");
+}
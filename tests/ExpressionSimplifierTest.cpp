@@ -0,0 +1,48 @@
+// ExpressionSimplifier folding and identities, and re-parsing its output
+#include "TestCommon.h"
+#include "../ExpressionSimplifier.h"
+#include "../InfixParser.h"
+#include <bit>
+#include <cstdint>
+
+// Simplify infix text and parse the printed result back
+static ASTNodePtr simplifyAndReparse(const std::string& infix, ASTNodePtr& simplified) {
+    ExpressionSimplifier simplifier;
+    simplified = simplifier.simplify(InfixParser::parse(infix));
+    return InfixParser::parse(simplified->toString());
+}
+
+int main() {
+    VariableMap variables = {{"x", 2.5}};
+    ASTNodePtr simplified;
+
+    // Finite constants fold, identities drop
+    CHECK(simplifyAndReparse("(2 + 3) * x", simplified)->toString() == "5 * x");
+    CHECK(simplifyAndReparse("x * 1 + 0", simplified)->toString() == "x");
+    CHECK(simplifyAndReparse("-(-x)", simplified)->toString() == "x");
+    CHECK(simplifyAndReparse("(0 - 8) ^ 2", simplified)->toString() == "64");
+
+    // inf and NaN stay unfolded, so the text still parses and evaluates the same
+    for (const char* infix : {"0 ^ -1", "x + 0 ^ -1", "-(0 ^ -1)", "(0 ^ -1) - (0 ^ -1)",
+                              "(0 - 8) ^ 0.5 * x", "(0 - 8) ^ x", "exp(1000)"}) {
+        ASTNodePtr original = InfixParser::parse(infix);
+        ASTNodePtr reparsed;
+        std::string message = test::errorMessage([&] { reparsed = simplifyAndReparse(infix, simplified); });
+        if (!CHECK(message.empty())) {
+            std::cerr << "  " << infix << ": " << message << "\n";
+            continue;
+        }
+        double expected = original->evaluate(variables);
+        CHECK(std::bit_cast<std::uint64_t>(simplified->evaluate(variables)) ==
+              std::bit_cast<std::uint64_t>(expected));
+        CHECK(std::bit_cast<std::uint64_t>(reparsed->evaluate(variables)) ==
+              std::bit_cast<std::uint64_t>(expected));
+    }
+
+    // Subtrees that throw are kept and still throw
+    CHECK(test::errorMessage([&] { simplifyAndReparse("x + 1 / 0", simplified)->evaluate(variables); }) ==
+          test::errorMessage([&] { InfixParser::parse("x + 1 / 0")->evaluate(variables); }));
+    CHECK(simplified->toString() == "x + 1 / 0");
+
+    return test::finish("ExpressionSimplifierTest");
+}
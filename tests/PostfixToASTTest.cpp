@@ -0,0 +1,34 @@
+// PostfixToAST token classification and conversion
+#include "TestCommon.h"
+#include "../PostfixToAST.h"
+
+int main() {
+    // Identifiers are variables, including ones named like a function
+    for (const char* name : {"sin", "cos", "tan", "sqrt", "log", "exp", "abs", "min", "max"}) {
+        std::string postfix = std::string(name) + " 2 *";
+        VariableMap variables = {{name, 3.5}};
+
+        CHECK(PostfixTokenizer::classify(name) == TokenKind::VARIABLE);
+        CHECK(PostfixToAST::convert(postfix)->evaluate(variables) == 7.0);
+        CHECK(PostfixToAST::convert(PostfixToAST::tokenize(postfix))->evaluate(variables) == 7.0);
+
+        ExpressionArena arena;
+        const ArenaNode* node = PostfixToAST::convert(std::string_view(postfix), arena);
+        CHECK(node->evaluate(arena.getSymbols(), variables) == 7.0);
+
+        CHECK(PostfixToAST::extractVariables(postfix) == std::vector<std::string>{name});
+    }
+
+    VariableMap variables = {{"max", 4}, {"sin", 0.5}};
+    CHECK(PostfixToAST::convert("max sin -")->toString() == "max - sin");
+    CHECK(PostfixToAST::convert("max sin -")->evaluate(variables) == 3.5);
+
+    // Errors keep their messages
+    CHECK(test::errorMessage([] { PostfixToAST::convert("a +"); }) ==
+          "Not enough operands for binary operator: +");
+    CHECK(test::errorMessage([] { PostfixToAST::convert("a b"); }) ==
+          "Invalid postfix expression: Stack has 2 elements instead of 1");
+    CHECK(test::errorMessage([] { PostfixToAST::convert("a $"); }) == "Invalid token: $");
+
+    return test::finish("PostfixToASTTest");
+}
@@ -0,0 +1,46 @@
+#ifndef TEST_COMMON_H
+#define TEST_COMMON_H
+
+#include <exception>
+#include <iostream>
+#include <string>
+
+// Record a failed condition with its location and keep going
+#define CHECK(condition) test::check((condition), #condition, __FILE__, __LINE__)
+
+namespace test {
+
+inline int failures = 0;
+
+inline bool check(bool ok, const char* condition, const char* file, int line) {
+    if (!ok) {
+        ++failures;
+        std::cerr << file << ":" << line << ": CHECK(" << condition << ") failed\n";
+    }
+    return ok;
+}
+
+// Message of the exception thrown by fn, or "" if it returns normally
+template <typename Fn>
+std::string errorMessage(Fn&& fn) {
+    try {
+        fn();
+    } catch (const std::exception& e) {
+        return e.what();
+    }
+    return "";
+}
+
+// Exit status for main: 0 when every CHECK passed
+inline int finish(const char* name) {
+    if (failures == 0) {
+        std::cout << name << ": ok\n";
+        return 0;
+    }
+    std::cout << name << ": " << failures << " failed\n";
+    return 1;
+}
+
+} // namespace test
+
+#endif // TEST_COMMON_H